@@ -18,8 +18,13 @@
 #include <Shlwapi.h>
 #include <Pathcch.h>
 
+// Lua and Sol
+#include <sol.hpp>
+
 // Project includes
 #include "ServiceLocator.h"					// Global access to common services
+#include "StringConverter.h"
+#include "StructuredLogPolicy.h"
 #include "Direct3D.h"
 #include "Direct2D.h"
 #include "App.h"
@@ -33,6 +38,12 @@
 
 #pragma endregion
 
+#pragma region "Statically-Linked Libraries"
+
+#pragma comment(lib, "liblua53.a")
+
+#pragma endregion
+
 namespace core
 {
 	DirectXApp::DirectXApp(HINSTANCE hInstance) :
@@ -44,10 +55,18 @@ namespace core
 		timer(NULL),
 		fps(0),
 		mspf(0.0),
-		dt(1000/(double)240),
+		frameStatistics(),
+		dt(1.0 / 240.0),
 		maxSkipFrames(10),
+		framePacer(NULL),
+		targetFrameRate(60.0),
+		catchUpPolicy(CatchUpPolicyType::clamp),
+		isPipelined(false),
+		snapshotSlot(0),
 		m_hasStarted(false),
 		showFPS(true),
+		framesThisSecond(0),
+		statisticsTime(0.0),
 		direct3D(NULL),
 		direct2D(NULL)
 	{
@@ -82,6 +101,11 @@ namespace core
 		{
 			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Non-existent or invalid configuration file. Starting with default settings.");
 		}
+		else
+		{
+			ReadLoggingConfiguration();
+			ReadFramePacingConfiguration();
+		}
 
 		// Create timer
 		try
@@ -93,6 +117,32 @@ namespace core
 			return std::runtime_error("The high-precision timer could not be started!");
 		}
 
+		// Create the frame limiter, it waits on the clock of the timer
+		framePacer = new FramePacer(timer->GetClockSource(), targetFrameRate);
+
+#if PROFILER_ENABLED
+		// the profiler zones use the clock of the timer
+		Profiler::SetClock(&timer->GetClockSource());
+		Profiler::SetThreadName("Game loop");
+#endif
+
+		// Start the job system, one worker per hardware thread besides the main thread
+		try
+		{
+			util::ServiceLocator::ProvideJobSystem(std::make_shared<util::JobSystem>(util::JobSystem::GetDefaultWorkerCount(), [](unsigned int worker)
+			{
+				util::ServiceLocator::GetFileLogger()->SetThreadName("worker " + std::to_string(worker + 1));
+#if PROFILER_ENABLED
+				Profiler::SetThreadName("Worker " + std::to_string(worker + 1));
+#endif
+			}));
+		}
+		catch (std::runtime_error)
+		{
+			return std::runtime_error("The job system could not be started!");
+		}
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The job system was started with {workers} worker threads.", util::ServiceLocator::GetJobSystem()->GetWorkerCount());
+
 		// Create the application window
 		try
 		{
@@ -146,6 +196,40 @@ namespace core
 			delete m_appWindow;
 		}
 
+		if (framePacer)
+		{
+			// Save the pacing statistics of the session
+			FramePacingSummary pacing = framePacer->GetSummary();
+			if (m_isLoggerActive && pacing.frames > 0)
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("Frame pacing of the session: target {target} ms, jitter p50 {p50} ms, p99 {p99} ms, max {max} ms; {missed} frames missed their deadline.", pacing.targetFrameTime, pacing.p50Jitter, pacing.p99Jitter, pacing.maxJitter, pacing.missedFrames);
+				if (!framePacer->WriteReport(m_pathToLogFiles + L"\\framePacing.txt"))
+				{
+					util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Unable to write the frame pacing statistics!");
+				}
+			}
+
+			delete framePacer;
+			framePacer = NULL;
+		}
+
+		if (util::ServiceLocator::GetJobSystem())
+		{
+			util::JobSystemStatistics jobs = util::ServiceLocator::GetJobSystem()->GetStatistics();
+			if (m_isLoggerActive)
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("Job system of the session: {jobs} jobs run, {stolen} stolen, {inline} run inline because a deque was full, the workers went to sleep {sleeps} times.", jobs.executedJobs, jobs.stolenJobs, jobs.inlineJobs, jobs.sleeps);
+			}
+
+			// Stop the workers while the logger and the profiler are still there
+			util::ServiceLocator::ProvideJobSystem(nullptr);
+		}
+
+#if PROFILER_ENABLED
+		// stop profiling before the clock is gone
+		Profiler::SetClock(nullptr);
+#endif
+
 		if (timer)
 		{
 			delete timer;
@@ -153,6 +237,25 @@ namespace core
 	
 		if (m_isLoggerActive)
 		{
+			// Save the frame statistics of the session next to the log files
+			FrameTimeSummary summary = frameStatistics.GetSessionSummary();
+			if (summary.frames > 0)
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("Frame times of the session: {frames} frames, p50 {p50} ms, p95 {p95} ms, p99 {p99} ms, max {max} ms; {skipped} frames hit the maximum number of updates.", summary.frames, summary.p50FrameTime, summary.p95FrameTime, summary.p99FrameTime, summary.maxFrameTime, summary.framesAtMaxSkipFrames);
+				if (!frameStatistics.WriteReport(m_pathToLogFiles + L"\\frameStatistics.txt"))
+				{
+					util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Unable to write the frame statistics!");
+				}
+			}
+
+#if PROFILER_ENABLED
+			// Save the call tree of the slowest frame
+			if (!Profiler::WriteReport(m_pathToLogFiles + L"\\profile.txt"))
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Unable to write the profile!");
+			}
+#endif
+
 			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The DirectX application was shutdown successfully.");
 		}
 	}
@@ -167,6 +270,17 @@ namespace core
 			showFPS = !showFPS;
 			break;
 
+#if PROFILER_ENABLED
+		case VK_F2:
+			// Capture the next frames as a Chrome trace
+			if (!Profiler::IsCapturing())
+			{
+				Profiler::CaptureFrames(120, m_pathToLogFiles + L"\\profile.json");
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("Capturing the next 120 frames to profile.json.");
+			}
+			break;
+#endif
+
 		case VK_ESCAPE:
 			PostMessage(m_appWindow->m_hWindow, WM_CLOSE, 0, 0);
 			break;
@@ -189,14 +303,44 @@ namespace core
 	// Main event loop
 	util::Expected<int> DirectXApp::Run()
 	{
-#ifndef NDEBUG
-		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("Entering the game loop...");
-#endif
+		if (isPipelined)
+		{
+			return RunPipelined();
+		}
+
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("Entering the game loop...");
 		// Reset and start the timer
 		timer->Reset();
 
-		double accumulatedTime = 0.0;	// time accumulated by rendering rather than updating physics
-		int nLoops = 0;					// number of completed loops while updating the game
+		// the fixed time step of the game; the time spent updating and rendering is measured with the clock of the timer
+		FixedStepLoop loop(dt, (int)maxSkipFrames, catchUpPolicy);
+		const ClockSource& clock = timer->GetClockSource();
+		loop.SetCostClock(&clock);
+		std::int64_t renderCounts = 0;
+
+		// nothing runs concurrently, thus the snapshot is only copied again once a step has changed the game world
+		snapshotSlot = 0;
+		bool isSnapshotStale = true;
+		auto update = [this, &isSnapshotStale](double deltaTime)
+		{
+			PROFILE_ZONE("Update");
+			isSnapshotStale = true;
+			return Update(deltaTime);
+		};
+		auto render = [this, &clock, &renderCounts, &isSnapshotStale](double farseer)
+		{
+			PROFILE_ZONE("Render");
+			std::int64_t start = clock.GetCounts();
+			if (isSnapshotStale)
+			{
+				PROFILE_ZONE("Write snapshot");
+				WriteSnapshot(snapshotSlot);
+				isSnapshotStale = false;
+			}
+			util::Expected<int> result = Render(farseer);
+			renderCounts += clock.GetCounts() - start;
+			return result;
+		};
 
 		bool continueRunning = true;
 		MSG msg = { 0 };
@@ -204,69 +348,221 @@ namespace core
 		while (continueRunning)
 		{
 			// Peek for messages
-			while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
 			{
-				TranslateMessage(&msg);
-				DispatchMessage(&msg);
-
-				if (msg.message == WM_QUIT)
-				{
-					continueRunning = false;
-				}
+				PROFILE_ZONE("Message pump");
+				continueRunning = PumpMessages(msg);
 			}
 
 			// Let the timer tick
 			timer->Tick();
 
-			if (!m_isPaused)
+			if (m_isPaused)
 			{
-				// Compute FPS
-				if (!CalculateFrameStatistics().isValid())
+				// Sleep until the window receives a message rather than polling for one
+				if (continueRunning)
 				{
-					return util::Expected<int>("Critical error: Unable to calculate frame statistics!");
+					PROFILE_ZONE("Paused");
+					WaitMessage();
 				}
 
+				// the frames after the pause start a new grid
+				framePacer->Restart();
+			}
+			else
+			{
 				// ... get input ...
 
-				util::Expected<int> result(0);
+				// Update in fixed steps of delta-t, then render
+				renderCounts = 0;
+				{
+					PROFILE_ZONE("Game loop");
+					util::Expected<int> result = loop.RunFrame(timer->GetDeltaTime(), update, render);
+					if (!result.isValid())
+					{
+						return result;
+					}
+				}
 
-				// Add the rendering time (time between frames)
-				accumulatedTime += timer->GetDeltaTime();
+				// Compute frame statistics
+				const FixedStepFrame& frame = loop.GetLastFrame();
+				if (!RecordFrameStatistics({ timer->GetDeltaTime(), frame.updateTime, renderCounts * clock.GetSecondsPerCount(), frame.updates, frame.hitMaxSkipFrames }).isValid())
+				{
+					return util::Expected<int>("Critical error: Unable to calculate frame statistics!");
+				}
 
-				// Update in fixed steps of delta-t until the accumulatedTime has been used up
-				nLoops = 0;
-				while (accumulatedTime >= dt && nLoops < maxSkipFrames)
+				// Wait until the next frame is due
 				{
-					result = Update(dt);
+					PROFILE_ZONE("Frame pacing");
+					framePacer->WaitForNextFrame();
+				}
+			}
+
+			// Aggregate the profiler zones of the frame
+			PROFILE_FRAME();
+		}
+
+		loop.LogTelemetry();
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("Leaving the game loop...");
+
+		return (int)(msg.wParam);
+	}
+
+	// Update on a simulation thread while the main thread renders the newest snapshot: a frame costs the longer of the two
+	util::Expected<int> DirectXApp::RunPipelined()
+	{
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("Entering the pipelined game loop...");
+		// Reset and start the timer
+		timer->Reset();
+
+		// the simulation thread runs the fixed time step on the clock of the timer and publishes a snapshot after its updates
+		const ClockSource& clock = timer->GetClockSource();
+		PipelinedLoop pipeline(clock, dt, (int)maxSkipFrames, catchUpPolicy);
+		pipeline.Start([this](double deltaTime)
+		{
+			PROFILE_ZONE("Update");
+			return Update(deltaTime);
+		}, [this](unsigned int slot)
+		{
+			PROFILE_ZONE("Write snapshot");
+			WriteSnapshot(slot);
+		});
+
+		bool continueRunning = true;
+		MSG msg = { 0 };
+
+		while (continueRunning)
+		{
+			// Peek for messages
+			{
+				PROFILE_ZONE("Message pump");
+				continueRunning = PumpMessages(msg);
+			}
+
+			// Let the timer tick
+			timer->Tick();
+
+			// an update failed on the simulation thread
+			if (pipeline.HasFailed())
+			{
+				return pipeline.Stop();
+			}
+
+			if (m_isPaused)
+			{
+				// the simulation thread sleeps as well
+				pipeline.Pause();
+
+				// Sleep until the window receives a message rather than polling for one
+				if (continueRunning)
+				{
+					PROFILE_ZONE("Paused");
+					WaitMessage();
+				}
+
+				// the frames after the pause start a new grid
+				framePacer->Restart();
+			}
+			else
+			{
+				pipeline.Resume();
+
+				// Render the newest snapshot, the next updates already run
+				std::int64_t renderCounts = 0;
+				{
+					PROFILE_ZONE("Render");
+					pipeline.AcquireSnapshot();
+					snapshotSlot = pipeline.GetSnapshotSlot();
+
+					std::int64_t start = clock.GetCounts();
+					util::Expected<int> result = Render(pipeline.GetLastFrame().farseer);
+					renderCounts = clock.GetCounts() - start;
 					if (!result.isValid())
 					{
+						pipeline.Stop();
 						return result;
 					}
-					accumulatedTime -= dt;
-					nLoops++;
 				}
 
-				// Render, but predict the future by accounting for the remaining accumulatedTime
-				result = Render(accumulatedTime / dt);
-				if (!result.isValid())
+				// Compute frame statistics, the updates are those of the snapshots published since the previous frame
+				const PipelinedFrame& frame = pipeline.GetLastFrame();
+				if (!RecordFrameStatistics({ timer->GetDeltaTime(), frame.updateTime, renderCounts * clock.GetSecondsPerCount(), frame.updates, frame.hitMaxSkipFrames }).isValid())
+				{
+					pipeline.Stop();
+					return util::Expected<int>("Critical error: Unable to calculate frame statistics!");
+				}
+
+				// Wait until the next frame is due
 				{
-					return result;
+					PROFILE_ZONE("Frame pacing");
+					framePacer->WaitForNextFrame();
 				}
 			}
-			
+
+			// Aggregate the profiler zones of the frame
+			PROFILE_FRAME();
+		}
+
+		util::Expected<int> result = pipeline.Stop();
+		if (!result.isValid())
+		{
+			return result;
 		}
-#ifndef NDEBUG
-		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("Leaving the game loop...");
-#endif
+
+		pipeline.GetLoop().LogTelemetry();
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("Leaving the pipelined game loop...");
 
 		return (int)(msg.wParam);
 	}
 
+	bool DirectXApp::PumpMessages(MSG& msg)
+	{
+		bool continueRunning = true;
+		while (PeekMessage(&msg, NULL, 0, 0, PM_REMOVE))
+		{
+			TranslateMessage(&msg);
+			DispatchMessage(&msg);
+
+			if (msg.message == WM_QUIT)
+			{
+				continueRunning = false;
+			}
+		}
+		return continueRunning;
+	}
+
+	// Run the game loop on virtual time, as fast as possible and without pumping window messages
+	util::Expected<int> DirectXApp::RunHeadless(double simulatedSeconds, double frameTime)
+	{
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("Entering the headless game loop for {} simulated seconds...", simulatedSeconds);
+
+		HeadlessRunner runner(dt, (int)maxSkipFrames, frameTime);
+		runner.SetCatchUpPolicy(CatchUpPolicy::Create(catchUpPolicy));
+		snapshotSlot = 0;
+		bool isSnapshotStale = true;
+		util::Expected<int> result = runner.Run(simulatedSeconds, [this, &isSnapshotStale](double deltaTime)
+		{
+			isSnapshotStale = true;
+			return Update(deltaTime);
+		}, [this, &isSnapshotStale](double farseer)
+		{
+			// the snapshot is only copied again once a step has changed the game world
+			if (isSnapshotStale)
+			{
+				WriteSnapshot(snapshotSlot);
+				isSnapshotStale = false;
+			}
+			util::Expected<int> result = Render(farseer);
+			PROFILE_FRAME();
+			return result;
+		});
+
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("Leaving the headless game loop...");
+		return result;
+	}
+
 	util::Expected<void> DirectXApp::OnResize()
 	{
-#ifndef NDEBUG
-		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("The window was resized. The game graphics must be updated!");
-#endif
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The window was resized. The game graphics must be updated!");
 		if (!direct3D->OnResize().isValid())
 		{
 			return std::runtime_error("Unable to resize Direct3D resources!");
@@ -319,15 +615,46 @@ namespace core
 		std::wstring logFile = m_pathToLogFiles + L"\\logfile.log";
 
 		// Create file logger
-		std::shared_ptr<util::Logger<util::FileLogPolicy>> logger(new util::Logger<util::FileLogPolicy>(logFile));
+		std::shared_ptr<util::Logger<util::MappedFileLogPolicy>> logger(new util::Logger<util::MappedFileLogPolicy>(logFile));
 		m_isLoggerActive = true;
 		logger->SetThreadName("main");
+
+		// Errors are additionally written to their own file, synchronously, thus they are on disk before the game reacts to them
+		std::shared_ptr<util::FileLogPolicy> errorLog = std::make_shared<util::FileLogPolicy>();
+		if (errorLog->OpenOutputStream(m_pathToLogFiles + L"\\errors.log"))
+		{
+			logger->AddRoute(util::SeverityType::error, logger->AddSink(errorLog, util::SinkMode::synchronous));
+		}
+
+		// Everything but configuration messages is also written as JSON lines, for tools and scripts
+		std::shared_ptr<util::StructuredLogPolicy> structuredLog = std::make_shared<util::StructuredLogPolicy>(util::StructuredLogFormat::jsonLines, std::unique_ptr<util::LogPolicyInterface>(new util::MappedFileLogPolicy()));
+		if (structuredLog->OpenOutputStream(m_pathToLogFiles + L"\\logfile.jsonl"))
+		{
+			util::LogSink* structuredSink = logger->AddSink(structuredLog);
+			for (util::SeverityType severity : { util::debug, util::info, util::warning, util::error })
+			{
+				logger->AddRoute(severity, structuredSink);
+			}
+		}
+
+		// Repeated messages, i.e. during a resize storm or a persistent fault, are collapsed into "(repeated N times)"; errors
+		// are never dropped, thus every one of them reaches errors.log
+		for (util::SeverityType severity : { util::debug, util::info, util::warning })
+		{
+			logger->SetDeduplicationWindow(severity, std::chrono::milliseconds(1000));
+			logger->SetRateLimit(severity, 10, 50);
+		}
+
+		// If the game crashes, the last messages and everything still waiting in the log buffers are saved to crash.log
+		if (util::CrashHandler::Install(m_pathToLogFiles + L"\\crash.log"))
+		{
+			logger->EnableCrashHandling();
+		}
+
 		util::ServiceLocator::ProvideFileLoggingService(logger);
 
-#ifndef NDEBUG
 		// Print starting message
-		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The file logger was created successfully.");
-#endif
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The file logger was created successfully.");
 	}
 
 	bool DirectXApp::CheckConfigurationFile()
@@ -355,8 +682,9 @@ namespace core
 				try
 				{
 					util::Logger<util::FileLogPolicy> prefFileCreator(pathToPrefsFile.c_str());
+					prefFileCreator.SetMinimumSeverity(util::SeverityType::config);	// the configuration file must only contain the configuration
 					std::stringstream printPrefs;
-					printPrefs << "config =\r\n{ \r\n\tresolution = { width = 800, height = 600 }\r\n}";
+					printPrefs << "config =\r\n{ \r\n\tlogging = { debugSampleRate = 1 },\r\n\tframePacing = { targetFrameRate = 60, catchUpPolicy = \"clamp\", pipelined = false },\r\n\tresolution = { width = 800, height = 600 }\r\n}";
 					prefFileCreator.Print<util::config>(printPrefs.str());
 				}
 				catch (std::runtime_error)
@@ -371,8 +699,9 @@ namespace core
 			try
 			{
 				util::Logger<util::FileLogPolicy> prefFileCreator(pathToPrefsFile.c_str());
+				prefFileCreator.SetMinimumSeverity(util::SeverityType::config);	// the configuration file must only contain the configuration
 				std::stringstream printPrefs;
-				printPrefs << "config =\r\n{ \r\n\tresolution = { width = 800, height = 600 }\r\n}";
+				printPrefs << "config =\r\n{ \r\n\tlogging = { debugSampleRate = 1 },\r\n\tframePacing = { targetFrameRate = 60, catchUpPolicy = \"clamp\", pipelined = false },\r\n\tresolution = { width = 800, height = 600 }\r\n}";
 				prefFileCreator.Print<util::config>(printPrefs.str());
 			}
 			catch (std::runtime_error)
@@ -385,24 +714,103 @@ namespace core
 		return true;
 	}
 
-	util::Expected<void> DirectXApp::CalculateFrameStatistics()
+	void DirectXApp::ReadLoggingConfiguration()
+	{
+		std::wstring pathToPrefsFile = m_pathToConfigurationFiles + L"prefs.lua";
+
+		try
+		{
+			sol::state lua;
+			lua.script_file(util::StringConverter::ws2s(pathToPrefsFile));
+
+			// Minimum severity of the messages to write. Default: everything that was compiled in
+			util::SeverityType severity;
+			std::string severityName = lua["config"]["logging"]["severity"].get_or(std::string());
+			if (util::LogFormatter::ParseSeverity(severityName, severity))
+			{
+				util::ServiceLocator::GetFileLogger()->SetMinimumSeverity(severity);
+			}
+
+			// Only write one out of debugSampleRate debug messages. Default: 1
+			unsigned int debugSampleRate = lua["config"]["logging"]["debugSampleRate"].get_or(1);
+			if (debugSampleRate > 1)
+			{
+				util::ServiceLocator::GetFileLogger()->SetSampleRate(util::SeverityType::debug, debugSampleRate);
+			}
+
+			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The logging configuration was read from the Lua configuration file: severity {severity}, debug sample rate {debugSampleRate}.", severityName, debugSampleRate);
+		}
+		catch (std::exception)
+		{
+			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Unable to read the logging configuration. Logging everything that was compiled in!");
+		}
+	}
+
+	void DirectXApp::ReadFramePacingConfiguration()
 	{
-		static int nFrames;				// number of frames seen
-		static double elapsedTime;		// time since last call
-		nFrames++;
+		std::wstring pathToPrefsFile = m_pathToConfigurationFiles + L"prefs.lua";
+
+		try
+		{
+			sol::state lua;
+			lua.script_file(util::StringConverter::ws2s(pathToPrefsFile));
+
+			// Frames per second the game loop is limited to, 0 for no limit. Default: 60
+			double frameRate = lua["config"]["framePacing"]["targetFrameRate"].get_or(targetFrameRate);
+			if (frameRate >= 0.0)
+			{
+				targetFrameRate = frameRate;
+			}
+			else
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Invalid target frame rate {frameRate} in the configuration file!", frameRate);
+			}
+
+			// What the fixed time step does when the updates fall behind: strict, clamp, timeDilation or adaptiveStep. Default: clamp
+			std::string policyName = lua["config"]["framePacing"]["catchUpPolicy"].get_or(std::string());
+			if (!policyName.empty() && !CatchUpPolicy::ParseType(policyName, catchUpPolicy))
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Unknown catch-up policy {policyName} in the configuration file!", policyName);
+			}
+
+			// Update on a simulation thread while the main thread renders. Default: false
+			isPipelined = lua["config"]["framePacing"]["pipelined"].get_or(isPipelined);
+
+			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The frame pacing configuration was read from the Lua configuration file: target frame rate {targetFrameRate}, catch-up policy {policy}, pipelined {pipelined}.", targetFrameRate, CatchUpPolicy::GetName(catchUpPolicy), isPipelined);
+		}
+		catch (std::exception)
+		{
+			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("Unable to read the frame pacing configuration. Limiting the game to {targetFrameRate} frames per second!", targetFrameRate);
+		}
+	}
+
+	util::Expected<void> DirectXApp::RecordFrameStatistics(const FrameTiming& frame)
+	{
+		frameStatistics.Record(frame);
+		framesThisSecond++;
 
 		// Compute average statistics over one second
-		if ((timer->GetTotalTime() - elapsedTime) >= 1.0)
+		if ((timer->GetTotalTime() - statisticsTime) >= 1.0)
 		{
-			fps = nFrames;
-			mspf = 1000.0 / (double)fps;
+			// the time per frame is the median of the recent frames, not 1000 / fps: the average of the second hides the hitches,
+			// which the percentiles show
+			FrameTimeSummary recent = frameStatistics.GetRecentSummary();
+			fps = framesThisSecond;
+			mspf = recent.p50FrameTime;
 
 			if (showFPS)
 			{
 				std::wostringstream outFPS;
 				outFPS.precision(6);
 				outFPS << "FPS: " << DirectXApp::fps << std::endl;
-				outFPS << "mSPF: " << DirectXApp::mspf << std::endl;
+				outFPS << "mSPF p50: " << DirectXApp::mspf << " ms" << std::endl;
+				outFPS << "p99: " << recent.p99FrameTime << " ms, max: " << recent.maxFrameTime << " ms" << std::endl;
+				outFPS << "update: " << recent.meanUpdateTime << " ms, render: " << recent.meanRenderTime << " ms" << std::endl;
+				if (framePacer->GetTargetFrameRate() > 0.0)
+				{
+					FramePacingSummary pacing = framePacer->GetSummary();
+					outFPS << "pacing jitter p99: " << pacing.p99Jitter << " ms" << std::endl;
+				}
 
 				HRESULT hr = direct2D->writeFactory->CreateTextLayout(
 					outFPS.str().c_str(),					// string
@@ -419,8 +827,8 @@ namespace core
 			}
 
 			// Reset
-			nFrames = 0;
-			elapsedTime += 1.0;
+			framesThisSecond = 0;
+			statisticsTime += 1.0;
 		}
 
 		return {};
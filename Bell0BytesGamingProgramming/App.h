@@ -17,6 +17,12 @@
 #include "Expected.h"		// Custom exceptions
 #include "Window.h"			// Window class
 #include "Timer.h"			// Timer
+#include "FixedStepLoop.h"	// Fixed time step
+#include "HeadlessRunner.h"	// Game loop on virtual time
+#include "PipelinedLoop.h"	// Updates on a simulation thread
+#include "FrameStatistics.h"	// Frame timing
+#include "FramePacer.h"		// Frame limiter
+#include "Profiler.h"		// Profiler zones
 #include "Direct3D.h"		// Graphics
 #include "Direct2D.h"
 
@@ -45,8 +51,16 @@ namespace core
 
 		// Game loop
 		virtual util::Expected<int> Run();							// enter the main event loop
+		virtual util::Expected<int> RunHeadless(double simulatedSeconds, double frameTime = 1.0 / 60.0);	// run the game loop on virtual time
 		virtual util::Expected<int> Update(double deltaTime) = 0;	// update the game world
 
+		// Copy what Render needs into the snapshot slot (0 to PipelinedLoop::snapshotSlotCount - 1), after the updates of a
+		// frame and on the thread that updates; Render draws the slot returned by GetSnapshotSlot. In the pipelined loop,
+		// Update and WriteSnapshot run on the simulation thread, while the main thread renders a different slot; in the other
+		// loops, WriteSnapshot is only called for frames that follow an update
+		virtual void WriteSnapshot(unsigned int /*slot*/) {};
+		unsigned int GetSnapshotSlot() const { return snapshotSlot; };
+
 		// Resize handling
 		virtual util::Expected<void> OnResize();
 
@@ -54,15 +68,20 @@ namespace core
 		virtual util::Expected<int> Render(double farseer) = 0;
 
 		bool FileLoggerIsActive() { return m_isLoggerActive; }
+		const FrameStatistics& GetFrameStatistics() const { return frameStatistics; }
 
 
 	private:
-		util::Expected<void> CalculateFrameStatistics();		// compute fps / mspf
+		util::Expected<int> RunPipelined();			// update on a simulation thread while the main thread renders
+		bool PumpMessages(MSG& msg);				// dispatch the waiting window messages, returns false once the game is to quit
+		util::Expected<void> RecordFrameStatistics(const FrameTiming& frame);	// record the timing of a frame, compute fps / mspf once per second
 
 		// Logging helpers
 		bool GetPathToMyDocuments();
 		void CreateLoggingService();
 		bool CheckConfigurationFile();
+		void ReadLoggingConfiguration();			// apply the severity threshold and sampling from the config file
+		void ReadFramePacingConfiguration();		// read the target frame rate and the catch-up policy from the config file
 #pragma endregion
 #pragma region "Variables"
 	protected:
@@ -76,7 +95,8 @@ namespace core
 
 		// Stats
 		int fps;					// frames per second
-		double mspf;				// milliseconds per frame
+		double mspf;				// milliseconds per frame, the median of the recent frames
+		FrameStatistics frameStatistics;	// frame, update and render times of the recent frames and of the whole session
 
 	private:
 		// Folder paths
@@ -93,11 +113,18 @@ namespace core
 
 		bool m_hasStarted;			// app started
 		bool showFPS;				// determines if FPS info should be printed to the screen
+		int framesThisSecond;		// number of frames since the fps were last computed
+		double statisticsTime;		// total time at which the fps were last computed
 
 		// Timer
 		Timer* timer;
 		double dt;					// delta-t, the constant update rate of the game
 		double maxSkipFrames;		// max number of frames to skip in the update loop
+		FramePacer* framePacer;		// waits for the next frame when the game runs faster than the target frame rate
+		double targetFrameRate;		// frames per second, 0 for as many as possible
+		CatchUpPolicyType catchUpPolicy;	// what the fixed time step does when the updates fall behind
+		bool isPipelined;			// the updates run on a simulation thread while the main thread renders
+		unsigned int snapshotSlot;	// the snapshot Render draws
 #pragma endregion
 	};
 }
@@ -0,0 +1,206 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* CatchUpPolicy.cpp
+*
+* What the fixed time step does when the updates fall behind the real time
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::min, std::max
+#include <cmath>			// std::fmod
+#include <stdexcept>		// std::invalid_argument
+
+// Project includes
+#include "CatchUpPolicy.h"
+
+#pragma endregion
+
+namespace core
+{
+	namespace
+	{
+		// time dilation
+		const double minimumTimeScale = 0.1;		// the game never runs slower than a tenth of its speed
+		const double slowDown = 0.75;				// applied every frame that hit maxSkipFrames
+		const double speedUp = 0.02;				// added every frame without debt
+		const double sustainableShare = 0.9;		// the share of the real time the updates may use
+
+		// adaptive steps
+		const int maximumStepScale = 8;				// the steps never get longer than eight times dt
+		const double highCostRatio = 0.9;			// lengthen the steps above this cost ratio
+		const double lowCostRatio = 0.5;			// shorten them if the shorter steps stay below it
+		const int calmFramesToShorten = 60;
+
+		// every second is simulated, however long it takes
+		class StrictPolicy : public CatchUpPolicy
+		{
+		public:
+			StrictPolicy() : CatchUpPolicy(CatchUpPolicyType::strict) {};
+		};
+
+		// at most maxSkipFrames steps per frame, debt beyond a step is dropped
+		class ClampPolicy : public CatchUpPolicy
+		{
+		public:
+			ClampPolicy() : CatchUpPolicy(CatchUpPolicyType::clamp) {};
+
+			double AdmitTime(double elapsedTime, const CatchUpState& state) override
+			{
+				return std::min(elapsedTime, state.maxSkipFrames * state.dt);
+			}
+
+			double SettleDebt(const CatchUpState& state) override
+			{
+				// keep the fraction of a step, thus the renderer still interpolates between the same states
+				return state.debt < state.dt ? state.debt : std::fmod(state.debt, state.dt);
+			}
+		};
+
+		// slows the game down while the updates can not keep up, and speeds it up again once they can
+		class TimeDilationPolicy : public CatchUpPolicy
+		{
+		public:
+			TimeDilationPolicy() : CatchUpPolicy(CatchUpPolicyType::timeDilation), timeScale(1.0) {};
+
+			double AdmitTime(double elapsedTime, const CatchUpState&) override
+			{
+				return elapsedTime * timeScale;
+			}
+
+			double SettleDebt(const CatchUpState& state) override
+			{
+				// the updates can simulate at most dt per update cost of real time, rendering needs some time as well
+				double sustainableScale = state.updateCost > 0.0 ? sustainableShare * state.dt / state.updateCost : 1.0;
+
+				if (state.hitMaxSkipFrames)
+				{
+					timeScale = std::max(minimumTimeScale, timeScale * slowDown);
+				}
+				else if (state.debt < state.dt)
+				{
+					timeScale = std::min(timeScale + speedUp, 1.0);
+				}
+				timeScale = std::max(minimumTimeScale, std::min(timeScale, sustainableScale));
+
+				// the scale handles the trend; the debt of a single hitch is dropped
+				return std::min(state.debt, state.maxSkipFrames * state.dt);
+			}
+
+			void Reset() override
+			{
+				timeScale = 1.0;
+			}
+
+		private:
+			double timeScale;									// simulated time per real time
+		};
+
+		// doubles the step length while an update costs more than its budget, halves it again once it is cheap
+		class AdaptiveStepPolicy : public CatchUpPolicy
+		{
+		public:
+			AdaptiveStepPolicy() : CatchUpPolicy(CatchUpPolicyType::adaptiveStep), stepScale(1), calmFrames(0) {};
+
+			double GetStepTime(const CatchUpState& state) override
+			{
+				return state.dt * stepScale;
+			}
+
+			double SettleDebt(const CatchUpState& state) override
+			{
+				// the real time an update takes per simulated time of its step
+				double costRatio = state.updateCost / state.stepTime;
+
+				if (state.hitMaxSkipFrames || costRatio > highCostRatio)
+				{
+					if (stepScale < maximumStepScale)
+					{
+						stepScale *= 2;
+					}
+					calmFrames = 0;
+				}
+				else if (stepScale > 1 && costRatio * 2.0 < lowCostRatio)
+				{
+					// only shorten the steps after a while, a single cheap frame does not make a trend
+					if (++calmFrames >= calmFramesToShorten)
+					{
+						stepScale /= 2;
+						calmFrames = 0;
+					}
+				}
+				else
+				{
+					calmFrames = 0;
+				}
+
+				return std::min(state.debt, state.maxSkipFrames * state.dt * stepScale);
+			}
+
+			void Reset() override
+			{
+				stepScale = 1;
+				calmFrames = 0;
+			}
+
+		private:
+			int stepScale;										// the steps are stepScale times dt long
+			int calmFrames;										// consecutive frames the shorter steps would have been cheap enough
+		};
+	}
+
+	std::unique_ptr<CatchUpPolicy> CatchUpPolicy::Create(CatchUpPolicyType type)
+	{
+		switch (type)
+		{
+		case CatchUpPolicyType::strict:
+			return std::unique_ptr<CatchUpPolicy>(new StrictPolicy());
+
+		case CatchUpPolicyType::clamp:
+			return std::unique_ptr<CatchUpPolicy>(new ClampPolicy());
+
+		case CatchUpPolicyType::timeDilation:
+			return std::unique_ptr<CatchUpPolicy>(new TimeDilationPolicy());
+
+		case CatchUpPolicyType::adaptiveStep:
+			return std::unique_ptr<CatchUpPolicy>(new AdaptiveStepPolicy());
+		}
+
+		throw std::invalid_argument("Unknown catch-up policy!");
+	}
+
+	const char* CatchUpPolicy::GetName(CatchUpPolicyType type)
+	{
+		switch (type)
+		{
+		case CatchUpPolicyType::strict:
+			return "strict";
+		case CatchUpPolicyType::clamp:
+			return "clamp";
+		case CatchUpPolicyType::timeDilation:
+			return "timeDilation";
+		case CatchUpPolicyType::adaptiveStep:
+			return "adaptiveStep";
+		}
+		return "unknown";
+	}
+
+	bool CatchUpPolicy::ParseType(const std::string& name, CatchUpPolicyType& type)
+	{
+		const CatchUpPolicyType types[] = { CatchUpPolicyType::strict, CatchUpPolicyType::clamp, CatchUpPolicyType::timeDilation, CatchUpPolicyType::adaptiveStep };
+		for (CatchUpPolicyType candidate : types)
+		{
+			if (name == GetName(candidate))
+			{
+				type = candidate;
+				return true;
+			}
+		}
+		return false;
+	}
+}
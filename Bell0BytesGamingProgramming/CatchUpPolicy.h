@@ -0,0 +1,86 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* CatchUpPolicy.h
+*
+* What the fixed time step does when the updates fall behind the real time
+*
+* Once an update costs more real time than the time it simulates, every frame accumulates more time than it can pay off
+* and the game ends up spending each frame on maxSkipFrames updates of ever older debt: the spiral of death. A policy
+* decides how much of the elapsed time a frame admits into the accumulator, how long the steps are, and how much of the
+* debt left after the updates of a frame is carried into the next one; the rest is dropped.
+*
+*	strict			admits and keeps every second: exact and deterministic, but spirals if the updates can not keep up
+*	clamp			admits at most maxSkipFrames steps per frame and drops the debt beyond a step: the game slows down
+*	timeDilation	scales the admitted time down while debt builds up and back up once it is paid off: smooth slow motion
+*	adaptiveStep	lengthens the steps while an update costs more than its budget: less precise physics, same speed
+*
+* Policies keep state, one policy belongs to one FixedStepLoop.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <memory>			// std::unique_ptr
+#include <string>			// strings
+
+#pragma endregion
+
+namespace core
+{
+	enum class CatchUpPolicyType
+	{
+		strict,
+		clamp,
+		timeDilation,
+		adaptiveStep
+	};
+
+	// What a policy decides on, times in seconds
+	struct CatchUpState
+	{
+		double dt;						// the nominal time step
+		int maxSkipFrames;				// max number of updates per frame
+		double debt;					// the accumulated time not simulated yet
+		double stepTime;				// the length of the steps of the current frame
+		int updates;					// number of updates run during the current frame
+		bool hitMaxSkipFrames;			// the updates of the current frame stopped at maxSkipFrames
+		double updateCost;				// smoothed real time of an update, 0 if it is not measured
+	};
+
+	class CatchUpPolicy
+	{
+	public:
+		virtual ~CatchUpPolicy() {};
+
+		// The simulated time a frame adds to the accumulator, given the real time that elapsed
+		virtual double AdmitTime(double elapsedTime, const CatchUpState& /*state*/) { return elapsedTime; };
+
+		// The length of the steps of the frame
+		virtual double GetStepTime(const CatchUpState& state) { return state.dt; };
+
+		// Called after the updates of every frame: the debt to carry into the next frame, the rest is dropped
+		virtual double SettleDebt(const CatchUpState& state) { return state.debt; };
+
+		virtual void Reset() {};
+
+		// Getters
+		CatchUpPolicyType GetType() const { return type; };
+		const char* GetName() const { return GetName(type); };
+
+		static std::unique_ptr<CatchUpPolicy> Create(CatchUpPolicyType type);
+		static const char* GetName(CatchUpPolicyType type);
+		static bool ParseType(const std::string& name, CatchUpPolicyType& type);		// i.e. "clamp"
+
+	protected:
+		explicit CatchUpPolicy(CatchUpPolicyType type) : type(type) {};
+
+	private:
+		const CatchUpPolicyType type;
+	};
+}
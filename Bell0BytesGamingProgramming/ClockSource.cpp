@@ -0,0 +1,289 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* ClockSource.cpp
+*
+* Monotonic clock sources for the high resolution timer
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// calibration interval
+#include <stdexcept>		// std::runtime_error
+#include <thread>			// std::this_thread::sleep_for
+
+// Project includes
+#include "ClockSource.h"
+
+// Platform includes
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>			// clock_gettime
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define CLOCK_SOURCE_HAS_TSC
+#ifdef _MSC_VER
+#include <intrin.h>			// __cpuid, __rdtsc
+#else
+#include <cpuid.h>			// __get_cpuid
+#include <x86intrin.h>		// __rdtsc
+#endif
+#endif
+
+#pragma endregion
+
+namespace core
+{
+	namespace
+	{
+#ifdef _WIN32
+		class PerformanceCounterClock : public ClockSource
+		{
+		public:
+			PerformanceCounterClock() : ClockSource(ClockSourceType::performanceCounter, 0.0)
+			{
+				LARGE_INTEGER frequency;
+				if (!QueryPerformanceFrequency(&frequency) || frequency.QuadPart <= 0)
+				{
+					throw std::runtime_error("The hardware does not support a high-precision timer!");
+				}
+
+				// seconds per count is the reciprocal of the frequency
+				secondsPerCount = 1.0 / (double)frequency.QuadPart;
+			};
+
+			std::int64_t GetCounts() const override
+			{
+				// cannot fail on Windows XP or later
+				LARGE_INTEGER now;
+				QueryPerformanceCounter(&now);
+				return now.QuadPart;
+			};
+		};
+#else
+		class MonotonicClock : public ClockSource
+		{
+		public:
+			MonotonicClock() : ClockSource(ClockSourceType::monotonic, 1e-9)
+			{
+				timespec now;
+				if (clock_gettime(CLOCK_MONOTONIC, &now) != 0)
+				{
+					throw std::runtime_error("The monotonic clock is not supported!");
+				}
+			};
+
+			std::int64_t GetCounts() const override
+			{
+				timespec now;
+				clock_gettime(CLOCK_MONOTONIC, &now);
+				return (std::int64_t)now.tv_sec * 1000000000 + now.tv_nsec;
+			};
+		};
+#endif
+
+		// The clock of the operating system, used to calibrate the time stamp counter and to compare the cost of the sources
+		std::unique_ptr<ClockSource> CreateSystemClock()
+		{
+#ifdef _WIN32
+			return std::unique_ptr<ClockSource>(new PerformanceCounterClock());
+#else
+			return std::unique_ptr<ClockSource>(new MonotonicClock());
+#endif
+		}
+
+#ifdef CLOCK_SOURCE_HAS_TSC
+		// True if the time stamp counter ticks at a constant rate, regardless of power states and frequency changes
+		bool HasInvariantTimeStampCounter()
+		{
+			unsigned int registers[4] = {};		// eax, ebx, ecx, edx
+#ifdef _MSC_VER
+			__cpuid((int*)registers, 0x80000000);
+			if (registers[0] < 0x80000007)
+			{
+				return false;
+			}
+			__cpuid((int*)registers, 0x80000007);
+#else
+			if (!__get_cpuid(0x80000007, &registers[0], &registers[1], &registers[2], &registers[3]))
+			{
+				return false;
+			}
+#endif
+			// advanced power management information: edx bit 8 is the invariant TSC flag
+			return (registers[3] & (1u << 8)) != 0;
+		}
+
+		class TimeStampCounterClock : public ClockSource
+		{
+		public:
+			TimeStampCounterClock() : ClockSource(ClockSourceType::timeStampCounter, 0.0)
+			{
+				if (!HasInvariantTimeStampCounter())
+				{
+					throw std::runtime_error("The processor does not have an invariant time stamp counter!");
+				}
+
+				// count the ticks during a short interval of the system clock; each counter read is bracketed by two reads of
+				// the system clock, thus the error is bounded by the cost of reading the system clock
+				std::unique_ptr<ClockSource> systemClock = CreateSystemClock();
+				std::int64_t systemStart = systemClock->GetCounts();
+				std::int64_t counterStart = GetCounts();
+				std::int64_t systemStartEnd = systemClock->GetCounts();
+
+				std::this_thread::sleep_for(std::chrono::milliseconds(calibrationMilliseconds));
+
+				std::int64_t systemEnd = systemClock->GetCounts();
+				std::int64_t counterEnd = GetCounts();
+				std::int64_t systemEndEnd = systemClock->GetCounts();
+
+				double seconds = ((systemEnd + systemEndEnd) - (systemStart + systemStartEnd)) * 0.5 * systemClock->GetSecondsPerCount();
+				double frequency = seconds > 0.0 ? (counterEnd - counterStart) / seconds : 0.0;
+
+				// reject calibrations that make no sense, i.e. when the thread was migrated to an unsynchronized core
+				if (frequency < 1e8 || frequency > 1e11)
+				{
+					throw std::runtime_error("Unable to calibrate the time stamp counter!");
+				}
+				secondsPerCount = 1.0 / frequency;
+			};
+
+			std::int64_t GetCounts() const override
+			{
+				return (std::int64_t)__rdtsc();
+			};
+
+		private:
+			static const int calibrationMilliseconds = 50;
+		};
+#endif
+
+		// Average cost of reading a clock source, in seconds; the best of a few rounds filters out interruptions
+		double MeasureReadCost(const ClockSource& source, const ClockSource& systemClock)
+		{
+			const int reads = 4096;
+			double bestCost = 0.0;
+			for (int round = 0; round < 5; round++)
+			{
+				std::int64_t start = systemClock.GetCounts();
+				volatile std::int64_t sink = 0;
+				for (int i = 0; i < reads; i++)
+				{
+					sink = source.GetCounts();
+				}
+				(void)sink;
+				double cost = (systemClock.GetCounts() - start) * systemClock.GetSecondsPerCount() / reads;
+				if (round == 0 || cost < bestCost)
+				{
+					bestCost = cost;
+				}
+			}
+			return bestCost;
+		}
+	}
+
+	std::unique_ptr<ClockSource> ClockSource::Create(ClockSourceType type)
+	{
+		switch (type)
+		{
+		case ClockSourceType::performanceCounter:
+#ifdef _WIN32
+			return std::unique_ptr<ClockSource>(new PerformanceCounterClock());
+#else
+			throw std::runtime_error("The performance counter is only available on Windows!");
+#endif
+
+		case ClockSourceType::monotonic:
+#ifndef _WIN32
+			return std::unique_ptr<ClockSource>(new MonotonicClock());
+#else
+			throw std::runtime_error("The monotonic clock is only available on POSIX systems!");
+#endif
+
+		case ClockSourceType::timeStampCounter:
+#ifdef CLOCK_SOURCE_HAS_TSC
+			return std::unique_ptr<ClockSource>(new TimeStampCounterClock());
+#else
+			throw std::runtime_error("The time stamp counter is only available on x86 processors!");
+#endif
+
+		case ClockSourceType::virtualTime:
+			return std::unique_ptr<ClockSource>(new VirtualClock());
+
+		case ClockSourceType::automatic:
+		default:
+			break;
+		}
+
+		// pick the cheapest of the reliable sources
+		std::unique_ptr<ClockSource> systemClock = CreateSystemClock();
+		std::unique_ptr<ClockSource> cheapest;
+		double cheapestCost = 0.0;
+		for (ClockSourceType candidateType : GetAvailableTypes())
+		{
+			std::unique_ptr<ClockSource> candidate;
+			try
+			{
+				candidate = Create(candidateType);
+			}
+			catch (std::runtime_error&)
+			{
+				continue;
+			}
+
+			double cost = MeasureReadCost(*candidate, *systemClock);
+			if (!cheapest || cost < cheapestCost)
+			{
+				cheapest = std::move(candidate);
+				cheapestCost = cost;
+			}
+		}
+
+		if (!cheapest)
+		{
+			throw std::runtime_error("The hardware does not support a high-precision timer!");
+		}
+		return cheapest;
+	}
+
+	std::vector<ClockSourceType> ClockSource::GetAvailableTypes()
+	{
+		std::vector<ClockSourceType> types;
+#ifdef _WIN32
+		types.push_back(ClockSourceType::performanceCounter);
+#else
+		types.push_back(ClockSourceType::monotonic);
+#endif
+#ifdef CLOCK_SOURCE_HAS_TSC
+		if (HasInvariantTimeStampCounter())
+		{
+			types.push_back(ClockSourceType::timeStampCounter);
+		}
+#endif
+		return types;
+	}
+
+	const char* ClockSource::GetName(ClockSourceType type)
+	{
+		switch (type)
+		{
+		case ClockSourceType::performanceCounter:
+			return "performance counter";
+		case ClockSourceType::monotonic:
+			return "monotonic";
+		case ClockSourceType::timeStampCounter:
+			return "time stamp counter";
+		case ClockSourceType::virtualTime:
+			return "virtual";
+		default:
+			return "automatic";
+		}
+	}
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* ClockSource.h
+*
+* Monotonic clock sources for the high resolution timer
+*
+* - performanceCounter: QueryPerformanceCounter (Windows)
+* - monotonic: clock_gettime(CLOCK_MONOTONIC) (POSIX)
+* - timeStampCounter: the invariant time stamp counter of x86 processors, read with rdtsc and calibrated against the
+*   operating system clock at startup
+* - virtualTime: a clock that only moves when it is told to, used to run the game loop faster than real time and to
+*   reproduce runs exactly
+*
+* A clock source reports raw counts; the timer converts them to seconds with the calibrated seconds per count.
+* The automatic selection measures the cost of reading every reliable source and picks the cheapest one.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <cstdint>			// fixed width integers
+#include <memory>			// std::unique_ptr
+#include <vector>			// vector containers
+
+#pragma endregion
+
+namespace core
+{
+	enum class ClockSourceType
+	{
+		automatic,				// the cheapest reliable source of this machine
+		performanceCounter,		// QueryPerformanceCounter
+		monotonic,				// clock_gettime(CLOCK_MONOTONIC)
+		timeStampCounter,		// invariant TSC
+		virtualTime,			// VirtualClock, never chosen automatically
+	};
+
+	class ClockSource
+	{
+	public:
+		virtual ~ClockSource() {};
+
+		virtual std::int64_t GetCounts() const = 0;		// the current time in counts, never decreasing
+
+		// Getters
+		double GetSecondsPerCount() const { return secondsPerCount; };
+		ClockSourceType GetType() const { return type; };
+		const char* GetName() const { return GetName(type); };
+
+		// Creates the requested clock source; throws a std::runtime_error if it is not available or not reliable on this machine
+		static std::unique_ptr<ClockSource> Create(ClockSourceType type = ClockSourceType::automatic);
+
+		// The clock sources that can be created on this machine
+		static std::vector<ClockSourceType> GetAvailableTypes();
+
+		static const char* GetName(ClockSourceType type);
+
+	protected:
+		ClockSource(ClockSourceType type, double secondsPerCount) : secondsPerCount(secondsPerCount), type(type) {};
+
+		double secondsPerCount;				// reciprocal of the frequency of the source
+		const ClockSourceType type;
+	};
+
+	// A clock advanced by hand, counting nanoseconds; not thread-safe
+	class VirtualClock : public ClockSource
+	{
+	public:
+		VirtualClock() : ClockSource(ClockSourceType::virtualTime, 1e-9), now(0) {};
+
+		std::int64_t GetCounts() const override { return now; };
+
+		void AdvanceCounts(std::int64_t nanoseconds) { now += nanoseconds; };
+		void Advance(double seconds) { AdvanceCounts(ToCounts(seconds)); };
+
+		// Converts seconds to counts, rounded to the nearest nanosecond
+		static std::int64_t ToCounts(double seconds) { return (std::int64_t)(seconds * 1e9 + (seconds < 0.0 ? -0.5 : 0.5)); };
+
+	private:
+		std::int64_t now;					// the current time in nanoseconds
+	};
+}
@@ -0,0 +1,431 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* CrashHandler.cpp
+*
+* Crash-safe logging: fatal-signal and terminate handlers, a signal-safe writer and the log black box
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C includes
+#include <csignal>			// signals
+#include <cstdlib>			// std::abort
+#include <cstring>			// std::memcpy, std::strlen
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>			// open
+#include <unistd.h>			// write, close
+#endif
+
+// C++ includes
+#include <exception>		// std::set_terminate
+
+// Project includes
+#include "CrashHandler.h"
+#include "StringConverter.h"
+
+#pragma endregion
+
+namespace util
+{
+	namespace
+	{
+		// The path of the crash file, prepared when the handlers are installed
+#ifdef _WIN32
+		wchar_t crashFilePath[MAX_PATH] = {};
+#else
+		char crashFilePath[4096] = {};
+#endif
+		std::atomic<bool> hasCrashed(false);
+
+		std::intptr_t OpenCrashFile()
+		{
+#ifdef _WIN32
+			HANDLE file = CreateFileW(crashFilePath, FILE_APPEND_DATA, FILE_SHARE_READ, NULL, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+			return file == INVALID_HANDLE_VALUE ? -1 : reinterpret_cast<std::intptr_t>(file);
+#else
+			return open(crashFilePath, O_WRONLY | O_CREAT | O_APPEND, 0644);
+#endif
+		}
+
+		void CloseCrashFile(std::intptr_t file)
+		{
+#ifdef _WIN32
+			CloseHandle(reinterpret_cast<HANDLE>(file));
+#else
+			close(static_cast<int>(file));
+#endif
+		}
+
+		// Writes the crash report and hands the signal back to the default handler, which ends the process
+		void OnFatalSignal(int signal)
+		{
+			const char* reason = "fatal signal";
+			switch (signal)
+			{
+			case SIGSEGV: reason = "SIGSEGV"; break;
+			case SIGFPE: reason = "SIGFPE"; break;
+			case SIGILL: reason = "SIGILL"; break;
+			case SIGABRT: reason = "SIGABRT"; break;
+#ifndef _WIN32
+			case SIGBUS: reason = "SIGBUS"; break;
+#endif
+			}
+			CrashHandler::Dump(reason);
+
+			std::signal(signal, SIG_DFL);
+			std::raise(signal);
+		}
+
+		void OnTerminate()
+		{
+			CrashHandler::Dump("std::terminate");
+			std::abort();
+		}
+
+#ifdef _WIN32
+		LONG WINAPI OnUnhandledException(EXCEPTION_POINTERS*)
+		{
+			CrashHandler::Dump("unhandled exception");
+			return EXCEPTION_CONTINUE_SEARCH;
+		}
+#endif
+	}
+
+	std::atomic<CrashDumpSource*> CrashHandler::sources[CrashHandler::maxSources] = {};
+
+	void CrashWriter::Write(const char* text)
+	{
+		Write(text, std::strlen(text));
+	}
+
+	void CrashWriter::Write(const char* text, std::size_t length)
+	{
+		while (length > 0)
+		{
+			if (size == sizeof(buffer))
+			{
+				Flush();
+			}
+			std::size_t n = sizeof(buffer) - size < length ? sizeof(buffer) - size : length;
+			std::memcpy(buffer + size, text, n);
+			size += n;
+			text += n;
+			length -= n;
+		}
+	}
+
+	void CrashWriter::WriteUnsigned(std::uint64_t value)
+	{
+		char text[LogFormatter::maxDigits];
+		Write(text, LogFormatter::FormatUnsigned(value, text));
+	}
+
+	void CrashWriter::WriteSigned(std::int64_t value)
+	{
+		if (value < 0)
+		{
+			Write("-", 1);
+			WriteUnsigned(0 - static_cast<std::uint64_t>(value));
+		}
+		else
+		{
+			WriteUnsigned(static_cast<std::uint64_t>(value));
+		}
+	}
+
+	void CrashWriter::WriteDouble(double value)
+	{
+		// printf is not signal-safe: write a fixed-point number with six decimals, huge values are written with an exponent
+		if (value != value)
+		{
+			Write("nan");
+			return;
+		}
+		if (value < 0)
+		{
+			Write("-", 1);
+			value = -value;
+		}
+		if (value > 1.7976931348623157e308)
+		{
+			Write("inf");
+			return;
+		}
+
+		int exponent = 0;
+		if (value >= 1e18)
+		{
+			while (value >= 10)
+			{
+				value /= 10;
+				exponent++;
+			}
+		}
+
+		std::uint64_t integral = static_cast<std::uint64_t>(value);
+		std::uint64_t fraction = static_cast<std::uint64_t>((value - static_cast<double>(integral)) * 1e6 + 0.5);
+		if (fraction >= 1000000)
+		{
+			integral++;
+			fraction -= 1000000;
+		}
+		WriteUnsigned(integral);
+		char decimals[7] = { '.' };
+		for (int i = 6; i > 0; i--)
+		{
+			decimals[i] = static_cast<char>('0' + fraction % 10);
+			fraction /= 10;
+		}
+		Write(decimals, sizeof(decimals));
+		if (exponent > 0)
+		{
+			Write("e+", 2);
+			WriteUnsigned(static_cast<std::uint64_t>(exponent));
+		}
+	}
+
+	void CrashWriter::WriteRecord(const LogRecord& record, const char* threadName)
+	{
+		WriteSigned(record.timestamp);
+		Write("\t", 1);
+		Write(LogFormatter::GetSeverityLabel(record.severity));
+		Write(threadName);
+		Write(":\t", 2);
+		WriteMessage(record);
+		if (record.repeatCount > 0)
+		{
+			Write(" (repeated ");
+			WriteUnsigned(record.repeatCount);
+			Write(" times)");
+		}
+		Write("\n", 1);
+	}
+
+	void CrashWriter::WriteArgument(const LogArgument& argument)
+	{
+		// the same text as LogFormatter::AppendArgument, but for the floats, which printf must not write here
+		switch (argument.type)
+		{
+		case LogArgumentType::signedInteger:
+			WriteSigned(argument.signedInteger);
+			break;
+
+		case LogArgumentType::unsignedInteger:
+			WriteUnsigned(argument.unsignedInteger);
+			break;
+
+		case LogArgumentType::floatingPoint:
+			WriteDouble(argument.floatingPoint);
+			break;
+
+		case LogArgumentType::boolean:
+			Write(argument.boolean ? "1" : "0", 1);
+			break;
+
+		case LogArgumentType::character:
+			Write(&argument.character, 1);
+			break;
+
+		case LogArgumentType::string:
+			Write(argument.text, argument.length);
+			break;
+		}
+	}
+
+	void CrashWriter::WriteMessage(const LogRecord& record)
+	{
+		// same substitution as LogFormatter::AppendMessage, without touching the heap
+		const char* argument = record.arguments;
+		std::size_t remainingBytes = record.argumentSize < LogRecord::argumentCapacity ? record.argumentSize : LogRecord::argumentCapacity;
+
+		for (const char* c = record.format; c != nullptr && *c != '\0'; c++)
+		{
+			if (*c == '{')
+			{
+				const char* end = c + 1;
+				while (*end != '\0' && *end != '}')
+				{
+					end++;
+				}
+
+				if (*end == '}' && remainingBytes > 0)
+				{
+					LogArgument decoded;
+					const std::size_t used = LogFormatter::DecodeArgument(argument, remainingBytes, decoded);
+					if (used > 0)
+					{
+						WriteArgument(decoded);
+						argument += used;
+						remainingBytes -= used;
+						c = end;
+						continue;
+					}
+				}
+			}
+			Write(c, 1);
+		}
+	}
+
+	void CrashWriter::Flush()
+	{
+		if (size == 0 || file < 0)
+		{
+			size = 0;
+			return;
+		}
+
+#ifdef _WIN32
+		DWORD written;
+		WriteFile(reinterpret_cast<HANDLE>(file), buffer, static_cast<DWORD>(size), &written, NULL);
+#else
+		std::size_t offset = 0;
+		while (offset < size)
+		{
+			ssize_t n = write(static_cast<int>(file), buffer + offset, size - offset);
+			if (n <= 0)
+			{
+				break;
+			}
+			offset += static_cast<std::size_t>(n);
+		}
+#endif
+		size = 0;
+	}
+
+	LogBlackBox::LogBlackBox(std::size_t capacity) :
+		entries(new Entry[capacity > 0 ? capacity : 1]),
+		capacity(capacity > 0 ? capacity : 1),
+		position(0)
+	{
+	}
+
+	void LogBlackBox::Record(const LogRecord& record, const std::string& threadName)
+	{
+		std::size_t p = position.load(std::memory_order_relaxed);
+		Entry& entry = entries[p % capacity];
+		CopyLogRecord(entry.record, record);
+
+		std::size_t n = threadName.size() < sizeof(entry.threadName) - 1 ? threadName.size() : sizeof(entry.threadName) - 1;
+		std::memcpy(entry.threadName, threadName.data(), n);
+		entry.threadName[n] = '\0';
+
+		position.store(p + 1, std::memory_order_release);
+	}
+
+	void LogBlackBox::Dump(CrashWriter& writer) const
+	{
+		// note: if the daemon was recording when the process died, the newest entry may be incomplete
+		std::size_t end = position.load(std::memory_order_acquire);
+		std::size_t begin = end > capacity ? end - capacity : 0;
+		for (std::size_t p = begin; p < end; p++)
+		{
+			const Entry& entry = entries[p % capacity];
+			writer.WriteRecord(entry.record, entry.threadName);
+		}
+	}
+
+	bool CrashHandler::Install(const std::wstring& crashFile)
+	{
+		// the path is converted now, the handlers must not allocate
+#ifdef _WIN32
+		if (crashFile.size() >= MAX_PATH)
+		{
+			return false;
+		}
+		std::memcpy(crashFilePath, crashFile.c_str(), (crashFile.size() + 1) * sizeof(wchar_t));
+
+		SetUnhandledExceptionFilter(OnUnhandledException);
+#else
+		std::string path = StringConverter::ws2s(crashFile);
+		if (path.size() >= sizeof(crashFilePath))
+		{
+			return false;
+		}
+		std::memcpy(crashFilePath, path.c_str(), path.size() + 1);
+
+		// the handlers run on an alternate stack, thus a stack overflow can still be reported
+		static char alternateStack[64 * 1024];
+		stack_t stack = {};
+		stack.ss_sp = alternateStack;
+		stack.ss_size = sizeof(alternateStack);
+		sigaltstack(&stack, nullptr);
+
+		struct sigaction action = {};
+		action.sa_handler = OnFatalSignal;
+		action.sa_flags = SA_ONSTACK | SA_RESETHAND;
+		sigemptyset(&action.sa_mask);
+		sigaction(SIGBUS, &action, nullptr);
+#endif
+
+		for (int signal : { SIGSEGV, SIGFPE, SIGILL, SIGABRT })
+		{
+#ifdef _WIN32
+			std::signal(signal, OnFatalSignal);
+#else
+			sigaction(signal, &action, nullptr);
+#endif
+		}
+
+		std::set_terminate(OnTerminate);
+		return true;
+	}
+
+	bool CrashHandler::Register(CrashDumpSource* source)
+	{
+		for (std::size_t i = 0; i < maxSources; i++)
+		{
+			CrashDumpSource* expected = nullptr;
+			if (sources[i].compare_exchange_strong(expected, source))
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+
+	void CrashHandler::Unregister(CrashDumpSource* source)
+	{
+		for (std::size_t i = 0; i < maxSources; i++)
+		{
+			CrashDumpSource* expected = source;
+			sources[i].compare_exchange_strong(expected, nullptr);
+		}
+	}
+
+	void CrashHandler::Dump(const char* reason)
+	{
+		if (hasCrashed.exchange(true))
+		{
+			return;
+		}
+
+		std::intptr_t file = OpenCrashFile();
+		if (file < 0)
+		{
+			return;
+		}
+
+		{
+			CrashWriter writer(file);
+			writer.Write("*** The game crashed: ");
+			writer.Write(reason);
+			writer.Write(" ***\n");
+			for (std::size_t i = 0; i < maxSources; i++)
+			{
+				CrashDumpSource* source = sources[i].load(std::memory_order_acquire);
+				if (source != nullptr)
+				{
+					source->DumpOnCrash(writer);
+				}
+			}
+		}
+		CloseCrashFile(file);
+	}
+}
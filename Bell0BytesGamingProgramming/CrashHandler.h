@@ -0,0 +1,108 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* CrashHandler.h
+*
+* Crash-safe logging: fatal-signal and terminate handlers, a signal-safe writer and the log black box
+*
+* When the process dies, the handlers dump the black boxes (the last messages the logging daemon has processed) and drain
+* the messages still waiting in the log buffers into the crash file. Everything that runs inside a handler only uses
+* preallocated memory and plain system calls: no allocations, no locks, no locale.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <atomic>			// atomic objects (no data races)
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <memory>			// std::unique_ptr
+#include <string>			// strings
+
+// Project includes
+#include "LogRecord.h"
+
+#pragma endregion
+
+namespace util
+{
+	// Writes text and log records to the crash file through a fixed buffer; async-signal-safe
+	class CrashWriter
+	{
+	public:
+		explicit CrashWriter(std::intptr_t file) : file(file), size(0) {};
+		~CrashWriter() { Flush(); };
+
+		void Write(const char* text);
+		void Write(const char* text, std::size_t length);
+		void WriteUnsigned(std::uint64_t value);
+		void WriteSigned(std::int64_t value);
+		void WriteDouble(double value);
+
+		// "timestamp SEVERITY thread:\tmessage"; the timestamp is written in nanoseconds, converting it to local time is not signal-safe
+		void WriteRecord(const LogRecord& record, const char* threadName);
+		void Flush();
+
+	private:
+		void WriteArgument(const LogArgument& argument);
+		void WriteMessage(const LogRecord& record);
+
+	private:
+		std::intptr_t file;			// the file descriptor or handle of the crash file
+		std::size_t size;			// number of bytes in the buffer
+		char buffer[4096];
+	};
+
+	// The last messages processed by the logging daemon, kept in memory for the crash file
+	class LogBlackBox
+	{
+	public:
+		LogBlackBox(std::size_t capacity);
+		~LogBlackBox() {};
+
+		void Record(const LogRecord& record, const std::string& threadName);	// daemon only
+		void Dump(CrashWriter& writer) const;									// async-signal-safe, oldest message first
+
+	private:
+		struct Entry
+		{
+			LogRecord record;
+			char threadName[32];
+		};
+
+		std::unique_ptr<Entry[]> entries;			// preallocated, overwritten in a circle
+		const std::size_t capacity;
+		std::atomic<std::size_t> position;			// number of messages ever recorded
+	};
+
+	// Anything that has messages to save when the process dies; implemented by the loggers
+	class CrashDumpSource
+	{
+	public:
+		virtual ~CrashDumpSource() noexcept = default;
+
+		// Called from within the crash handlers: must be async-signal-safe
+		virtual void DumpOnCrash(CrashWriter& writer) = 0;
+	};
+
+	class CrashHandler
+	{
+	public:
+		// Installs the fatal-signal, unhandled exception and terminate handlers; the crash report is appended to the given file
+		static bool Install(const std::wstring& crashFile);
+
+		static bool Register(CrashDumpSource* source);
+		static void Unregister(CrashDumpSource* source);
+
+		// Writes the crash report; only the first call does anything, thus a crash inside the handler cannot loop
+		static void Dump(const char* reason);
+
+	private:
+		static const std::size_t maxSources = 4;
+		static std::atomic<CrashDumpSource*> sources[maxSources];
+	};
+}
@@ -32,6 +32,24 @@
 
 namespace graphics
 {
+	namespace
+	{
+		// the DXGI format of an element of a vertex
+		DXGI_FORMAT GetDxgiFormat(VertexFormat format)
+		{
+			switch (format)
+			{
+			case VertexFormat::float3:
+				return DXGI_FORMAT_R32G32B32_FLOAT;
+			case VertexFormat::half4:
+				return DXGI_FORMAT_R16G16B16A16_FLOAT;
+			case VertexFormat::unorm8x4:
+				return DXGI_FORMAT_R8G8B8A8_UNORM;
+			}
+			return DXGI_FORMAT_UNKNOWN;
+		}
+	}
+
 	Direct3D::Direct3D(core::DirectXApp* directXApp) : 
 		directXApp(directXApp), 
 		desiredColoredFormat(DXGI_FORMAT_B8G8R8A8_UNORM),
@@ -242,6 +260,7 @@ namespace graphics
 
 	util::Expected<void> Direct3D::OnResize()
 	{
+		PROFILE_ZONE("Resize Direct3D");
 		HRESULT hr;
 
 		DXGI_MODE_DESC zeroRefreshRate = currentModeDescription;
@@ -308,10 +327,13 @@ namespace graphics
 		depthStencilView = nullptr;
 
 		// Resize the swapchain
-		hr = swapChain->ResizeBuffers(0, 0, 0, desiredColoredFormat, 0);
-		if (FAILED(hr))
 		{
-			return std::runtime_error("Direct3D was unable to resize the swap chain!");
+			PROFILE_ZONE("Resize swap chain buffers");
+			hr = swapChain->ResizeBuffers(0, 0, 0, desiredColoredFormat, 0);
+			if (FAILED(hr))
+			{
+				return std::runtime_error("Direct3D was unable to resize the swap chain!");
+			}
 		}
 
 		// Get the swapchain backbuffer
@@ -404,14 +426,6 @@ namespace graphics
 		return 0;
 	}
 
-	void Direct3D::ClearBuffers()
-	{
-		// Clear back buffer and depth/stencil buffer
-		float black[] = { 0.0f, 0.0f, 0.0f, 0.0f };
-		devCon->ClearRenderTargetView(renderTargetView.Get(), black);
-		devCon->ClearDepthStencilView(depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
-	}
-
 	util::Expected<ShaderBuffer> Direct3D::LoadShader(std::wstring filename)
 	{
 		// Load the precompiled .cso shader
@@ -474,27 +488,20 @@ namespace graphics
 
 		// Set the input layout for the vertex shader
 
-		// Specify the input layout
-		D3D11_INPUT_ELEMENT_DESC ied[] = { 
-		{
-			"POSITION",						// semantic
-			0,								// semantic index
-			DXGI_FORMAT_R32G32B32_FLOAT,	// data format
-			0,								// input slot (which input-assembler to use)
-			0,								// byte offset between elements
-			D3D11_INPUT_PER_VERTEX_DATA,	// type of data
-			0								// number of instances with the same data (0 for vertex data)
-		}, 
+		// Specify the input layout, from the description of the packed vertex
+		D3D11_INPUT_ELEMENT_DESC ied[ARRAYSIZE(packedVertexLayout)];
+		for (unsigned int i = 0; i < ARRAYSIZE(packedVertexLayout); i++)
 		{
-			"COLOR",
-			0,
-			DXGI_FORMAT_R32G32B32_FLOAT,
-			0,
-			12,
-			D3D11_INPUT_PER_VERTEX_DATA,
-			0
+			ied[i] = {
+				packedVertexLayout[i].semantic,					// semantic
+				packedVertexLayout[i].semanticIndex,			// semantic index
+				GetDxgiFormat(packedVertexLayout[i].format),	// data format
+				0,												// input slot (which input-assembler to use)
+				packedVertexLayout[i].offset,					// byte offset from the start of the vertex
+				D3D11_INPUT_PER_VERTEX_DATA,					// type of data
+				0												// number of instances with the same data (0 for vertex data)
+			};
 		}
-		};
 
 		// Create the input layout
 		Microsoft::WRL::ComPtr<ID3D11InputLayout> inputLayout;
@@ -505,6 +512,10 @@ namespace graphics
 			vertexShaderBuffer.get().size,		// shader length
 			&inputLayout						// out: input layout
 		);
+		if (FAILED(hr))
+		{
+			return "Critical error: Unable to create the input layout!";
+		}
 
 		// Set this input layout as active
 		devCon->IASetInputLayout(inputLayout.Get());
@@ -617,11 +628,7 @@ namespace graphics
 
 				// Check fullscreen config
 				startInFullscreen = lua["config"]["fullscreen"].get_or(false);
-#ifndef NDEBUG
-				std::stringstream res;
-				res << "The fullscreen mode was read from the LUA configuration file: " << std::noboolalpha << startInFullscreen << ".";
-				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>(res.str());
-#endif
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The fullscreen mode was read from the LUA configuration file: {}.", startInFullscreen);
 			}
 			catch (std::exception)
 			{
@@ -631,4 +638,72 @@ namespace graphics
 
 		return {};
 	}
+
+	util::Expected<BufferHandle> Direct3DRenderDevice::CreateBuffer(std::size_t size)
+	{
+		// read by the GPU, written by the CPU
+		D3D11_BUFFER_DESC bd;
+		bd.ByteWidth = static_cast<unsigned int>(size);
+		bd.Usage = D3D11_USAGE_DYNAMIC;
+		bd.BindFlags = D3D11_BIND_VERTEX_BUFFER;
+		bd.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
+		bd.MiscFlags = 0;
+		bd.StructureByteStride = 0;
+
+		Microsoft::WRL::ComPtr<ID3D11Buffer> buffer;
+		HRESULT hr = direct3D.dev->CreateBuffer(&bd, nullptr, &buffer);
+		if (FAILED(hr))
+		{
+			return std::runtime_error("Critical Error: Unable to create vertex buffer!");
+		}
+
+		buffers.push_back(buffer);
+		return static_cast<BufferHandle>(buffers.size() - 1);
+	}
+
+	util::Expected<void*> Direct3DRenderDevice::MapBuffer(BufferHandle buffer, MapMode mode)
+	{
+		D3D11_MAPPED_SUBRESOURCE mapped;
+		HRESULT hr = direct3D.devCon->Map(buffers[buffer].Get(), 0, mode == MapMode::discard ? D3D11_MAP_WRITE_DISCARD : D3D11_MAP_WRITE_NO_OVERWRITE, 0, &mapped);
+		if (FAILED(hr))
+		{
+			return std::runtime_error("Critical error: Unable to map the dynamic buffer!");
+		}
+		return mapped.pData;
+	}
+
+	void Direct3DRenderDevice::UnmapBuffer(BufferHandle buffer)
+	{
+		direct3D.devCon->Unmap(buffers[buffer].Get(), 0);
+	}
+
+	void Direct3DRenderDevice::SetVertexBuffer(BufferHandle buffer, std::size_t stride, std::size_t offset)
+	{
+		unsigned int strides = static_cast<unsigned int>(stride);
+		unsigned int offsets = static_cast<unsigned int>(offset);
+		direct3D.devCon->IASetVertexBuffers(0, 1, buffers[buffer].GetAddressOf(), &strides, &offsets);
+	}
+
+	void Direct3DRenderDevice::Clear(const float* rgba)
+	{
+		// Clear back buffer and depth/stencil buffer
+		direct3D.devCon->ClearRenderTargetView(direct3D.renderTargetView.Get(), rgba);
+		direct3D.devCon->ClearDepthStencilView(direct3D.depthStencilView.Get(), D3D11_CLEAR_DEPTH | D3D11_CLEAR_STENCIL, 1.0f, 0);
+	}
+
+	void Direct3DRenderDevice::Draw(std::size_t vertexCount, std::size_t firstVertex)
+	{
+		direct3D.devCon->IASetPrimitiveTopology(D3D11_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+		direct3D.devCon->Draw(static_cast<unsigned int>(vertexCount), static_cast<unsigned int>(firstVertex));
+	}
+
+	util::Expected<void> Direct3DRenderDevice::Present()
+	{
+		util::Expected<int> result = direct3D.Present();
+		if (!result.isValid())
+		{
+			return result;
+		}
+		return {};
+	}
 }
\ No newline at end of file
@@ -20,6 +20,8 @@
 
 // Project includes
 #include "Expected.h"
+#include "RenderDevice.h"
+#include "Vertex.h"
 
 #pragma endregion
 
@@ -40,20 +42,6 @@ namespace core
 
 namespace graphics
 {
-	// Represents a single vertex (point)
-	struct Vertex
-	{
-		// position
-		float x;
-		float y;
-		float z;
-
-		// color
-		float r;
-		float g;
-		float b;
-	};
-
 	struct ShaderBuffer
 	{
 		BYTE* buffer;
@@ -67,6 +55,7 @@ namespace graphics
 		friend class Direct2D;
 		friend class DirectXGame;
 		friend class core::Window;
+		friend class Direct3DRenderDevice;
 
 		Direct3D(core::DirectXApp* directXApp);
 		~Direct3D();
@@ -82,7 +71,6 @@ namespace graphics
 		util::Expected<void> ReadConfigurationFile();
 
 		util::Expected<int> Present();							// display the next backbuffer
-		void ClearBuffers();
 
 	private:
 		Microsoft::WRL::ComPtr<ID3D11Device> dev;							// device
@@ -108,5 +96,29 @@ namespace graphics
 
 		core::DirectXApp* directXApp;
 	};
+
+	// Renders through the immediate context of Direct3D; the shaders are the compiled HLSL shaders bound by InitPipeline,
+	// thus the shader callbacks are ignored
+	class Direct3DRenderDevice : public RenderDevice
+	{
+	public:
+		Direct3DRenderDevice(Direct3D& direct3D) : direct3D(direct3D) {};
+		~Direct3DRenderDevice() {};
+
+		util::Expected<BufferHandle> CreateBuffer(std::size_t size) override;
+		util::Expected<void*> MapBuffer(BufferHandle buffer, MapMode mode) override;
+		void UnmapBuffer(BufferHandle buffer) override;
+
+		void SetVertexBuffer(BufferHandle buffer, std::size_t stride, std::size_t offset) override;
+		void SetShaders(const VertexShaderFunction& /*vertexShader*/, const PixelShaderFunction& /*pixelShader*/) override {};
+
+		void Clear(const float* rgba) override;
+		void Draw(std::size_t vertexCount, std::size_t firstVertex) override;
+		util::Expected<void> Present() override;
+
+	private:
+		Direct3D& direct3D;														// owns the device and the context
+		std::vector<Microsoft::WRL::ComPtr<ID3D11Buffer>> buffers;				// dynamic vertex buffers
+	};
 }
 
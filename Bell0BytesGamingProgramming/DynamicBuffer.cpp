@@ -0,0 +1,199 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* DynamicBuffer.cpp
+*
+* Uploads only what changed into a dynamic GPU buffer, independent of Direct3D
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::sort, std::fill
+#include <cstring>			// std::memcpy
+#include <stdexcept>		// std::invalid_argument
+
+// Project includes
+#include "DynamicBuffer.h"
+
+#pragma endregion
+
+namespace graphics
+{
+	namespace
+	{
+		// what a discarded buffer holds: anything but the old data
+		const unsigned char scrambledByte = 0xcd;
+
+		std::size_t CountBytes(const std::vector<ByteRange>& ranges)
+		{
+			std::size_t bytes = 0;
+			for (const ByteRange& range : ranges)
+			{
+				bytes += range.end - range.begin;
+			}
+			return bytes;
+		}
+	}
+
+	void MergeRanges(std::vector<ByteRange>& ranges, std::size_t gap)
+	{
+		if (ranges.size() < 2)
+		{
+			return;
+		}
+
+		std::sort(ranges.begin(), ranges.end(), [](const ByteRange& a, const ByteRange& b) { return a.begin < b.begin; });
+
+		// grow the last merged range while the next one starts at most gap bytes after its end
+		std::size_t merged = 0;
+		for (std::size_t i = 1; i < ranges.size(); i++)
+		{
+			if (ranges[i].begin <= ranges[merged].end + gap)
+			{
+				ranges[merged].end = (std::max)(ranges[merged].end, ranges[i].end);
+			}
+			else
+			{
+				ranges[++merged] = ranges[i];
+			}
+		}
+		ranges.resize(merged + 1);
+	}
+
+#pragma region "Fake Device"
+
+	FakeBufferDevice::FakeBufferDevice(std::size_t size) : memory(size, scrambledByte), isMapped(false), discardMaps(0), noOverwriteMaps(0) {}
+
+	util::Expected<void*> FakeBufferDevice::Map(MapMode mode)
+	{
+		if (isMapped)
+		{
+			return std::runtime_error("The fake buffer is already mapped!");
+		}
+		isMapped = true;
+
+		if (mode == MapMode::discard)
+		{
+			std::fill(memory.begin(), memory.end(), scrambledByte);
+			discardMaps++;
+		}
+		else
+		{
+			noOverwriteMaps++;
+		}
+		return static_cast<void*>(memory.data());
+	}
+
+	void FakeBufferDevice::Unmap()
+	{
+		isMapped = false;
+	}
+
+#pragma endregion
+
+#pragma region "Dynamic Buffer"
+
+	DynamicBuffer::DynamicBuffer(BufferDevice& device, std::size_t size, unsigned int regionCount, std::size_t mergeGap, double discardFraction) :
+		device(device), size(size), mergeGap(mergeGap), discardBytes(static_cast<std::size_t>(discardFraction * size)), regions(regionCount), currentRegion(0), statistics()
+	{
+		if (regionCount == 0)
+		{
+			throw std::invalid_argument("A dynamic buffer needs at least one region!");
+		}
+
+		// nothing was written yet: the first upload writes the first region
+		for (Region& region : regions)
+		{
+			region.isStale = true;
+		}
+		currentRegion = regions.size() - 1;
+		MarkAllDirty();
+	}
+
+	void DynamicBuffer::MarkDirty(std::size_t offset, std::size_t size)
+	{
+		const std::size_t end = (std::min)(offset + size, this->size);
+		if (offset < end)
+		{
+			dirtyRanges.push_back({ offset, end });
+		}
+	}
+
+	util::Expected<void> DynamicBuffer::Upload(const void* data)
+	{
+		const unsigned char* source = static_cast<const unsigned char*>(data);
+		return Upload([source](unsigned char* region, const ByteRange& range)
+		{
+			std::memcpy(region + range.begin, source + range.begin, range.end - range.begin);
+		});
+	}
+
+	util::Expected<void> DynamicBuffer::Upload(const WriteFunction& write)
+	{
+		if (dirtyRanges.empty())
+		{
+			statistics.skips++;
+			return {};
+		}
+
+		// the dirty ranges are stale in every region; if most of the data is dirty, the buffer is discarded and every
+		// region is stale as a whole
+		MergeRanges(dirtyRanges, mergeGap);
+		const bool isDiscarding = CountBytes(dirtyRanges) >= discardBytes;
+		for (Region& region : regions)
+		{
+			if (isDiscarding)
+			{
+				region.isStale = true;
+				region.staleRanges.clear();
+			}
+			else if (!region.isStale)
+			{
+				region.staleRanges.insert(region.staleRanges.end(), dirtyRanges.begin(), dirtyRanges.end());
+				MergeRanges(region.staleRanges, mergeGap);
+			}
+		}
+		dirtyRanges.clear();
+
+		const std::size_t next = (currentRegion + 1) % regions.size();
+		Region& region = regions[next];
+
+		util::Expected<void*> mapped = device.Map(isDiscarding ? MapMode::discard : MapMode::noOverwrite);
+		if (!mapped.isValid())
+		{
+			return mapped;
+		}
+		unsigned char* start = static_cast<unsigned char*>(mapped.get()) + next * size;
+
+		if (isDiscarding || region.isStale)
+		{
+			// the whole region
+			write(start, { 0, size });
+			statistics.ranges++;
+			statistics.bytes += size;
+			statistics.discards += isDiscarding ? 1 : 0;
+		}
+		else
+		{
+			for (const ByteRange& range : region.staleRanges)
+			{
+				write(start, range);
+				statistics.ranges++;
+				statistics.bytes += range.end - range.begin;
+			}
+		}
+		device.Unmap();
+
+		region.isStale = false;
+		region.staleRanges.clear();
+		currentRegion = next;
+		statistics.uploads++;
+		return {};
+	}
+
+#pragma endregion
+}
@@ -0,0 +1,143 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* DynamicBuffer.h
+*
+* Uploads only what changed into a dynamic GPU buffer, independent of Direct3D
+*
+* The buffer holds regionCount copies of the data, the regions, used in turn: every frame that changed something writes
+* the next region and draws from it, while the GPU may still read the previous ones. A region is written again
+* regionCount frames later, when the GPU is done with it, thus it is mapped without discarding the buffer (no-overwrite)
+* and only its stale bytes are written: the ranges marked dirty since the region was last written, sorted and merged.
+*
+* If most of the data changed in one frame, the buffer is discarded instead and the whole region written: the GPU never
+* waits on a discarded buffer, but its other regions are lost, thus they are stale as a whole until they are written
+* again, without discarding, once it is their turn. Frames without dirty ranges write nothing and keep drawing from the
+* same region.
+*
+* The device maps the buffer: Direct3D in the game, a block of memory in the benchmarks. The data comes from the caller,
+* either as the whole current data in system memory, or as a function that writes the bytes of a range itself.
+*
+* A region must not be written while the GPU reads it, thus regionCount must exceed the number of frames the GPU may lag
+* behind the CPU, 3 by default with DXGI.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstddef>			// std::size_t
+#include <functional>		// std::function
+#include <vector>			// vector containers
+
+// Project includes
+#include "Expected.h"
+
+#pragma endregion
+
+namespace graphics
+{
+	// The bytes [begin, end) of a region
+	struct ByteRange
+	{
+		std::size_t begin;
+		std::size_t end;
+	};
+
+	// Sorts the ranges and merges those that overlap or are at most gap bytes apart
+	void MergeRanges(std::vector<ByteRange>& ranges, std::size_t gap);
+
+	// How a buffer is mapped
+	enum class MapMode
+	{
+		discard,			// the contents are lost, the GPU keeps reading the old ones
+		noOverwrite			// the contents are kept, the bytes the GPU reads must not be written
+	};
+
+	// Maps and unmaps a buffer for writing
+	class BufferDevice
+	{
+	public:
+		virtual ~BufferDevice() {};
+
+		virtual util::Expected<void*> Map(MapMode mode) = 0;		// the start of the buffer
+		virtual void Unmap() = 0;
+	};
+
+	// A buffer in system memory that behaves like a dynamic GPU buffer: discarding it scrambles its contents
+	class FakeBufferDevice : public BufferDevice
+	{
+	public:
+		explicit FakeBufferDevice(std::size_t size);
+		~FakeBufferDevice() {};
+
+		util::Expected<void*> Map(MapMode mode) override;
+		void Unmap() override;
+
+		// Getters
+		const unsigned char* GetMemory() const { return memory.data(); };
+		unsigned long long GetDiscardMaps() const { return discardMaps; };
+		unsigned long long GetNoOverwriteMaps() const { return noOverwriteMaps; };
+
+	private:
+		std::vector<unsigned char> memory;			// the buffer
+		bool isMapped;								// between Map and Unmap
+		unsigned long long discardMaps;				// maps that discarded the buffer
+		unsigned long long noOverwriteMaps;			// maps that kept the buffer
+	};
+
+	// Counters since the dynamic buffer was created
+	struct DynamicBufferStatistics
+	{
+		unsigned long long uploads;			// frames that wrote a region
+		unsigned long long skips;			// frames without dirty ranges
+		unsigned long long discards;		// uploads that discarded the buffer
+		unsigned long long ranges;			// ranges written
+		unsigned long long bytes;			// bytes written
+	};
+
+	class DynamicBuffer
+	{
+	public:
+		typedef std::function<void(unsigned char*, const ByteRange&)> WriteFunction;		// write(region, range): writes region[range.begin, range.end)
+
+		// The buffer of the device must hold regionCount * size bytes; stale ranges at most mergeGap bytes apart are
+		// written as one, and the buffer is discarded if discardFraction of the data changed since the last upload
+		DynamicBuffer(BufferDevice& device, std::size_t size, unsigned int regionCount = 4, std::size_t mergeGap = 256, double discardFraction = 0.5);
+		~DynamicBuffer() {};
+
+		// Marks bytes of the data as changed since the last upload
+		void MarkDirty(std::size_t offset, std::size_t size);
+		void MarkAllDirty() { MarkDirty(0, size); };
+
+		// Writes the stale bytes of the next region, if anything is dirty; data is the whole current data
+		util::Expected<void> Upload(const void* data);
+		util::Expected<void> Upload(const WriteFunction& write);
+
+		// Getters
+		std::size_t GetSize() const { return size; };
+		std::size_t GetBufferSize() const { return size * regions.size(); };
+		std::size_t GetRegionOffset() const { return currentRegion * size; };		// where the current data starts in the buffer
+		const DynamicBufferStatistics& GetStatistics() const { return statistics; };
+
+	private:
+		struct Region
+		{
+			std::vector<ByteRange> staleRanges;		// changed since the region was last written, merged
+			bool isStale;							// the whole region must be written
+		};
+
+		BufferDevice& device;						// maps the buffer
+		const std::size_t size;						// bytes per region
+		const std::size_t mergeGap;					// stale ranges at most this far apart are written as one
+		const std::size_t discardBytes;				// dirty bytes of a frame from which the buffer is discarded
+		std::vector<ByteRange> dirtyRanges;			// marked since the last upload
+		std::vector<Region> regions;				// the copies of the data
+		std::size_t currentRegion;					// the region written last
+		DynamicBufferStatistics statistics;
+	};
+}
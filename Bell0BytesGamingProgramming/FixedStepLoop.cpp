@@ -0,0 +1,152 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FixedStepLoop.cpp
+*
+* The fixed time step of the game loop, independent of windows and clocks
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <stdexcept>		// std::invalid_argument
+
+// Project includes
+#include "ServiceLocator.h"
+#include "FixedStepLoop.h"
+
+#pragma endregion
+
+namespace core
+{
+	namespace
+	{
+		const double costWeight = 1.0 / 16.0;			// weight of the latest frame in the smoothed update cost
+		const unsigned int spiralFrames = 8;			// consecutive frames falling behind at maxSkipFrames that make a spiral
+	}
+
+	FixedStepLoop::FixedStepLoop(double dt, int maxSkipFrames, CatchUpPolicyType policyType) :
+		dt(dt),
+		maxSkipFrames(maxSkipFrames),
+		accumulatedTime(0.0),
+		lastFrame(),
+		frames(0),
+		updates(0),
+		framesAtMaxSkipFrames(0),
+		policy(CatchUpPolicy::Create(policyType)),
+		costClock(nullptr),
+		updateCost(0.0),
+		telemetry()
+	{
+		if (!(dt > 0.0) || maxSkipFrames < 1)
+		{
+			throw std::invalid_argument("The fixed time step must be positive and allow at least one update per frame!");
+		}
+		lastFrame.stepTime = dt;
+	}
+
+	void FixedStepLoop::SetPolicy(std::unique_ptr<CatchUpPolicy> policy)
+	{
+		if (!policy)
+		{
+			throw std::invalid_argument("The fixed time step needs a catch-up policy!");
+		}
+		this->policy = std::move(policy);
+	}
+
+	void FixedStepLoop::SetCostClock(const ClockSource* clock)
+	{
+		costClock = clock;
+		updateCost = 0.0;
+	}
+
+	void FixedStepLoop::Reset()
+	{
+		accumulatedTime = 0.0;
+		lastFrame = FixedStepFrame();
+		lastFrame.stepTime = dt;
+		frames = 0;
+		updates = 0;
+		framesAtMaxSkipFrames = 0;
+		policy->Reset();
+		updateCost = 0.0;
+		telemetry = CatchUpTelemetry();
+	}
+
+	void FixedStepLoop::LogTelemetry() const
+	{
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("Catch-up policy {policy}: {dropped} seconds dropped, {dilated} seconds dilated ({steps} steps skipped), max debt {debt} seconds, {spiral} frames fell behind.", policy->GetName(), telemetry.droppedTime, telemetry.dilatedTime, telemetry.skippedSteps, telemetry.maxDebt, telemetry.spiralFrames);
+	}
+
+	CatchUpState FixedStepLoop::GetState(double stepTime) const
+	{
+		return { dt, maxSkipFrames, accumulatedTime, stepTime, lastFrame.updates, lastFrame.hitMaxSkipFrames, updateCost };
+	}
+
+	void FixedStepLoop::SettleDebt(double admittedTime, double elapsedTime, std::int64_t updateCounts)
+	{
+		// the real cost of an update, and how it compares to the time it simulates
+		lastFrame.updateTime = costClock ? updateCounts * costClock->GetSecondsPerCount() : 0.0;
+		if (lastFrame.updates > 0 && costClock)
+		{
+			double cost = lastFrame.updateTime / lastFrame.updates;
+			updateCost = updateCost > 0.0 ? updateCost + costWeight * (cost - updateCost) : cost;
+
+			double costRatio = updateCost / lastFrame.stepTime;
+			telemetry.updateCostTrend += costWeight * ((costRatio - telemetry.updateCostRatio) - telemetry.updateCostTrend);
+			telemetry.updateCostRatio = costRatio;
+		}
+
+		// the policy decides how much of the debt is carried into the next frame
+		const double debt = accumulatedTime;
+		accumulatedTime = policy->SettleDebt(GetState(lastFrame.stepTime));
+		double heldBackTime = 0.0;
+		if (admittedTime < elapsedTime)
+		{
+			heldBackTime += elapsedTime - admittedTime;
+			telemetry.dilatedTime += elapsedTime - admittedTime;
+		}
+		if (accumulatedTime < debt)
+		{
+			heldBackTime += debt - accumulatedTime;
+			telemetry.droppedTime += debt - accumulatedTime;
+		}
+		telemetry.skippedSteps = (unsigned long long)((telemetry.droppedTime + telemetry.dilatedTime) / dt);
+
+		// a frame that runs maxSkipFrames updates and still falls behind, frame after frame, never catches up
+		if (lastFrame.updates == maxSkipFrames && (accumulatedTime > telemetry.debt || heldBackTime > 0.0))
+		{
+			telemetry.behindFrames++;
+		}
+		else
+		{
+			telemetry.behindFrames = 0;
+		}
+		telemetry.debt = accumulatedTime;
+		if (accumulatedTime > telemetry.maxDebt)
+		{
+			telemetry.maxDebt = accumulatedTime;
+		}
+
+		bool isSpiraling = telemetry.behindFrames >= spiralFrames || telemetry.updateCostRatio >= 1.0;
+		if (isSpiraling != telemetry.isSpiraling)
+		{
+			if (isSpiraling)
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::warning>("The updates fall behind the real time: an update costs {ratio} times the time it simulates, the debt is {debt} seconds. Catch-up policy: {policy}.", telemetry.updateCostRatio, telemetry.debt, policy->GetName());
+			}
+			else
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The updates caught up with the real time; {frames} frames fell behind so far.", telemetry.spiralFrames);
+			}
+			telemetry.isSpiraling = isSpiraling;
+		}
+		if (isSpiraling)
+		{
+			telemetry.spiralFrames++;
+		}
+	}
+}
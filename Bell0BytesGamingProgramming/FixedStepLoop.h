@@ -0,0 +1,146 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FixedStepLoop.h
+*
+* The fixed time step of the game loop, independent of windows and clocks
+*
+* The time that passed since the previous frame is accumulated and used up in steps of delta-t; at most maxSkipFrames
+* updates are run per frame. The renderer then predicts the future by the remaining fraction of a step (farseer).
+*
+* A catch-up policy (CatchUpPolicy.h) decides what happens when the updates fall behind. The loop keeps telemetry of the
+* debt, of the time the policy dropped or dilated, and of the cost of an update relative to its step: a spiral of death
+* is reported when the updates cost more than the time they simulate, or when frame after frame runs maxSkipFrames
+* updates and still falls behind, be it by a growing debt or by time the policy held back.
+*
+* The loop is driven by DirectXApp::Run with the real time of the timer and by the HeadlessRunner with virtual time.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstdint>			// fixed width integers
+#include <memory>			// std::unique_ptr
+
+// Project includes
+#include "CatchUpPolicy.h"
+#include "ClockSource.h"
+#include "Expected.h"
+
+#pragma endregion
+
+namespace core
+{
+	// What happened during the last frame
+	struct FixedStepFrame
+	{
+		int updates;					// number of updates run during the frame
+		bool hitMaxSkipFrames;			// true if the updates stopped at maxSkipFrames with a full step of time left over
+		double farseer;					// the fraction of a step the renderer was asked to predict
+		double stepTime;				// the length of the steps
+		double updateTime;				// real time spent updating, 0 without a cost clock
+	};
+
+	// How the updates keep up with the real time, times in seconds
+	struct CatchUpTelemetry
+	{
+		double debt;						// accumulated time not simulated yet
+		double maxDebt;						// the largest debt after the updates of a frame
+		double droppedTime;					// time the policy discarded
+		double dilatedTime;					// real time the policy did not admit, i.e. slowed down or clamped
+		unsigned long long skippedSteps;	// the dropped and dilated time in steps of dt
+		double updateCostRatio;				// smoothed real time of an update per simulated time of its step; at 1, the updates can not keep up
+		double updateCostTrend;				// smoothed change of the cost ratio per frame
+		unsigned int behindFrames;			// consecutive frames that ran maxSkipFrames updates and still fell behind
+		bool isSpiraling;					// the updates can not keep up
+		unsigned long long spiralFrames;	// number of frames spent spiraling
+	};
+
+	class FixedStepLoop
+	{
+	public:
+		FixedStepLoop(double dt, int maxSkipFrames, CatchUpPolicyType policyType = CatchUpPolicyType::strict);
+
+		void SetPolicy(std::unique_ptr<CatchUpPolicy> policy);
+		void SetCostClock(const ClockSource* clock);		// measures the real cost of the updates; null to stop measuring
+
+		// Accumulates the elapsed time (in seconds), runs the updates it pays for and renders once; the updater is called
+		// as update(stepTime), the renderer as render(farseer), both return a util::Expected<int>
+		template<typename Updater, typename Renderer>
+		util::Expected<int> RunFrame(double elapsedTime, Updater&& update, Renderer&& render);
+
+		void Reset();					// forget the accumulated time, the counters and the telemetry
+		void LogTelemetry() const;		// writes a summary of the telemetry since the last reset to the log
+
+		// Getters
+		double GetDeltaTime() const { return dt; };
+		int GetMaxSkipFrames() const { return maxSkipFrames; };
+		double GetAccumulatedTime() const { return accumulatedTime; };
+		const FixedStepFrame& GetLastFrame() const { return lastFrame; };
+		unsigned long long GetFrameCount() const { return frames; };
+		unsigned long long GetUpdateCount() const { return updates; };
+		unsigned long long GetMaxSkipFramesCount() const { return framesAtMaxSkipFrames; };
+		const CatchUpPolicy& GetPolicy() const { return *policy; };
+		const CatchUpTelemetry& GetTelemetry() const { return telemetry; };
+
+	private:
+		CatchUpState GetState(double stepTime) const;
+		void SettleDebt(double admittedTime, double elapsedTime, std::int64_t updateCounts);		// lets the policy settle the debt of the frame and updates the telemetry
+
+	private:
+		const double dt;						// delta-t, the constant update rate of the game
+		const int maxSkipFrames;				// max number of updates per frame
+		double accumulatedTime;					// time accumulated by rendering rather than updating physics
+
+		FixedStepFrame lastFrame;
+		unsigned long long frames;				// number of frames rendered since the last reset
+		unsigned long long updates;				// number of updates run since the last reset
+		unsigned long long framesAtMaxSkipFrames;	// number of frames that hit maxSkipFrames
+
+		std::unique_ptr<CatchUpPolicy> policy;	// decides what to do when the updates fall behind
+		const ClockSource* costClock;			// measures the updates, may be null
+		double updateCost;						// smoothed real time of an update
+		CatchUpTelemetry telemetry;
+	};
+
+	template<typename Updater, typename Renderer>
+	util::Expected<int> FixedStepLoop::RunFrame(double elapsedTime, Updater&& update, Renderer&& render)
+	{
+		// Add the rendering time (time between frames), as far as the policy admits it
+		const double admittedTime = policy->AdmitTime(elapsedTime, GetState(lastFrame.stepTime));
+		accumulatedTime += admittedTime;
+		lastFrame.stepTime = policy->GetStepTime(GetState(lastFrame.stepTime));
+
+		// Update in fixed steps until the accumulatedTime has been used up
+		const std::int64_t updateStart = costClock ? costClock->GetCounts() : 0;
+		lastFrame.updates = 0;
+		while (accumulatedTime >= lastFrame.stepTime && lastFrame.updates < maxSkipFrames)
+		{
+			util::Expected<int> result = update(lastFrame.stepTime);
+			if (!result.isValid())
+			{
+				return result;
+			}
+			accumulatedTime -= lastFrame.stepTime;
+			lastFrame.updates++;
+		}
+
+		lastFrame.hitMaxSkipFrames = accumulatedTime >= lastFrame.stepTime;
+		SettleDebt(admittedTime, elapsedTime, costClock ? costClock->GetCounts() - updateStart : 0);
+		lastFrame.farseer = accumulatedTime / lastFrame.stepTime;
+		frames++;
+		updates += lastFrame.updates;
+		if (lastFrame.hitMaxSkipFrames)
+		{
+			framesAtMaxSkipFrames++;
+		}
+
+		// Render, but predict the future by accounting for the remaining accumulatedTime
+		return render(lastFrame.farseer);
+	}
+}
@@ -0,0 +1,300 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FramePacer.cpp
+*
+* Limits the game loop to a target frame rate without burning a whole core
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// sleep durations
+#include <cmath>			// std::sqrt
+#include <fstream>			// file streams
+#include <iomanip>			// output formatting
+#include <stdexcept>		// std::invalid_argument
+#include <thread>			// std::this_thread::sleep_for
+
+// Project includes
+#include "FramePacer.h"
+#include "StringConverter.h"
+
+// Platform includes
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <mmsystem.h>		// timeBeginPeriod
+#pragma comment(lib, "winmm.lib")
+#endif
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define FRAME_PACER_HAS_PAUSE
+#include <immintrin.h>		// _mm_pause
+#endif
+
+#pragma endregion
+
+namespace core
+{
+	namespace
+	{
+		const double longestSleep = 0.001;					// the longest sleep slice of the hybrid wait, in seconds
+		const double shortestSleep = 0.0002;				// shorter waits are spun
+		const double initialOvershoot = 0.001;				// the expected overshoot before the first sleep was measured
+		const double overshootWeight = 1.0 / 32.0;			// weight of the latest sleep in the overshoot estimate
+		const std::int64_t highestFrameTime = 10000000;	// ten seconds in microseconds
+
+		std::int64_t ToMicroseconds(std::int64_t counts, double secondsPerCount)
+		{
+			return (std::int64_t)(counts * secondsPerCount * 1e6 + 0.5);
+		}
+
+		// tells a hyper-threaded core that this thread is spinning
+		inline void SpinPause()
+		{
+#ifdef FRAME_PACER_HAS_PAUSE
+			_mm_pause();
+#else
+			std::this_thread::yield();
+#endif
+		}
+	}
+
+	FramePacer::FramePacer(const ClockSource& clock, double targetFrameRate, FrameWaitMode waitMode) :
+		clock(clock),
+		secondsPerCount(clock.GetSecondsPerCount()),
+		targetFrameRate(0.0),
+		frameCounts(0),
+		waitMode(waitMode),
+		deadline(0),
+		lastFrameStart(0),
+		isOnGrid(false),
+		overshootMean(initialOvershoot),
+		overshootVariance(0.0),
+		frameTimes(highestFrameTime),
+		jitter(highestFrameTime),
+		missedFrames(0),
+		waitCounts(0),
+		sleepCounts(0),
+		overshootCounts(0)
+	{
+		SetTargetFrameRate(targetFrameRate);
+
+#ifdef _WIN32
+		// the default scheduler granularity of 15.6 ms is longer than a frame
+		timeBeginPeriod(1);
+#endif
+	}
+
+	FramePacer::~FramePacer()
+	{
+#ifdef _WIN32
+		timeEndPeriod(1);
+#endif
+	}
+
+	void FramePacer::SetTargetFrameRate(double targetFrameRate)
+	{
+		if (targetFrameRate < 0.0)
+		{
+			throw std::invalid_argument("The target frame rate must not be negative!");
+		}
+
+		this->targetFrameRate = targetFrameRate;
+		frameCounts = targetFrameRate > 0.0 ? (std::int64_t)(1.0 / (targetFrameRate * secondsPerCount) + 0.5) : 0;
+		Restart();
+	}
+
+	void FramePacer::WaitForNextFrame()
+	{
+		std::int64_t now = clock.GetCounts();
+		if (!isOnGrid)
+		{
+			// the first frame starts the grid
+			isOnGrid = true;
+			lastFrameStart = now;
+			deadline = now + frameCounts;
+			return;
+		}
+
+		if (frameCounts > 0)
+		{
+			if (now < deadline)
+			{
+				switch (waitMode)
+				{
+				case FrameWaitMode::sleep:
+					SleepUntil(deadline);
+					break;
+				case FrameWaitMode::spin:
+					SpinUntil(deadline);
+					break;
+				default:
+					HybridWaitUntil(deadline);
+					break;
+				}
+
+				std::int64_t wokeUp = clock.GetCounts();
+				waitCounts += wokeUp - now;
+				overshootCounts += wokeUp - deadline;
+				now = wokeUp;
+			}
+			else if (now - deadline > frameCounts)
+			{
+				// too late to catch up: start a new grid
+				missedFrames++;
+				deadline = now;
+			}
+		}
+
+		std::int64_t frameTime = now - lastFrameStart;
+		frameTimes.Record(ToMicroseconds(frameTime, secondsPerCount));
+		if (frameCounts > 0)
+		{
+			std::int64_t error = frameTime - frameCounts;
+			jitter.Record(ToMicroseconds(error < 0 ? -error : error, secondsPerCount));
+		}
+
+		lastFrameStart = now;
+		deadline += frameCounts;
+	}
+
+	void FramePacer::Restart()
+	{
+		isOnGrid = false;
+	}
+
+	void FramePacer::ResetStatistics()
+	{
+		frameTimes.Reset();
+		jitter.Reset();
+		missedFrames = 0;
+		waitCounts = 0;
+		sleepCounts = 0;
+		overshootCounts = 0;
+	}
+
+	double FramePacer::GetSleepOvershoot() const
+	{
+		// a sleep rarely takes longer than the mean plus one standard deviation
+		return overshootMean + std::sqrt(overshootVariance);
+	}
+
+	FramePacingSummary FramePacer::GetSummary() const
+	{
+		FramePacingSummary summary = {};
+		summary.frames = frameTimes.GetTotalCount();
+		summary.targetFrameTime = frameCounts * secondsPerCount * 1000.0;
+		summary.meanFrameTime = frameTimes.GetMean() / 1000.0;
+		summary.p50Jitter = jitter.GetValueAtPercentile(50.0) / 1000.0;
+		summary.p99Jitter = jitter.GetValueAtPercentile(99.0) / 1000.0;
+		summary.maxJitter = jitter.GetMax() / 1000.0;
+		if (summary.frames > 0)
+		{
+			summary.meanWaitTime = waitCounts * secondsPerCount * 1000.0 / summary.frames;
+			summary.meanOvershoot = overshootCounts * secondsPerCount * 1000.0 / summary.frames;
+		}
+		summary.sleepShare = waitCounts > 0 ? (double)sleepCounts / waitCounts : 0.0;
+		summary.missedFrames = missedFrames;
+		return summary;
+	}
+
+	void FramePacer::WriteReport(std::ostream& out) const
+	{
+		FramePacingSummary summary = GetSummary();
+
+		const std::streamsize precision = out.precision();
+		out << std::setprecision(4);
+		out << "Frame pacing: " << GetName(waitMode) << " wait, target " << targetFrameRate << " fps (" << summary.targetFrameTime << " ms)\n";
+		out << "\t" << summary.frames << " frames, mean frame time " << summary.meanFrameTime << " ms, " << summary.missedFrames << " frames missed the grid\n";
+		out << "\tjitter (ms): p50 " << summary.p50Jitter << ", p99 " << summary.p99Jitter << ", max " << summary.maxJitter << "\n";
+		out << "\twait per frame (ms): " << summary.meanWaitTime << " (" << summary.sleepShare * 100.0 << "% sleeping), overshoot " << summary.meanOvershoot << "\n\n";
+		out.precision(precision);
+
+		out << "Jitter distribution (ms)\n";
+		jitter.WritePercentileDistribution(out, 1000.0);
+	}
+
+	bool FramePacer::WriteReport(const std::wstring& filename) const
+	{
+		// only the Microsoft library accepts wide file names
+#ifdef _WIN32
+		std::ofstream out(filename.c_str());
+#else
+		std::ofstream out(util::StringConverter::ws2s(filename).c_str());
+#endif
+		if (!out.is_open())
+		{
+			return false;
+		}
+
+		WriteReport(out);
+		return out.good();
+	}
+
+	const char* FramePacer::GetName(FrameWaitMode waitMode)
+	{
+		switch (waitMode)
+		{
+		case FrameWaitMode::sleep:
+			return "sleep";
+		case FrameWaitMode::spin:
+			return "spin";
+		default:
+			return "hybrid";
+		}
+	}
+
+	void FramePacer::SleepUntil(std::int64_t deadline)
+	{
+		std::int64_t start = clock.GetCounts();
+		if (start < deadline)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double>((deadline - start) * secondsPerCount));
+			sleepCounts += clock.GetCounts() - start;
+		}
+	}
+
+	void FramePacer::SpinUntil(std::int64_t deadline)
+	{
+		while (clock.GetCounts() < deadline)
+		{
+			SpinPause();
+		}
+	}
+
+	void FramePacer::HybridWaitUntil(std::int64_t deadline)
+	{
+		// sleep in slices while even a late wake-up stays before the deadline
+		std::int64_t now = clock.GetCounts();
+		for (;;)
+		{
+			double sleepTime = (deadline - now) * secondsPerCount - GetSleepOvershoot();
+			if (sleepTime < shortestSleep)
+			{
+				break;
+			}
+			sleepTime = sleepTime < longestSleep ? sleepTime : longestSleep;
+
+			std::this_thread::sleep_for(std::chrono::duration<double>(sleepTime));
+			std::int64_t wokeUp = clock.GetCounts();
+			sleepCounts += wokeUp - now;
+			RecordSleepSlice(sleepTime, (wokeUp - now) * secondsPerCount);
+			now = wokeUp;
+		}
+
+		SpinUntil(deadline);
+	}
+
+	void FramePacer::RecordSleepSlice(double requested, double actual)
+	{
+		double overshoot = actual - requested;
+		double difference = overshoot - overshootMean;
+		overshootMean += overshootWeight * difference;
+		overshootVariance = (1.0 - overshootWeight) * (overshootVariance + overshootWeight * difference * difference);
+	}
+}
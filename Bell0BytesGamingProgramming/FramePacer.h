@@ -0,0 +1,122 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FramePacer.h
+*
+* Limits the game loop to a target frame rate without burning a whole core
+*
+* Frames are due on a fixed grid of the target frame time; a frame that finishes early waits for its deadline on the
+* clock of the timer. The hybrid wait sleeps in short slices while the deadline is further away than a sleep is known to
+* overshoot, then spins for the rest: the precision of spinning at a fraction of its CPU time. How long a sleep really
+* takes is learned while the game runs, as the scheduler granularity differs between machines and power states.
+*
+* A frame that is late by less than a frame time shortens the next wait, thus the average frame rate stays on target; a
+* frame that is later than that restarts the grid rather than rushing the following frames.
+*
+* Jitter is the difference between the actual and the target time between two frames, kept in a histogram per session.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstdint>			// fixed width integers
+#include <ostream>			// output streams
+#include <string>			// strings
+
+// Project includes
+#include "ClockSource.h"
+#include "HdrHistogram.h"
+
+#pragma endregion
+
+namespace core
+{
+	enum class FrameWaitMode
+	{
+		sleep,						// one sleep until the deadline: cheapest, as precise as the scheduler
+		spin,						// busy-wait until the deadline: precise, burns a core
+		hybrid						// sleep most of the time, spin the last stretch
+	};
+
+	// Summary of the paced frames since the last reset, times in milliseconds
+	struct FramePacingSummary
+	{
+		unsigned long long frames;
+		double targetFrameTime;
+		double meanFrameTime;				// time between two frames
+		double p50Jitter;					// absolute difference between the actual and the target frame time
+		double p99Jitter;
+		double maxJitter;
+		double meanWaitTime;				// per frame
+		double sleepShare;					// fraction of the waiting time spent sleeping rather than spinning
+		double meanOvershoot;				// how late the waits woke up after their deadline
+		unsigned long long missedFrames;	// frames more than a frame time late; each restarted the grid
+	};
+
+	class FramePacer
+	{
+	public:
+		// A target frame rate of 0 disables the limiter; the frames are still measured
+		FramePacer(const ClockSource& clock, double targetFrameRate = 60.0, FrameWaitMode waitMode = FrameWaitMode::hybrid);
+		~FramePacer();
+
+		FramePacer(const FramePacer&) = delete;
+		FramePacer& operator=(const FramePacer&) = delete;
+
+		void SetTargetFrameRate(double targetFrameRate);
+		void SetWaitMode(FrameWaitMode waitMode) { this->waitMode = waitMode; };
+
+		// Call once per frame: waits until the next frame is due, returns at once if it is overdue
+		void WaitForNextFrame();
+
+		// Starts a new grid at the next frame, i.e. after the game was paused; the statistics are kept
+		void Restart();
+		void ResetStatistics();
+
+		// Getters
+		double GetTargetFrameRate() const { return targetFrameRate; };
+		FrameWaitMode GetWaitMode() const { return waitMode; };
+		double GetSleepOvershoot() const;			// the expected overshoot of a sleep slice, in seconds
+		FramePacingSummary GetSummary() const;
+
+		// Writes the summary and the jitter distribution
+		void WriteReport(std::ostream& out) const;
+		bool WriteReport(const std::wstring& filename) const;
+
+		static const char* GetName(FrameWaitMode waitMode);
+
+	private:
+		void SleepUntil(std::int64_t deadline);
+		void SpinUntil(std::int64_t deadline);
+		void HybridWaitUntil(std::int64_t deadline);
+		void RecordSleepSlice(double requested, double actual);
+
+	private:
+		const ClockSource& clock;					// the clock of the timer
+		const double secondsPerCount;
+		double targetFrameRate;
+		std::int64_t frameCounts;					// the target frame time in counts, 0 if unlimited
+		FrameWaitMode waitMode;
+
+		std::int64_t deadline;						// when the next frame is due
+		std::int64_t lastFrameStart;				// when the previous wait returned
+		bool isOnGrid;								// false until the first frame after a restart
+
+		// the overshoot of a sleep slice: exponentially weighted mean and variance, in seconds
+		double overshootMean;
+		double overshootVariance;
+
+		// statistics
+		util::HdrHistogram frameTimes;				// microseconds
+		util::HdrHistogram jitter;					// microseconds
+		unsigned long long missedFrames;
+		std::int64_t waitCounts;					// total time waited
+		std::int64_t sleepCounts;					// of which sleeping
+		std::int64_t overshootCounts;				// total time the waits woke up late
+	};
+}
@@ -0,0 +1,109 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FrameRingAllocator.cpp
+*
+* Hands out the bytes of one large dynamic buffer to the transient data of every frame, independent of Direct3D
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::max
+#include <stdexcept>		// std::invalid_argument, std::logic_error
+
+// Project includes
+#include "FrameRingAllocator.h"
+
+#pragma endregion
+
+namespace graphics
+{
+	FrameRingAllocator::FrameRingAllocator(std::size_t capacity, unsigned int maxFramesInFlight) :
+		capacity(capacity),
+		head(0),
+		tail(0),
+		failedAllocations(0),
+		frameMarks(maxFramesInFlight),
+		firstMark(0),
+		framesInFlight(0),
+		lastEnd(0),
+		statistics()
+	{
+		if (capacity == 0 || maxFramesInFlight == 0)
+		{
+			throw std::invalid_argument("The frame ring needs bytes and at least one frame in flight!");
+		}
+	}
+
+	RingAllocation FrameRingAllocator::Allocate(std::size_t size, std::size_t alignment)
+	{
+		if (size > capacity)
+		{
+			failedAllocations.fetch_add(1, std::memory_order_relaxed);
+			return { 0, 0, false };
+		}
+
+		std::uint64_t position = head.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			// align the offset, then skip the rest of the ring if the bytes do not fit before its end
+			const std::uint64_t offset = position % capacity;
+			std::uint64_t begin = position + ((alignment - offset % alignment) & (alignment - 1));
+			if (begin % capacity + size > capacity)
+			{
+				begin += capacity - begin % capacity;
+			}
+			const std::uint64_t end = begin + size;
+
+			// the tail only moves up, thus a stale tail fails too early but never hands out bytes in use
+			if (end - tail.load(std::memory_order_acquire) > capacity)
+			{
+				failedAllocations.fetch_add(1, std::memory_order_relaxed);
+				return { 0, 0, false };
+			}
+
+			if (head.compare_exchange_weak(position, end, std::memory_order_relaxed))
+			{
+				return { (std::size_t)(begin % capacity), size, true };
+			}
+		}
+	}
+
+	void FrameRingAllocator::EndFrame(unsigned long long frame)
+	{
+		if (!CanEndFrame())
+		{
+			throw std::logic_error("Too many frames in flight: the GPU must complete a frame first!");
+		}
+
+		const std::uint64_t end = head.load(std::memory_order_relaxed);
+		frameMarks[(firstMark + framesInFlight) % frameMarks.size()] = { frame, end };
+		framesInFlight++;
+
+		statistics.frames++;
+		statistics.peakFrameBytes = (std::max)(statistics.peakFrameBytes, (std::size_t)(end - lastEnd));
+		statistics.peakUsedBytes = (std::max)(statistics.peakUsedBytes, (std::size_t)(end - tail.load(std::memory_order_relaxed)));
+		lastEnd = end;
+	}
+
+	void FrameRingAllocator::Reclaim(unsigned long long completedFrame)
+	{
+		// the bytes of the completed frames go back to the producers
+		while (framesInFlight > 0 && frameMarks[firstMark].frame <= completedFrame)
+		{
+			tail.store(frameMarks[firstMark].end, std::memory_order_release);
+			firstMark = (firstMark + 1) % frameMarks.size();
+			framesInFlight--;
+			statistics.reclaimedFrames++;
+		}
+	}
+
+	std::size_t FrameRingAllocator::GetUsedBytes() const
+	{
+		return (std::size_t)(head.load(std::memory_order_relaxed) - tail.load(std::memory_order_relaxed));
+	}
+}
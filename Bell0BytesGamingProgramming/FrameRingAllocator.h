@@ -0,0 +1,109 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FrameRingAllocator.h
+*
+* Hands out the bytes of one large dynamic buffer to the transient data of every frame, independent of Direct3D
+*
+* The buffer is a ring: allocations are bumped off its head, by any number of threads at once with a single
+* compare-and-swap, and wrap around to its start when they do not fit before its end; an allocation never straddles
+* the end. At the end of a frame, the head is marked with the number of the frame. The GPU reads the bytes of a frame
+* until it completes the frame, thus they are reclaimed only once the caller reports the frame as completed, from a
+* fence or an event query, and the tail moves up to the mark of the newest completed frame. An allocation that would
+* overtake the tail fails: the ring is full until the GPU catches up.
+*
+* The allocator only keeps the books: it returns offsets, the caller maps the buffer once per frame without discarding
+* it and writes at those offsets, from as many threads as it likes. Every allocation of a frame ends before the frame
+* does, and the GPU must have completed a frame before its bytes are handed out again, thus mapping without discarding
+* never overwrites bytes the GPU still reads.
+*
+* Threads: Allocate may be called from any thread; EndFrame and Reclaim from one thread, the one that submits the
+* frames, once every producer of the frame is done.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <atomic>			// atomic objects (no data races)
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <vector>			// vector containers
+
+#pragma endregion
+
+namespace graphics
+{
+	// Bytes of the ring, from offset to offset + size
+	struct RingAllocation
+	{
+		std::size_t offset;
+		std::size_t size;
+		bool isValid;			// false if the ring was full
+	};
+
+	// Counters since the allocator was created
+	struct FrameRingStatistics
+	{
+		unsigned long long frames;				// frames ended
+		unsigned long long reclaimedFrames;		// frames the GPU completed
+		std::size_t peakFrameBytes;				// most bytes used by one frame, padding included
+		std::size_t peakUsedBytes;				// most bytes in use at the end of a frame, all frames in flight included
+	};
+
+	class FrameRingAllocator
+	{
+	public:
+		// maxFramesInFlight frames may be ended but not yet completed
+		FrameRingAllocator(std::size_t capacity, unsigned int maxFramesInFlight = 3);
+		~FrameRingAllocator() {};
+
+		FrameRingAllocator(const FrameRingAllocator&) = delete;
+		FrameRingAllocator& operator=(const FrameRingAllocator&) = delete;
+
+		// Producers: size bytes at an offset that is a multiple of alignment, a power of two
+		RingAllocation Allocate(std::size_t size, std::size_t alignment = 16);
+
+		// Frame thread: the allocations since the last call belong to frame, which must be one more than the last one
+		void EndFrame(unsigned long long frame);
+
+		// Frame thread: the GPU has completed every frame up to completedFrame, their bytes can be handed out again
+		void Reclaim(unsigned long long completedFrame);
+
+		// Getters
+		std::size_t GetCapacity() const { return capacity; };
+		std::size_t GetUsedBytes() const;											// in use by the frames in flight and the current one
+		unsigned int GetFramesInFlight() const { return framesInFlight; };			// ended but not yet completed
+		bool CanEndFrame() const { return framesInFlight < frameMarks.size(); };	// false until the GPU completes a frame
+		const FrameRingStatistics& GetStatistics() const { return statistics; };
+		unsigned long long GetFailedAllocations() const { return failedAllocations.load(std::memory_order_relaxed); };
+
+	private:
+		static constexpr std::size_t cacheLineSize = 64;
+
+		// Where the head was when a frame ended
+		struct FrameMark
+		{
+			unsigned long long frame;
+			std::uint64_t end;
+		};
+
+		const std::size_t capacity;							// bytes in the ring
+
+		// the positions grow forever, the offsets are the positions modulo the capacity
+		alignas(cacheLineSize) std::atomic<std::uint64_t> head;		// the end of the newest allocation
+		alignas(cacheLineSize) std::atomic<std::uint64_t> tail;		// the start of the oldest bytes the GPU may read
+		std::atomic<unsigned long long> failedAllocations;			// allocations that found the ring full
+
+		// frame thread only
+		std::vector<FrameMark> frameMarks;					// the frames in flight, oldest first from firstMark on
+		std::size_t firstMark;								// the mark of the oldest frame in flight
+		unsigned int framesInFlight;						// number of marks in use
+		std::uint64_t lastEnd;								// the mark of the last ended frame
+		FrameRingStatistics statistics;
+	};
+}
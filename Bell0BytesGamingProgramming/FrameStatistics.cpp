@@ -0,0 +1,186 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FrameStatistics.cpp
+*
+* Per-frame timing: a rolling window of the most recent frames and histograms of the whole session
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::sort
+#include <cmath>			// std::ceil
+#include <fstream>			// file streams
+#include <iomanip>			// output formatting
+#include <stdexcept>		// std::invalid_argument
+
+// Project includes
+#include "FrameStatistics.h"
+#include "StringConverter.h"
+
+#pragma endregion
+
+namespace core
+{
+	namespace
+	{
+		const std::int64_t highestFrameTime = 60000000;		// one minute in microseconds, longer frames are counted as one minute
+
+		std::int64_t ToMicroseconds(double seconds)
+		{
+			return (std::int64_t)(seconds * 1e6 + 0.5);
+		}
+
+		// Nearest-rank percentile of sorted samples
+		double GetPercentile(const std::vector<double>& sorted, double percentile)
+		{
+			std::size_t rank = (std::size_t)std::ceil(percentile / 100.0 * sorted.size());
+			return sorted[rank > 0 ? rank - 1 : 0];
+		}
+	}
+
+	FrameStatistics::FrameStatistics(std::size_t windowSize) :
+		window(windowSize),
+		nextFrame(0),
+		recentFrames(0),
+		frameTimes(highestFrameTime),
+		updateTimes(highestFrameTime),
+		renderTimes(highestFrameTime),
+		framesAtMaxSkipFrames(0),
+		sortedFrameTimes()
+	{
+		if (windowSize == 0)
+		{
+			throw std::invalid_argument("The frame statistics need room for at least one frame!");
+		}
+		sortedFrameTimes.reserve(windowSize);
+	}
+
+	void FrameStatistics::Record(const FrameTiming& frame)
+	{
+		window[nextFrame] = frame;
+		nextFrame = (nextFrame + 1) % window.size();
+		if (recentFrames < window.size())
+		{
+			recentFrames++;
+		}
+
+		frameTimes.Record(ToMicroseconds(frame.frameTime));
+		updateTimes.Record(ToMicroseconds(frame.updateTime));
+		renderTimes.Record(ToMicroseconds(frame.renderTime));
+		if (frame.hitMaxSkipFrames)
+		{
+			framesAtMaxSkipFrames++;
+		}
+	}
+
+	void FrameStatistics::Reset()
+	{
+		nextFrame = 0;
+		recentFrames = 0;
+		frameTimes.Reset();
+		updateTimes.Reset();
+		renderTimes.Reset();
+		framesAtMaxSkipFrames = 0;
+	}
+
+	FrameTimeSummary FrameStatistics::GetRecentSummary() const
+	{
+		FrameTimeSummary summary = {};
+		if (recentFrames == 0)
+		{
+			return summary;
+		}
+
+		double totalUpdateTime = 0.0;
+		double totalRenderTime = 0.0;
+		double totalFrameTime = 0.0;
+		sortedFrameTimes.clear();
+		for (std::size_t i = 0; i < recentFrames; i++)
+		{
+			const FrameTiming& frame = window[i];
+			sortedFrameTimes.push_back(frame.frameTime * 1000.0);
+			totalFrameTime += frame.frameTime;
+			totalUpdateTime += frame.updateTime;
+			totalRenderTime += frame.renderTime;
+			if (frame.hitMaxSkipFrames)
+			{
+				summary.framesAtMaxSkipFrames++;
+			}
+		}
+		std::sort(sortedFrameTimes.begin(), sortedFrameTimes.end());
+
+		summary.frames = recentFrames;
+		summary.meanFrameTime = totalFrameTime * 1000.0 / recentFrames;
+		summary.p50FrameTime = GetPercentile(sortedFrameTimes, 50.0);
+		summary.p95FrameTime = GetPercentile(sortedFrameTimes, 95.0);
+		summary.p99FrameTime = GetPercentile(sortedFrameTimes, 99.0);
+		summary.maxFrameTime = sortedFrameTimes.back();
+		summary.meanUpdateTime = totalUpdateTime * 1000.0 / recentFrames;
+		summary.meanRenderTime = totalRenderTime * 1000.0 / recentFrames;
+		summary.updateShare = totalUpdateTime + totalRenderTime > 0.0 ? totalUpdateTime / (totalUpdateTime + totalRenderTime) : 0.0;
+		return summary;
+	}
+
+	FrameTimeSummary FrameStatistics::GetSessionSummary() const
+	{
+		FrameTimeSummary summary = {};
+		summary.frames = frameTimes.GetTotalCount();
+		summary.meanFrameTime = frameTimes.GetMean() / 1000.0;
+		summary.p50FrameTime = frameTimes.GetValueAtPercentile(50.0) / 1000.0;
+		summary.p95FrameTime = frameTimes.GetValueAtPercentile(95.0) / 1000.0;
+		summary.p99FrameTime = frameTimes.GetValueAtPercentile(99.0) / 1000.0;
+		summary.maxFrameTime = frameTimes.GetMax() / 1000.0;
+		summary.meanUpdateTime = updateTimes.GetMean() / 1000.0;
+		summary.meanRenderTime = renderTimes.GetMean() / 1000.0;
+		double busyTime = summary.meanUpdateTime + summary.meanRenderTime;
+		summary.updateShare = busyTime > 0.0 ? summary.meanUpdateTime / busyTime : 0.0;
+		summary.framesAtMaxSkipFrames = framesAtMaxSkipFrames;
+		return summary;
+	}
+
+	void FrameStatistics::WriteReport(std::ostream& out) const
+	{
+		FrameTimeSummary session = GetSessionSummary();
+		FrameTimeSummary recent = GetRecentSummary();
+
+		auto writeSummary = [&out](const char* title, const FrameTimeSummary& summary)
+		{
+			out << title << ": " << summary.frames << " frames, " << summary.framesAtMaxSkipFrames << " hit the maximum number of updates per frame\n";
+			out << "\tframe time (ms): mean " << summary.meanFrameTime << ", p50 " << summary.p50FrameTime << ", p95 " << summary.p95FrameTime << ", p99 " << summary.p99FrameTime << ", max " << summary.maxFrameTime << "\n";
+			out << "\tper frame (ms): update " << summary.meanUpdateTime << ", render " << summary.meanRenderTime << " (" << summary.updateShare * 100.0 << "% updating)\n\n";
+		};
+
+		out << std::setprecision(4);
+		writeSummary("Session", session);
+		writeSummary("Last frames", recent);
+
+		out << "Frame time distribution (ms)\n";
+		frameTimes.WritePercentileDistribution(out, 1000.0);
+		out << "\nUpdate time distribution (ms per frame)\n";
+		updateTimes.WritePercentileDistribution(out, 1000.0);
+		out << "\nRender time distribution (ms per frame)\n";
+		renderTimes.WritePercentileDistribution(out, 1000.0);
+	}
+
+	bool FrameStatistics::WriteReport(const std::wstring& filename) const
+	{
+		// only the Microsoft library accepts wide file names
+#ifdef _WIN32
+		std::ofstream out(filename.c_str());
+#else
+		std::ofstream out(util::StringConverter::ws2s(filename).c_str());
+#endif
+		if (!out.is_open())
+		{
+			return false;
+		}
+
+		WriteReport(out);
+		return out.good();
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FrameStatistics.h
+*
+* Per-frame timing: a rolling window of the most recent frames and histograms of the whole session
+*
+* Every frame records its frame time (the time since the previous frame), the time spent updating and rendering, and
+* whether the update loop hit maxSkipFrames. Percentiles of the rolling window show the current state of the game,
+* i.e. for the FPS display; the histograms keep every hitch of the session and are written to a report at shutdown.
+*
+* Not thread-safe: frames are recorded and queried by the thread running the game loop.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstddef>			// std::size_t
+#include <ostream>			// output streams
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "HdrHistogram.h"
+
+#pragma endregion
+
+namespace core
+{
+	// The timing of a single frame, in seconds
+	struct FrameTiming
+	{
+		double frameTime;					// time since the previous frame
+		double updateTime;					// time spent in the updates of this frame
+		double renderTime;					// time spent rendering this frame
+		int updates;						// number of updates run
+		bool hitMaxSkipFrames;				// true if the update loop stopped at maxSkipFrames
+	};
+
+	// Summary of a set of frames, times in milliseconds
+	struct FrameTimeSummary
+	{
+		unsigned long long frames;
+		double meanFrameTime;
+		double p50FrameTime;
+		double p95FrameTime;
+		double p99FrameTime;
+		double maxFrameTime;
+		double meanUpdateTime;				// per frame
+		double meanRenderTime;				// per frame
+		double updateShare;					// fraction of the update and render time spent updating
+		unsigned long long framesAtMaxSkipFrames;
+	};
+
+	class FrameStatistics
+	{
+	public:
+		explicit FrameStatistics(std::size_t windowSize = 1024);
+
+		void Record(const FrameTiming& frame);
+		void Reset();
+
+		// Getters
+		FrameTimeSummary GetRecentSummary() const;		// the last windowSize frames
+		FrameTimeSummary GetSessionSummary() const;		// every frame since the last reset, percentiles within 1%
+		const FrameTiming* GetLastFrame() const { return recentFrames == 0 ? nullptr : &window[(nextFrame + window.size() - 1) % window.size()]; };
+
+		// Writes the session summary and the distributions of the frame, update and render times
+		void WriteReport(std::ostream& out) const;
+		bool WriteReport(const std::wstring& filename) const;
+
+	private:
+		std::vector<FrameTiming> window;				// ring buffer of the most recent frames
+		std::size_t nextFrame;							// the slot of the next frame
+		std::size_t recentFrames;						// number of used slots
+
+		util::HdrHistogram frameTimes;					// microseconds
+		util::HdrHistogram updateTimes;
+		util::HdrHistogram renderTimes;
+		unsigned long long framesAtMaxSkipFrames;
+
+		mutable std::vector<double> sortedFrameTimes;	// scratch space for the percentiles of the window
+	};
+}
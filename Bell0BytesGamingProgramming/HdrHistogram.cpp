@@ -0,0 +1,225 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* HdrHistogram.cpp
+*
+* High dynamic range histogram of integer values, i.e. frame times in microseconds
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::fill
+#include <cmath>			// std::ceil, std::pow, std::sqrt
+#include <iomanip>			// output formatting
+#include <stdexcept>		// std::invalid_argument
+
+// Project includes
+#include "HdrHistogram.h"
+
+#pragma endregion
+
+namespace util
+{
+	namespace
+	{
+		int FloorLog2(std::uint64_t value)
+		{
+			int log = 0;
+			while (value >>= 1)
+			{
+				log++;
+			}
+			return log;
+		}
+	}
+
+	HdrHistogram::HdrHistogram(std::int64_t highestTrackableValue, int subBucketBits) :
+		subBucketBits(subBucketBits),
+		subBucketCount((std::int64_t)1 << subBucketBits),
+		subBucketHalfCount((std::int64_t)1 << (subBucketBits - 1)),
+		highestTrackableValue(highestTrackableValue),
+		counts(),
+		totalCount(0),
+		minValue(0),
+		maxValue(0),
+		sum(0.0)
+	{
+		if (subBucketBits < 1 || subBucketBits > 20 || highestTrackableValue < 1)
+		{
+			throw std::invalid_argument("Invalid histogram range or precision!");
+		}
+		counts.resize(GetIndex(highestTrackableValue) + 1, 0);
+	}
+
+	void HdrHistogram::Record(std::int64_t value)
+	{
+		if (value < 0)
+		{
+			value = 0;
+		}
+		else if (value > highestTrackableValue)
+		{
+			value = highestTrackableValue;
+		}
+
+		counts[GetIndex(value)]++;
+		if (totalCount == 0 || value < minValue)
+		{
+			minValue = value;
+		}
+		if (value > maxValue)
+		{
+			maxValue = value;
+		}
+		totalCount++;
+		sum += (double)value;
+	}
+
+	void HdrHistogram::Reset()
+	{
+		std::fill(counts.begin(), counts.end(), 0);
+		totalCount = 0;
+		minValue = 0;
+		maxValue = 0;
+		sum = 0.0;
+	}
+
+	std::int64_t HdrHistogram::GetValueAtPercentile(double percentile) const
+	{
+		if (totalCount == 0)
+		{
+			return 0;
+		}
+		if (percentile >= 100.0)
+		{
+			return maxValue;
+		}
+
+		std::uint64_t cumulativeCount;
+		std::int64_t value = GetHighestEquivalentValue(GetIndexAtPercentile(percentile, cumulativeCount));
+		return value < maxValue ? value : maxValue;
+	}
+
+	void HdrHistogram::WritePercentileDistribution(std::ostream& out, double valueScale) const
+	{
+		const int ticksPerHalfDistance = 5;
+		const std::ios_base::fmtflags flags = out.flags();
+		const std::streamsize precision = out.precision();
+
+		out << std::fixed;
+		out << std::setw(12) << "Value" << " " << std::setw(14) << "Percentile" << " " << std::setw(10) << "TotalCount" << " " << std::setw(14) << "1/(1-Percentile)" << "\n\n";
+
+		if (totalCount > 0)
+		{
+			// 0%, 10%, ..., 50%, 55%, ..., 75%, 77.5%, ...: every halving of the remaining distance gets the same number of lines
+			double lastValue = -1.0;
+			for (int half = 0; half < 64; half++)
+			{
+				double remaining = 100.0 / std::pow(2.0, half);
+				for (int tick = 0; tick < ticksPerHalfDistance; tick++)
+				{
+					double percentile = 100.0 - remaining + remaining / 2.0 * tick / ticksPerHalfDistance;
+					std::uint64_t cumulativeCount;
+					std::size_t index = GetIndexAtPercentile(percentile, cumulativeCount);
+					if (cumulativeCount >= totalCount)
+					{
+						half = 64;
+						break;
+					}
+
+					std::int64_t value = GetHighestEquivalentValue(index);
+					double scaledValue = (value < maxValue ? value : maxValue) / valueScale;
+					if (scaledValue == lastValue && tick > 0)
+					{
+						continue;
+					}
+					lastValue = scaledValue;
+
+					out << std::setw(12) << std::setprecision(3) << scaledValue << " " << std::setw(14) << std::setprecision(12) << percentile / 100.0 << " " << std::setw(10) << cumulativeCount << " " << std::setw(14) << std::setprecision(2) << 1.0 / (1.0 - percentile / 100.0) << "\n";
+				}
+			}
+
+			// the last line is the maximum
+			out << std::setw(12) << std::setprecision(3) << maxValue / valueScale << " " << std::setw(14) << std::setprecision(12) << 1.0 << " " << std::setw(10) << totalCount << "\n";
+		}
+
+		double mean = GetMean();
+		double variance = 0.0;
+		for (std::size_t i = 0; i < counts.size(); i++)
+		{
+			if (counts[i] > 0)
+			{
+				double deviation = (GetLowestEquivalentValue(i) + GetHighestEquivalentValue(i)) / 2.0 - mean;
+				variance += deviation * deviation * counts[i];
+			}
+		}
+		double standardDeviation = totalCount > 0 ? std::sqrt(variance / totalCount) : 0.0;
+
+		out << std::setprecision(3);
+		out << "#[Mean    = " << std::setw(12) << mean / valueScale << ", StdDeviation   = " << std::setw(12) << standardDeviation / valueScale << "]\n";
+		out << "#[Max     = " << std::setw(12) << maxValue / valueScale << ", Total count    = " << std::setw(12) << totalCount << "]\n";
+		out << "#[Buckets = " << std::setw(12) << counts.size() << ", SubBuckets     = " << std::setw(12) << subBucketCount << "]\n";
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+	std::size_t HdrHistogram::GetIndex(std::int64_t value) const
+	{
+		if (value < subBucketCount)
+		{
+			return (std::size_t)value;
+		}
+
+		// the power of two the value falls into decides the width of its bucket
+		int shift = FloorLog2((std::uint64_t)value) - (subBucketBits - 1);
+		return (std::size_t)(subBucketCount + (shift - 1) * subBucketHalfCount + ((value >> shift) - subBucketHalfCount));
+	}
+
+	std::int64_t HdrHistogram::GetLowestEquivalentValue(std::size_t index) const
+	{
+		if ((std::int64_t)index < subBucketCount)
+		{
+			return (std::int64_t)index;
+		}
+
+		std::int64_t offset = (std::int64_t)index - subBucketCount;
+		int shift = (int)(offset / subBucketHalfCount) + 1;
+		return (offset % subBucketHalfCount + subBucketHalfCount) << shift;
+	}
+
+	std::int64_t HdrHistogram::GetHighestEquivalentValue(std::size_t index) const
+	{
+		if ((std::int64_t)index < subBucketCount)
+		{
+			return (std::int64_t)index;
+		}
+
+		int shift = (int)(((std::int64_t)index - subBucketCount) / subBucketHalfCount) + 1;
+		return GetLowestEquivalentValue(index) + ((std::int64_t)1 << shift) - 1;
+	}
+
+	std::size_t HdrHistogram::GetIndexAtPercentile(double percentile, std::uint64_t& cumulativeCount) const
+	{
+		// the smallest bucket such that at least percentile% of all values are less than or equal to it
+		std::uint64_t target = (std::uint64_t)std::ceil(percentile / 100.0 * totalCount);
+		if (target < 1)
+		{
+			target = 1;
+		}
+
+		cumulativeCount = 0;
+		for (std::size_t i = 0; i < counts.size(); i++)
+		{
+			cumulativeCount += counts[i];
+			if (cumulativeCount >= target)
+			{
+				return i;
+			}
+		}
+		return counts.size() - 1;
+	}
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* HdrHistogram.h
+*
+* High dynamic range histogram of integer values, i.e. frame times in microseconds
+*
+* Based on Gil Tene's HdrHistogram
+* - http://hdrhistogram.org/
+*
+* Values below 2^subBucketBits are counted exactly; above, every power of two is split into 2^(subBucketBits - 1) buckets
+* of equal width, thus the relative error of a recorded value is at most 2^(1 - subBucketBits) over the whole range.
+* Recording is a couple of shifts and an increment, and the memory does not grow with the number of values.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <ostream>			// output streams
+#include <vector>			// vector containers
+
+#pragma endregion
+
+namespace util
+{
+	class HdrHistogram
+	{
+	public:
+		// Values above the highest trackable value are counted as the highest trackable value
+		HdrHistogram(std::int64_t highestTrackableValue, int subBucketBits = 8);
+
+		void Record(std::int64_t value);		// negative values are counted as 0
+		void Reset();
+
+		// Getters
+		std::uint64_t GetTotalCount() const { return totalCount; };
+		std::int64_t GetMin() const { return totalCount > 0 ? minValue : 0; };		// exact
+		std::int64_t GetMax() const { return maxValue; };							// exact
+		double GetMean() const { return totalCount > 0 ? sum / totalCount : 0.0; };	// exact
+		std::int64_t GetValueAtPercentile(double percentile) const;					// percentile in [0, 100], within the precision of the buckets
+
+		// Writes the percentile distribution in the text format of the HdrHistogram tools (.hgrm); values are divided by the scale
+		void WritePercentileDistribution(std::ostream& out, double valueScale) const;
+
+	private:
+		std::size_t GetIndex(std::int64_t value) const;
+		std::int64_t GetLowestEquivalentValue(std::size_t index) const;
+		std::int64_t GetHighestEquivalentValue(std::size_t index) const;
+		std::size_t GetIndexAtPercentile(double percentile, std::uint64_t& cumulativeCount) const;
+
+	private:
+		const int subBucketBits;					// precision: the number of bits of a value that are kept
+		const std::int64_t subBucketCount;			// 2^subBucketBits
+		const std::int64_t subBucketHalfCount;		// number of buckets per power of two above subBucketCount
+		const std::int64_t highestTrackableValue;
+
+		std::vector<std::uint64_t> counts;			// the buckets
+		std::uint64_t totalCount;					// number of recorded values
+		std::int64_t minValue;
+		std::int64_t maxValue;
+		double sum;									// sum of all recorded values
+	};
+}
@@ -0,0 +1,83 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* HeadlessRunner.cpp
+*
+* Runs the fixed time step game loop on virtual time: no window, no message pump and no waiting for the real clock
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// Project includes
+#include "ServiceLocator.h"
+#include "HeadlessRunner.h"
+
+#pragma endregion
+
+namespace core
+{
+	HeadlessRunner::HeadlessRunner(double dt, int maxSkipFrames, double frameTime) :
+		clock(new VirtualClock()),
+		timer(std::unique_ptr<ClockSource>(clock)),
+		loop(dt, maxSkipFrames),
+		frameCounts(),
+		updateCounts(0),
+		wallStart(),
+		statistics()
+	{
+		SetFrameTimes({ frameTime });
+		loop.SetCostClock(clock);
+	}
+
+	void HeadlessRunner::SetFrameTimes(const std::vector<double>& frameTimes)
+	{
+		std::vector<std::int64_t> counts;
+		for (double frameTime : frameTimes)
+		{
+			std::int64_t count = VirtualClock::ToCounts(frameTime);
+			if (count <= 0)
+			{
+				throw std::invalid_argument("The frame times of a headless run must be positive!");
+			}
+			counts.push_back(count);
+		}
+
+		if (counts.empty())
+		{
+			throw std::invalid_argument("A headless run needs at least one frame time!");
+		}
+		frameCounts = std::move(counts);
+	}
+
+	void HeadlessRunner::SetUpdateCost(double updateCost)
+	{
+		if (updateCost < 0.0)
+		{
+			throw std::invalid_argument("The cost of an update must not be negative!");
+		}
+		updateCounts = VirtualClock::ToCounts(updateCost);
+	}
+
+	void HeadlessRunner::BeginRun()
+	{
+		timer.Reset();
+		loop.Reset();
+		statistics = HeadlessRunStatistics();
+		wallStart = std::chrono::steady_clock::now();
+	}
+
+	void HeadlessRunner::EndRun()
+	{
+		statistics.simulatedSeconds = timer.GetTotalTime();
+		statistics.wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - wallStart).count();
+		statistics.frames = loop.GetFrameCount();
+		statistics.updates = loop.GetUpdateCount();
+		statistics.framesAtMaxSkipFrames = loop.GetMaxSkipFramesCount();
+
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The headless run simulated {simulated} seconds in {wall} seconds: {frames} frames, {updates} updates, {skipped} frames hit the maximum number of updates.", statistics.simulatedSeconds, statistics.wallSeconds, statistics.frames, statistics.updates, statistics.framesAtMaxSkipFrames);
+		loop.LogTelemetry();
+	}
+}
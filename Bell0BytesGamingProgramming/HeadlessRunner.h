@@ -0,0 +1,113 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* HeadlessRunner.h
+*
+* Runs the fixed time step game loop on virtual time: no window, no message pump and no waiting for the real clock
+*
+* Every frame advances a VirtualClock by the next frame time of a repeating pattern (by default a steady 60 Hz), thus
+* the game updates and renders as fast as the CPU allows, and two runs with the same settings take exactly the same
+* number of steps. Used for soak tests and performance runs.
+*
+* An update can be given a cost in virtual time, thus the catch-up policies can be tested against updates that can not
+* keep up, deterministically.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// wall time of a run
+#include <cstdint>			// fixed width integers
+#include <vector>			// vector containers
+
+// Project includes
+#include "ClockSource.h"
+#include "Expected.h"
+#include "FixedStepLoop.h"
+#include "Timer.h"
+
+#pragma endregion
+
+namespace core
+{
+	// Summary of the last headless run
+	struct HeadlessRunStatistics
+	{
+		double simulatedSeconds;					// virtual time that passed
+		double wallSeconds;							// real time the run took
+		unsigned long long frames;					// number of frames rendered
+		unsigned long long updates;					// number of updates run
+		unsigned long long framesAtMaxSkipFrames;	// number of frames that hit maxSkipFrames
+	};
+
+	class HeadlessRunner
+	{
+	public:
+		HeadlessRunner(double dt, int maxSkipFrames, double frameTime = 1.0 / 60.0);
+
+		// The virtual time between two frames, repeated in order, i.e. { 1/60.0, 1/60.0, 0.25 } to simulate regular hitches
+		void SetFrameTimes(const std::vector<double>& frameTimes);
+
+		// The virtual time every update takes; the loop measures it as the cost of the updates
+		void SetUpdateCost(double updateCost);
+		void SetCatchUpPolicy(std::unique_ptr<CatchUpPolicy> policy) { loop.SetPolicy(std::move(policy)); };
+
+		// Runs the loop until at least simulatedSeconds of virtual time have passed, or until the updater or renderer fails
+		template<typename Updater, typename Renderer>
+		util::Expected<int> Run(double simulatedSeconds, Updater&& update, Renderer&& render);
+
+		// Getters
+		const HeadlessRunStatistics& GetStatistics() const { return statistics; };
+		const FixedStepLoop& GetLoop() const { return loop; };
+		double GetFrameTime() const { return timer.GetDeltaTime(); };		// the virtual time of the current frame
+		VirtualClock& GetClock() { return *clock; };
+
+	private:
+		void BeginRun();
+		void EndRun();
+
+	private:
+		VirtualClock* clock;					// the virtual clock, owned by the timer
+		Timer timer;							// reads the virtual clock
+		FixedStepLoop loop;						// the fixed time step
+
+		std::vector<std::int64_t> frameCounts;	// the frame time pattern, in counts of the virtual clock
+		std::int64_t updateCounts;				// the cost of an update, in counts of the virtual clock
+		std::chrono::steady_clock::time_point wallStart;
+		HeadlessRunStatistics statistics;
+	};
+
+	template<typename Updater, typename Renderer>
+	util::Expected<int> HeadlessRunner::Run(double simulatedSeconds, Updater&& update, Renderer&& render)
+	{
+		BeginRun();
+
+		const std::int64_t end = clock->GetCounts() + VirtualClock::ToCounts(simulatedSeconds);
+		std::size_t nextFrame = 0;
+		while (clock->GetCounts() < end)
+		{
+			clock->AdvanceCounts(frameCounts[nextFrame]);
+			nextFrame = nextFrame + 1 < frameCounts.size() ? nextFrame + 1 : 0;
+
+			timer.Tick();
+			util::Expected<int> result = loop.RunFrame(timer.GetDeltaTime(), [this, &update](double stepTime)
+			{
+				clock->AdvanceCounts(updateCounts);
+				return update(stepTime);
+			}, render);
+			if (!result.isValid())
+			{
+				EndRun();
+				return result;
+			}
+		}
+
+		EndRun();
+		return 0;
+	}
+}
@@ -0,0 +1,325 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* JobSystem.cpp
+*
+* Work-stealing job scheduler for the parallel work of the engine
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstdint>			// fixed width integers
+#include <stdexcept>		// std::runtime_error
+#include <system_error>		// std::system_error
+
+// Project includes
+#include "JobSystem.h"
+
+#pragma endregion
+
+namespace util
+{
+	namespace
+	{
+		const unsigned int maxOtherThreads = 8;		// threads besides the workers that may use a job system
+		const unsigned int idleRounds = 64;			// rounds without work before a worker goes to sleep
+
+		std::atomic<unsigned long long> nextJobSystemId(1);
+
+		// The slot of the calling thread in the job system it last used
+		struct ThreadRegistration
+		{
+			unsigned long long jobSystemId;
+			unsigned int index;
+		};
+		thread_local ThreadRegistration registration = { 0, 0 };
+	}
+
+	// Owned by one thread, stolen from by all
+	struct JobSystem::ThreadState
+	{
+		explicit ThreadState(unsigned int index) : queue(jobsPerThread), jobs(new Job[jobsPerThread]), allocatedJobs(0), random(2463534242u + index), executedJobs(0), stolenJobs(0), failedSteals(0), inlineJobs(0), sleeps(0) {};
+
+		// the counters are only written by the owner
+		void Count(std::atomic<unsigned long long>& counter) { counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); };
+
+		WorkStealingQueue<Job*> queue;
+		std::unique_ptr<Job[]> jobs;				// the ring of jobs of the thread
+		unsigned long long allocatedJobs;			// jobs ever allocated from the ring
+		std::uint32_t random;						// xorshift state to pick the first victim
+
+		std::atomic<unsigned long long> executedJobs;
+		std::atomic<unsigned long long> stolenJobs;
+		std::atomic<unsigned long long> failedSteals;
+		std::atomic<unsigned long long> inlineJobs;
+		std::atomic<unsigned long long> sleeps;
+	};
+
+	JobSystem::JobSystem(unsigned int workerCount, WorkerStartFunction onWorkerStart) :
+		id(nextJobSystemId.fetch_add(1, std::memory_order_relaxed)),
+		workerCount(workerCount),
+		maxThreads(workerCount + maxOtherThreads),
+		onWorkerStart(onWorkerStart),
+		threads(new std::atomic<ThreadState*>[workerCount + maxOtherThreads]),
+		threadCount(workerCount),
+		isRunning(true),
+		sleepingWorkers(0),
+		wakeEpoch(0)
+	{
+		for (unsigned int i = 0; i < maxThreads; i++)
+		{
+			threads[i].store(nullptr, std::memory_order_relaxed);
+		}
+
+		// the states of the workers exist before any of them runs
+		for (unsigned int i = 0; i < workerCount; i++)
+		{
+			ownedStates.emplace_back(new ThreadState(i));
+			threads[i].store(ownedStates.back().get(), std::memory_order_release);
+		}
+
+		try
+		{
+			for (unsigned int i = 0; i < workerCount; i++)
+			{
+				workers.emplace_back(&JobSystem::WorkerMain, this, i);
+			}
+		}
+		catch (const std::system_error&)
+		{
+			StopWorkers();
+			throw std::runtime_error("Unable to start the worker threads of the job system!");
+		}
+	}
+
+	JobSystem::~JobSystem()
+	{
+		StopWorkers();
+	}
+
+	void JobSystem::StopWorkers()
+	{
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			isRunning.store(false, std::memory_order_release);
+			wakeEpoch++;
+		}
+		wakeCondition.notify_all();
+
+		for (std::thread& worker : workers)
+		{
+			worker.join();
+		}
+	}
+
+	void JobSystem::Run(Job* job)
+	{
+		ThreadState& state = GetThreadState();
+		if (!state.queue.Push(job))
+		{
+			state.Count(state.inlineJobs);
+			Execute(job, state);
+			return;
+		}
+
+		// pairs with the fence of a worker going to sleep: either the worker sees the job, or the job sees the worker
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (sleepingWorkers.load(std::memory_order_relaxed) > 0)
+		{
+			{
+				std::lock_guard<std::mutex> lock(wakeMutex);
+				wakeEpoch++;
+			}
+			wakeCondition.notify_one();
+		}
+	}
+
+	void JobSystem::Wait(const Job* job)
+	{
+		// help rather than block
+		ThreadState& state = GetThreadState();
+		while (!IsFinished(job))
+		{
+			Job* next = GetJob(state);
+			if (next)
+			{
+				Execute(next, state);
+			}
+			else
+			{
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	JobSystemStatistics JobSystem::GetStatistics() const
+	{
+		JobSystemStatistics statistics = {};
+		const unsigned int count = threadCount.load(std::memory_order_acquire);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const ThreadState* state = threads[i].load(std::memory_order_acquire);
+			if (state)
+			{
+				statistics.executedJobs += state->executedJobs.load(std::memory_order_relaxed);
+				statistics.stolenJobs += state->stolenJobs.load(std::memory_order_relaxed);
+				statistics.failedSteals += state->failedSteals.load(std::memory_order_relaxed);
+				statistics.inlineJobs += state->inlineJobs.load(std::memory_order_relaxed);
+				statistics.sleeps += state->sleeps.load(std::memory_order_relaxed);
+			}
+		}
+		return statistics;
+	}
+
+	unsigned int JobSystem::GetDefaultWorkerCount()
+	{
+		const unsigned int hardwareThreads = std::thread::hardware_concurrency();
+		return hardwareThreads > 1 ? hardwareThreads - 1 : 0;
+	}
+
+	JobSystem::ThreadState& JobSystem::GetThreadState()
+	{
+		if (registration.jobSystemId == id)
+		{
+			return *threads[registration.index].load(std::memory_order_relaxed);
+		}
+
+		// the first call of a thread that is not a worker
+		std::lock_guard<std::mutex> lock(registrationMutex);
+		const unsigned int index = threadCount.load(std::memory_order_relaxed);
+		if (index >= maxThreads)
+		{
+			throw std::runtime_error("Too many threads use the job system!");
+		}
+
+		ownedStates.emplace_back(new ThreadState(index));
+		threads[index].store(ownedStates.back().get(), std::memory_order_release);
+		threadCount.store(index + 1, std::memory_order_release);
+		registration = { id, index };
+		return *ownedStates.back();
+	}
+
+	Job* JobSystem::AllocateJob()
+	{
+		ThreadState& state = GetThreadState();
+		Job* job = &state.jobs[state.allocatedJobs++ & (jobsPerThread - 1)];
+		if (job->unfinishedJobs.load(std::memory_order_acquire) != 0)
+		{
+			throw std::runtime_error("Too many unfinished jobs on this thread!");
+		}
+		return job;
+	}
+
+	Job* JobSystem::GetJob(ThreadState& state)
+	{
+		Job* job = nullptr;
+		if (state.queue.Pop(job))
+		{
+			return job;
+		}
+
+		// start at a random victim, thus the thieves spread out
+		const unsigned int count = threadCount.load(std::memory_order_acquire);
+		state.random ^= state.random << 13;
+		state.random ^= state.random >> 17;
+		state.random ^= state.random << 5;
+		const unsigned int first = state.random % count;
+		for (unsigned int i = 0; i < count; i++)
+		{
+			ThreadState* victim = threads[(first + i) % count].load(std::memory_order_acquire);
+			if (victim && victim != &state && victim->queue.Steal(job))
+			{
+				state.Count(state.stolenJobs);
+				return job;
+			}
+		}
+
+		state.Count(state.failedSteals);
+		return nullptr;
+	}
+
+	void JobSystem::Execute(Job* job, ThreadState& state)
+	{
+		job->function(*job);
+		state.Count(state.executedJobs);
+		Finish(job);
+	}
+
+	void JobSystem::Finish(Job* job)
+	{
+		// once the count is zero, the job may be recycled: read the parent first
+		Job* parent = job->parent;
+		if (job->unfinishedJobs.fetch_sub(1, std::memory_order_acq_rel) == 1 && parent)
+		{
+			Finish(parent);
+		}
+	}
+
+	void JobSystem::WorkerMain(unsigned int index)
+	{
+		registration = { id, index };
+		ThreadState& state = *threads[index].load(std::memory_order_acquire);
+		if (onWorkerStart)
+		{
+			onWorkerStart(index);
+		}
+
+		unsigned int rounds = 0;
+		while (isRunning.load(std::memory_order_acquire))
+		{
+			Job* job = GetJob(state);
+			if (job)
+			{
+				Execute(job, state);
+				rounds = 0;
+			}
+			else if (++rounds < idleRounds)
+			{
+				std::this_thread::yield();
+			}
+			else
+			{
+				SleepUntilWoken(state);
+				rounds = 0;
+			}
+		}
+	}
+
+	void JobSystem::SleepUntilWoken(ThreadState& state)
+	{
+		unsigned long long epoch;
+		{
+			std::lock_guard<std::mutex> lock(wakeMutex);
+			epoch = wakeEpoch;
+		}
+
+		// pairs with the fence in Run: a job added from now on either is seen here, or wakes this worker up
+		sleepingWorkers.fetch_add(1, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		if (!HasWork())
+		{
+			state.Count(state.sleeps);
+			std::unique_lock<std::mutex> lock(wakeMutex);
+			wakeCondition.wait(lock, [this, epoch] { return wakeEpoch != epoch || !isRunning.load(std::memory_order_acquire); });
+		}
+		sleepingWorkers.fetch_sub(1, std::memory_order_relaxed);
+	}
+
+	bool JobSystem::HasWork() const
+	{
+		const unsigned int count = threadCount.load(std::memory_order_acquire);
+		for (unsigned int i = 0; i < count; i++)
+		{
+			const ThreadState* state = threads[i].load(std::memory_order_acquire);
+			if (state && !state->queue.IsEmpty())
+			{
+				return true;
+			}
+		}
+		return false;
+	}
+}
@@ -0,0 +1,214 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* JobSystem.h
+*
+* Work-stealing job scheduler for the parallel work of the engine
+*
+* Based on the job system of Stefan Reinalter
+* - https://blog.molecular-matters.com/2015/08/24/job-system-2-0-lock-free-work-stealing-part-1-basics/
+*
+* Every thread that uses the job system has its own work-stealing deque and its own ring of preallocated jobs: a thread
+* runs the jobs it created itself, newest first, and steals the oldest jobs of the other threads once it runs out. The
+* workers sleep when there is nothing to steal and are woken up when a job is added.
+*
+* A job counts itself and its unfinished children; it is finished once the count drops to zero, thus waiting on a
+* parent waits for the whole tree. A thread that waits does not block: it runs other jobs until the one it waits for is
+* finished, thus the main thread helps the workers rather than idling.
+*
+* Jobs store their function in place and are recycled, never deleted: a thread must not have more than jobsPerThread
+* unfinished jobs, and a job must be waited for before the thread that created it has created jobsPerThread more.
+* Functions capture pointers to larger data.
+*
+* Threads other than the workers, i.e. the main thread and the simulation thread, register on their first call.
+*
+* Jobs run on any thread, thus they must not draw from generators with hidden per-thread state: the Microsoft C runtime
+* seeds rand() to 1 on every thread, thus all the workers would draw the same numbers. Parallel random numbers come from a
+* counter-based generator of Random.h that jumps to the first index of the range of the job, as SpawnStarfield does with
+* Philox4x32: the numbers then depend on the indices only, not on the thread or on how the range was split.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <atomic>				// atomic objects (no data races)
+#include <condition_variable>	// sleeping workers
+#include <cstddef>				// std::size_t
+#include <functional>			// std::function
+#include <memory>				// std::unique_ptr
+#include <mutex>				// mutexes
+#include <new>					// placement new
+#include <thread>				// the worker threads
+#include <type_traits>			// std::decay
+#include <utility>				// std::forward
+#include <vector>				// vector containers
+
+#include "WorkStealingQueue.h"
+
+#pragma endregion
+
+namespace util
+{
+	// A unit of work, two cache lines
+	struct Job
+	{
+		Job() : function(nullptr), parent(nullptr), unfinishedJobs(0) {};
+
+		void(*function)(Job&);				// runs and destroys the function stored in data
+		Job* parent;						// notified once this job and its children are finished, may be null
+		std::atomic<int> unfinishedJobs;	// this job and its unfinished children
+		alignas(16) unsigned char data[96];	// the function of the job
+	};
+
+	// Counters of all threads since the job system was created
+	struct JobSystemStatistics
+	{
+		unsigned long long executedJobs;	// jobs run
+		unsigned long long stolenJobs;		// jobs taken from the deque of another thread
+		unsigned long long failedSteals;	// rounds over all deques that found nothing to steal
+		unsigned long long inlineJobs;		// jobs run right away because the deque of their thread was full
+		unsigned long long sleeps;			// times a worker went to sleep
+	};
+
+	class JobSystem
+	{
+	public:
+		typedef std::function<void(unsigned int)> WorkerStartFunction;		// called on every worker as it starts, with its number
+
+		static constexpr std::size_t jobsPerThread = 4096;
+
+		// Starts the worker threads; by default, one per hardware thread besides the calling one
+		explicit JobSystem(unsigned int workerCount = GetDefaultWorkerCount(), WorkerStartFunction onWorkerStart = nullptr);
+		~JobSystem();						// stops the workers, jobs that did not run yet are dropped
+
+		JobSystem(const JobSystem&) = delete;
+		JobSystem& operator=(const JobSystem&) = delete;
+
+		// Creates a job that runs function(); it only runs once it is handed to Run
+		template<typename Function>
+		Job* CreateJob(Function&& function) { return CreateChildJob(nullptr, std::forward<Function>(function)); };
+
+		// Creates a job that must be finished before its parent is
+		template<typename Function>
+		Job* CreateChildJob(Job* parent, Function&& function);
+
+		void Run(Job* job);					// adds the job to the deque of the calling thread
+		void Wait(const Job* job);			// runs other jobs until the job and its children are finished
+		bool IsFinished(const Job* job) const { return job->unfinishedJobs.load(std::memory_order_acquire) == 0; };
+
+		// Calls function(first, last) for subranges of [begin, end) of at most grainSize indices, on all threads;
+		// returns once the whole range is done, the calling thread helps
+		// note: the subranges and their threads vary from call to call, the function must only depend on its indices
+		template<typename Function>
+		void ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const Function& function);
+
+		// Getters
+		unsigned int GetWorkerCount() const { return workerCount; };
+		JobSystemStatistics GetStatistics() const;		// approximate while jobs run
+
+		static unsigned int GetDefaultWorkerCount();
+
+	private:
+		struct ThreadState;
+
+		// Splits its range in halves, hands the upper halves to the other threads and runs the rest itself
+		template<typename Function>
+		struct ParallelForRange
+		{
+			void operator()() const;
+
+			JobSystem* system;
+			Job* root;						// the job ParallelFor waits for
+			std::size_t begin;
+			std::size_t end;
+			std::size_t grainSize;
+			const Function* function;
+		};
+
+		ThreadState& GetThreadState();		// registers the calling thread on its first call
+		Job* AllocateJob();
+		Job* GetJob(ThreadState& state);	// pops a job of the calling thread, or steals one
+		void Execute(Job* job, ThreadState& state);
+		void Finish(Job* job);
+		void WorkerMain(unsigned int index);
+		void StopWorkers();
+		void SleepUntilWoken(ThreadState& state);
+		bool HasWork() const;
+
+	private:
+		const unsigned long long id;			// tells the thread registrations of different job systems apart
+		const unsigned int workerCount;
+		const unsigned int maxThreads;			// workers and other threads
+		WorkerStartFunction onWorkerStart;
+
+		std::unique_ptr<std::atomic<ThreadState*>[]> threads;	// the states of the workers, then of the registered threads
+		std::vector<std::unique_ptr<ThreadState>> ownedStates;
+		std::atomic<unsigned int> threadCount;	// number of slots of threads in use
+		std::mutex registrationMutex;			// only locked when a thread registers
+
+		std::vector<std::thread> workers;
+		std::atomic<bool> isRunning;
+		std::atomic<unsigned int> sleepingWorkers;
+		std::mutex wakeMutex;					// only locked to sleep and to wake sleeping workers
+		std::condition_variable wakeCondition;
+		unsigned long long wakeEpoch;			// incremented to wake a worker up, guarded by the wake mutex
+	};
+
+	template<typename Function>
+	Job* JobSystem::CreateChildJob(Job* parent, Function&& function)
+	{
+		typedef typename std::decay<Function>::type Callable;
+		static_assert(sizeof(Callable) <= sizeof(Job::data), "The function of a job is too large, capture pointers to its data!");
+		static_assert(alignof(Callable) <= 16, "The function of a job must not be over-aligned!");
+
+		Job* job = AllocateJob();
+		if (parent)
+		{
+			parent->unfinishedJobs.fetch_add(1, std::memory_order_relaxed);
+		}
+		job->parent = parent;
+		job->unfinishedJobs.store(1, std::memory_order_relaxed);
+
+		new (job->data) Callable(std::forward<Function>(function));
+		job->function = [](Job& job)
+		{
+			Callable& callable = *reinterpret_cast<Callable*>(job.data);
+			callable();
+			callable.~Callable();
+		};
+		return job;
+	}
+
+	template<typename Function>
+	void JobSystem::ParallelFor(std::size_t begin, std::size_t end, std::size_t grainSize, const Function& function)
+	{
+		if (begin >= end)
+		{
+			return;
+		}
+
+		// the calling thread splits the range first and runs the lowest part itself
+		Job* root = CreateJob([] {});
+		ParallelForRange<Function>{ this, root, begin, end, grainSize > 0 ? grainSize : 1, &function }();
+		Execute(root, GetThreadState());
+		Wait(root);
+	}
+
+	template<typename Function>
+	void JobSystem::ParallelForRange<Function>::operator()() const
+	{
+		std::size_t first = begin;
+		std::size_t last = end;
+		while (last - first > grainSize)
+		{
+			const std::size_t middle = first + (last - first) / 2;
+			system->Run(system->CreateChildJob(root, ParallelForRange{ system, root, middle, last, grainSize, function }));
+			last = middle;
+		}
+		(*function)(first, last);
+	}
+}
@@ -11,20 +11,132 @@
 
 #pragma region "Includes"
 
-#include "stdafx.h"
-
 // Project includes
 #include "Log.h"
+#include "StringConverter.h"
 
 #pragma endregion
 
 namespace util
 {
+	namespace
+	{
+		// Lifetime of the thread-local handle table; a plain enum can still be read while the thread is being torn down
+		enum class TableState : unsigned char
+		{
+			unused,			// the thread never registered with a logger
+			alive,
+			destroyed,		// the thread is exiting, later log calls go to the shared buffers
+		};
+
+		// The contexts the calling thread has registered, one per logger
+		class ThreadContextTable
+		{
+		public:
+			ThreadContextTable();
+			~ThreadContextTable();
+
+			LogThreadContext* Find(unsigned long long loggerId);
+			void Set(unsigned long long loggerId, std::shared_ptr<LogThreadContext> context);
+
+		private:
+			std::vector<std::pair<unsigned long long, std::shared_ptr<LogThreadContext>>> entries;	// the handles keep the contexts alive until the thread exits
+			unsigned long long lastLoggerId;		// most threads only ever log to one logger
+			LogThreadContext* lastContext;
+		};
+
+		std::atomic<unsigned long long> nextLoggerId(1);
+		thread_local TableState tableState = TableState::unused;
+		thread_local ThreadContextTable threadContextTable;
+
+		ThreadContextTable::ThreadContextTable() :
+			entries(),
+			lastLoggerId(0),
+			lastContext(nullptr)
+		{
+			tableState = TableState::alive;
+		}
+
+		ThreadContextTable::~ThreadContextTable()
+		{
+			// the daemon drains the staging buffers of exited threads one last time and then drops them
+			tableState = TableState::destroyed;
+			for (auto& entry : entries)
+			{
+				entry.second->isRetired.store(true, std::memory_order_release);
+			}
+		}
+
+		LogThreadContext* ThreadContextTable::Find(unsigned long long loggerId)
+		{
+			if (loggerId == lastLoggerId)
+			{
+				return lastContext;
+			}
+
+			for (auto& entry : entries)
+			{
+				if (entry.first == loggerId)
+				{
+					lastLoggerId = loggerId;
+					lastContext = entry.second.get();
+					return lastContext;
+				}
+			}
+			return nullptr;
+		}
+
+		void ThreadContextTable::Set(unsigned long long loggerId, std::shared_ptr<LogThreadContext> context)
+		{
+			lastLoggerId = loggerId;
+			lastContext = context.get();
+			for (auto& entry : entries)
+			{
+				if (entry.first == loggerId)
+				{
+					entry.second->isRetired.store(true, std::memory_order_release);
+					entry.second = std::move(context);
+					return;
+				}
+			}
+			entries.emplace_back(loggerId, std::move(context));
+		}
+	}
+
+	unsigned long long GenerateLoggerId()
+	{
+		return nextLoggerId.fetch_add(1, std::memory_order_relaxed);
+	}
+
+	LogThreadContext* GetThreadContext(unsigned long long loggerId)
+	{
+		// threads that never registered do not construct the table, exiting threads must not touch it anymore
+		if (tableState != TableState::alive)
+		{
+			return nullptr;
+		}
+		return threadContextTable.Find(loggerId);
+	}
+
+	void SetThreadContext(unsigned long long loggerId, std::shared_ptr<LogThreadContext> context)
+	{
+		if (tableState == TableState::destroyed)
+		{
+			context->isRetired.store(true, std::memory_order_release);
+			return;
+		}
+		threadContextTable.Set(loggerId, std::move(context));
+	}
+
 	// Open the file stream
 	bool FileLogPolicy::OpenOutputStream(const std::wstring& filename)
 	{
-		// Open the file
+		// Open the file; only the Microsoft library accepts wide file names
+#ifdef _WIN32
 		outputStream.open(filename.c_str(), std::ios_base::binary | std::ios_base::out);
+#else
+		outputStream.open(StringConverter::ws2s(filename).c_str(), std::ios_base::binary | std::ios_base::out);
+#endif
 
 #ifndef NDEBUG
 		if (!outputStream.is_open())
@@ -46,9 +158,68 @@ namespace util
 		outputStream.close();
 	}
 
-	// Write a message to the log file
+	// Write a message to the log file; the daemon flushes once per batch
 	void FileLogPolicy::Write(const std::string& msg)
 	{
-		outputStream << msg << std::endl;
+		outputStream << msg << '\n';
+	}
+
+	// Flush the file stream
+	void FileLogPolicy::Flush()
+	{
+		outputStream.flush();
+	}
+
+	LogSink::LogSink(LogPolicyInterface& policy, SinkMode mode) :
+		policy(policy),
+		mode(mode),
+		isStructured(policy.IsStructured()),
+		writeMutex(),
+		lineNumber(0),
+		formatter(),
+		line()
+	{
+		line.reserve(2 * LogRecord::argumentCapacity);
+	}
+
+	void LogSink::Write(const LogRecord& record, const std::string& threadName)
+	{
+		std::unique_lock<std::mutex> lock(writeMutex, std::defer_lock);
+		if (mode == SinkMode::synchronous)
+		{
+			lock.lock();
+		}
+
+		if (isStructured)
+		{
+			policy.WriteRecord(record, threadName);
+		}
+		else
+		{
+			line.clear();
+			if (!(record.severity == SeverityType::config))
+			{
+				if (lineNumber != 0)
+				{
+					line += "\r\n";
+				}
+				formatter.AppendHeader(line, lineNumber++, record, threadName);
+			}
+
+			// Log message
+			LogFormatter::AppendMessage(line, record);
+			policy.Write(line);
+		}
+
+		if (mode == SinkMode::synchronous)
+		{
+			policy.Flush();
+		}
+	}
+
+	void LogSink::Flush()
+	{
+		std::lock_guard<std::mutex> lock(writeMutex);
+		policy.Flush();
 	}
 }
@@ -13,7 +13,24 @@
 
 #pragma region "Includes"
 
-#include "stdafx.h"
+// C++ includes
+#include <atomic>						// atomic objects (no data races)
+#include <chrono>						// durations and time points
+#include <condition_variable>			// wake up the daemon
+#include <fstream>						// file streams
+#include <memory>						// smart pointers
+#include <mutex>						// lockable objects
+#include <sstream>						// string streams
+#include <stdexcept>					// std::runtime_error
+#include <string>						// strings
+#include <thread>						// the logging daemon
+#include <vector>						// vector containers
+
+// Project includes
+#include "CrashHandler.h"
+#include "LogRateLimiter.h"
+#include "LogRecord.h"
+#include "RingBuffer.h"
 
 #pragma endregion
 
@@ -28,10 +45,15 @@ namespace util
 		virtual bool OpenOutputStream(const std::wstring& name) = 0;
 		virtual void CloseOutputStream() = 0;
 		virtual void Write(const std::string& msg) = 0;
+		virtual void Flush() = 0;
+
+		// Structured policies encode the binary records themselves instead of receiving formatted text lines
+		virtual bool IsStructured() const { return false; };
+		virtual void WriteRecord(const LogRecord& /*record*/, const std::string& /*threadName*/) {};
 	};
 
 	// File logging policy
-	class FileLogPolicy : LogPolicyInterface
+	class FileLogPolicy : public LogPolicyInterface
 	{
 	public:
 		FileLogPolicy() : outputStream() {};
@@ -40,54 +62,179 @@ namespace util
 		bool OpenOutputStream(const std::wstring& filename) override;
 		void CloseOutputStream() override;
 		void Write(const std::string& msg) override;
+		void Flush() override;
 
 	private:
 		std::ofstream outputStream;
 	};
 
-	// Log levels
-	enum SeverityType
+	// Messages below this severity are compiled out; define LOG_MINIMUM_SEVERITY to override
+#ifndef LOG_MINIMUM_SEVERITY
+#ifndef NDEBUG
+#define LOG_MINIMUM_SEVERITY debug
+#else
+#define LOG_MINIMUM_SEVERITY info
+#endif
+#endif
+	constexpr SeverityType compileTimeMinimumSeverity = SeverityType::LOG_MINIMUM_SEVERITY;
+
+	// How a sink receives its messages
+	enum class SinkMode
+	{
+		buffered,			// written by the logging daemon, flushed once per batch
+		synchronous,		// written and flushed on the calling thread before Print returns
+	};
+
+	// A log policy together with the state needed to turn records into lines for it
+	class LogSink
+	{
+	public:
+		LogSink(LogPolicyInterface& policy, SinkMode mode = SinkMode::buffered);
+		~LogSink() {};
+
+		SinkMode GetMode() const { return mode; };
+
+		// Format a record and hand it to the policy; buffered sinks are only written by the daemon, synchronous sinks are flushed
+		void Write(const LogRecord& record, const std::string& threadName);
+		void Flush();
+
+	private:
+		LogPolicyInterface& policy;			// where the lines go
+		const SinkMode mode;				// buffered or synchronous
+		const bool isStructured;			// the policy encodes the records itself
+		std::mutex writeMutex;				// synchronous sinks are written by several threads
+		unsigned int lineNumber;			// each sink numbers its own lines
+		LogFormatter formatter;				// turns records into text
+		std::string line;					// reused for every line to avoid allocations
+	};
+
+	// Per-thread logging state, created once when a thread registers with SetThreadName
+	// note: the name never changes; renaming a thread retires its context and registers a new one
+	class LogThreadContext
 	{
-		info = 0,
-		debug,
-		warning,
-		error,
-		config,
+	public:
+		LogThreadContext(const std::string& name, std::size_t capacity, OverflowPolicy overflowPolicy) : name(name), stagingBuffer(capacity, overflowPolicy), isRetired(false) {};
+
+		const std::string name;							// the human-readable name of the thread
+		MPSCRingBuffer<LogRecord> stagingBuffer;		// written only by the owning thread, drained by the daemon
+		std::atomic<bool> isRetired;					// set once the thread has exited or was renamed; the daemon drops the context when it is drained
 	};
 
+	// Thread-local handles: every thread keeps its own table of the contexts it has registered, keyed by logger id
+	unsigned long long GenerateLoggerId();											// ids are never reused, thus a stale handle can never match a new logger
+	LogThreadContext* GetThreadContext(unsigned long long loggerId);				// returns nullptr if the calling thread did not register
+	void SetThreadContext(unsigned long long loggerId, std::shared_ptr<LogThreadContext> context);	// retires the previous context, if any
+
 	// Logging daemon
 	template<typename LogPolicy>
 	class Logger;
 
+	// What the logging daemon is currently doing; producers use this to decide whether the daemon must be woken up
+	enum class DaemonState
+	{
+		busy,			// writing to the output stream, will look at the buffers again once it is done
+		idle,			// sleeping until the first message arrives
+		batching,		// sleeping until the batch is full or the flush deadline has passed
+	};
+
 	template<typename LogPolicy>
 	void LoggingDaemon(Logger<LogPolicy>* logger)
 	{
-		std::unique_lock<std::timed_mutex> lock(logger->writeMutex, std::defer_lock);
-		do
+		// the daemon is the only consumer of the log buffers, it never blocks the producers
+		std::unique_lock<std::mutex> lock(logger->daemonMutex);
+		while (logger->isStillRunning || logger->CountPendingMessages() > 0)
 		{
-			std::this_thread::sleep_for(std::chrono::milliseconds{ 50 });
-			if (logger->logBuffer.size())
+			// sleep until the first message arrives; dropped messages of quiet call sites must be reported at some point, though
+			logger->daemonState.store(DaemonState::idle, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			auto isAwake = [logger]
+			{
+				return logger->daemonState.load(std::memory_order_relaxed) != DaemonState::idle || logger->HasPendingWork();
+			};
+			if (logger->rateLimiter.IsEnabled())
+			{
+				logger->daemonWakeup.wait_for(lock, std::chrono::seconds(1), isAwake);
+			}
+			else
 			{
-				if (!lock.try_lock_for(std::chrono::milliseconds{ 50 }))
-					continue;
-				for (auto& x : logger->logBuffer)
-					logger->policy.Write(x);
-				logger->logBuffer.clear();
-				lock.unlock();
+				logger->daemonWakeup.wait(lock, isAwake);
 			}
-		} while (logger->isStillRunning.test_and_set() || logger->logBuffer.size());
+
+			// give the batch time to fill up, but never hold a message back for longer than the flush deadline
+			logger->daemonState.store(DaemonState::batching, std::memory_order_relaxed);
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+			logger->daemonWakeup.wait_for(lock, logger->flushDeadline, [logger]
+			{
+				return logger->daemonState.load(std::memory_order_relaxed) != DaemonState::batching || !logger->isStillRunning || logger->flushRequests > logger->completedFlushes || logger->CountPendingMessages() >= logger->batchSize.load(std::memory_order_relaxed);
+			});
+			logger->daemonState.store(DaemonState::busy, std::memory_order_relaxed);
+
+			// write the batch without holding the lock
+			unsigned long long flushRequest = logger->flushRequests;
+			bool isShuttingDown = !logger->isStillRunning;
+			lock.unlock();
+			logger->DrainBuffers(flushRequest > logger->completedFlushes, isShuttingDown);
+			logger->FlushSinks(SinkMode::buffered);
+
+			// everything requested so far is on disk, release the threads waiting in Flush()
+			lock.lock();
+			logger->completedFlushes = flushRequest;
+			logger->flushCompleted.notify_all();
+		}
 	}
 
 	// Logger
 	template<typename LogPolicy>
-	class Logger
+	class Logger : public CrashDumpSource
 	{
 	public:
-		Logger(const std::wstring& name);
+		Logger(const std::wstring& name, std::size_t bufferCapacity = 4096, OverflowPolicy overflowPolicy = OverflowPolicy::block, std::size_t threadBufferCapacity = 256);
 		~Logger();
 
+		// Registers the calling thread: its log calls then go to a private staging buffer and its name is cached with it
+		// note: threads that never register share one buffer and are logged without a name
 		void SetThreadName(const std::string& name);
 
+		// Messages below the minimum severity are discarded; configuration messages are always written
+		void SetMinimumSeverity(SeverityType severity) { minimumSeverity.store(severity, std::memory_order_relaxed); };
+		SeverityType GetMinimumSeverity() const { return minimumSeverity.load(std::memory_order_relaxed); };
+
+		// Routing: by default every severity is written to the logger's own policy by the daemon
+		// note: routes should be set up before other threads start logging
+		LogSink* GetDefaultSink() { return sinks[0].get(); };
+		LogSink* AddSink(std::shared_ptr<LogPolicyInterface> sinkPolicy, SinkMode mode = SinkMode::buffered);	// the policy must be open
+		bool AddRoute(SeverityType severity, LogSink* sink, unsigned int sampleRate = 1);						// write one out of sampleRate messages to the sink
+		void ClearRoutes(SeverityType severity);
+		void SetSampleRate(SeverityType severity, unsigned int sampleRate);									// applies to every route of the severity
+
+		// Rate limiting and deduplication per call site, dropped messages are reported as "(repeated N times)"
+		void SetRateLimit(SeverityType severity, double messagesPerSecond, unsigned int burst) { rateLimiter.SetRateLimit(severity, messagesPerSecond, burst); };
+		void SetDeduplicationWindow(SeverityType severity, std::chrono::milliseconds window) { rateLimiter.SetDeduplicationWindow(severity, window); };
+
+		// The daemon writes as soon as batchSize messages are pending, or once the oldest pending message is flushDeadline old
+		void SetFlushDeadline(std::chrono::milliseconds deadline);
+		void SetBatchSize(std::size_t size) { batchSize.store(size, std::memory_order_relaxed); };
+
+		// Blocks until every message logged before the call has been written and flushed by the daemon
+		void Flush();
+
+		// Keeps the last messages in a black box and lets the crash handlers save them together with all pending messages
+		// note: the crash handlers must have been installed with CrashHandler::Install
+		bool EnableCrashHandling(std::size_t blackBoxCapacity = 256);
+		void DumpOnCrash(CrashWriter& writer) override;			// async-signal-safe
+
+		// Number of messages lost because a log buffer was full
+		unsigned long long GetDroppedMessageCount() const { return GetDroppedNewestCount() + GetDroppedOldestCount(); };
+		unsigned long long GetDroppedNewestCount() const;
+		unsigned long long GetDroppedOldestCount() const;
+
+		// Deferred logging: only the address of the format string and the raw arguments are copied, the daemon does the formatting
+		// note: the format must be a string literal, its address is used to identify it
+		template<SeverityType severity, std::size_t N, typename... Args>
+		void Print(const char (&format)[N], const Args&... args);
+
+		// Messages that are already text are passed as the argument of a shared "{}" format string: they are truncated to
+		// LogRecord::maxStringLength characters, ending with "...", and they all share one call site of the rate limiter
 		template<SeverityType severity>
 		void Print(std::stringstream stream);
 
@@ -97,26 +244,112 @@ namespace util
 		template<typename Policy>
 		friend void LoggingDaemon(Logger<Policy>* logger);
 	private:
-		unsigned int logLineNumber;								// used to save the current line number
-		std::map<std::thread::id, std::string> threadName;		// defines a human-readable name for each thread
+		void WakeDaemon(bool urgent, const MPSCRingBuffer<LogRecord>& buffer);	// notify the daemon if it is sleeping and there is reason to wake it
+		bool HasPendingWork();									// true if the daemon has something to do; daemon only, requires daemonMutex
+		std::size_t CountPendingMessages();						// number of messages waiting in all buffers; daemon only
+		void RefreshThreadContexts();							// update the daemon's copy of the registered threads; daemon only
+		void DrainBuffers(bool isFlushing, bool isShuttingDown);	// hand the pending messages of every buffer to the sinks; daemon only
+		void DrainBuffer(MPSCRingBuffer<LogRecord>& buffer, const std::string& threadName, LogBlackBox* box, bool isFlushing);
+		void WriteRecord(const LogRecord& record, const std::string& threadName);	// hand a record to the buffered sinks it is routed to; daemon only
+		void FlushSinks(SinkMode mode);							// flush all sinks of the given mode
+
+	private:
+		static const std::size_t severityCount = SeverityType::config + 1;
+		static const std::size_t maxSinks = 8;
+		static const std::size_t maxRoutesPerSeverity = 4;
+
+		struct Route
+		{
+			std::atomic<LogSink*> sink;							// the sink the messages are written to
+			std::atomic<unsigned int> sampleRate;				// only one out of sampleRate messages is written
+			std::atomic<unsigned long long> sampleCounter;		// number of messages seen by this route
+		};
+
+		struct RouteTable
+		{
+			Route routes[maxRoutesPerSeverity];
+			std::atomic<std::size_t> count;						// number of valid routes
+		};
+
+		const unsigned long long id;							// identifies the logger in the thread-local handle tables
 		LogPolicy policy;										// the log policy (i.e. write to file, ...)
-		std::timed_mutex writeMutex;							// mutual exclusive writer
-		std::vector<std::string> logBuffer;						// the content to log
+		MPSCRingBuffer<LogRecord> logBuffer;					// the content logged by unregistered threads, drained by the daemon
+		const std::string unnamedThread;						// the name of all unregistered threads
+
+		// Registered threads
+		std::vector<std::shared_ptr<LogThreadContext>> threadContexts;	// the contexts of all registered threads
+		mutable std::mutex threadContextMutex;					// protects the registry, only taken to register or retire a thread
+		std::atomic<unsigned int> threadContextVersion;			// incremented whenever the registry changes
+		const std::size_t threadBufferCapacity;					// number of records in each staging buffer
+		std::atomic<unsigned long long> retiredDroppedNewest;	// messages dropped by the staging buffers of retired threads
+		std::atomic<unsigned long long> retiredDroppedOldest;
+
+		// Severity filtering and routing
+		std::atomic<SeverityType> minimumSeverity;				// runtime threshold, can only raise the compile-time threshold
+		std::unique_ptr<LogSink> sinks[maxSinks];				// sinks[0] writes to the logger's own policy
+		std::shared_ptr<LogPolicyInterface> sinkPolicies[maxSinks];	// keeps the policies of added sinks alive
+		std::atomic<std::size_t> sinkCount;						// number of valid sinks
+		RouteTable routeTables[severityCount];					// the sinks each severity is written to
+		LogRateLimiter rateLimiter;								// drops repeated messages and messages beyond the rate limits
+
+		// Crash handling
+		std::unique_ptr<LogBlackBox> blackBoxOwner;				// owns the black box, if crash handling is enabled
+		std::atomic<LogBlackBox*> blackBox;						// the last messages processed by the daemon
+
+		// Daemon-only state
+		std::vector<std::shared_ptr<LogThreadContext>> daemonThreadContexts;	// the daemon's copy of the registry
+		unsigned int daemonThreadContextVersion;				// version of the daemon's copy
 		std::thread daemon;										// the actual logging daemon
-		std::atomic_flag isStillRunning{ ATOMIC_FLAG_INIT };	// lock-free boolean to check whether our daemon is still running or not
+
+		// Daemon wakeup
+		std::mutex daemonMutex;									// protects the daemon's sleep and the members below
+		std::condition_variable daemonWakeup;					// signaled when the daemon has work to do
+		std::condition_variable flushCompleted;					// signaled after each batch was written and flushed
+		std::atomic<DaemonState> daemonState;					// read by producers without taking the lock
+		std::atomic<std::size_t> batchSize;						// number of pending messages that triggers a write
+		std::chrono::milliseconds flushDeadline;				// maximum time a message waits before it is written
+		unsigned long long flushRequests;						// number of calls to Flush()
+		unsigned long long completedFlushes;					// number of flush requests the daemon has completed
+		bool isStillRunning;									// false once the logger is being destroyed
 	};
 
 	template<typename LogPolicy>
-	Logger<LogPolicy>::Logger(const std::wstring& name) :
-		logLineNumber(0),
-		threadName(),
+	Logger<LogPolicy>::Logger(const std::wstring& name, std::size_t bufferCapacity, OverflowPolicy overflowPolicy, std::size_t threadBufferCapacity) :
+		id(GenerateLoggerId()),
 		policy(),
-		writeMutex(),
-		logBuffer()
+		logBuffer(bufferCapacity, overflowPolicy),
+		unnamedThread(),
+		threadContexts(),
+		threadContextMutex(),
+		threadContextVersion(0),
+		threadBufferCapacity(threadBufferCapacity),
+		retiredDroppedNewest(0),
+		retiredDroppedOldest(0),
+		minimumSeverity(compileTimeMinimumSeverity),
+		sinkCount(0),
+		blackBoxOwner(),
+		blackBox(nullptr),
+		daemonThreadContexts(),
+		daemonThreadContextVersion(0),
+		daemonState(DaemonState::busy),
+		batchSize(256),
+		flushDeadline(50),
+		flushRequests(0),
+		completedFlushes(0),
+		isStillRunning(false)
 	{
+		// route every severity to the logger's own policy
+		sinks[0].reset(new LogSink(policy));
+		sinkCount.store(1, std::memory_order_release);
+		for (std::size_t i = 0; i < severityCount; i++)
+		{
+			routeTables[i].count.store(0, std::memory_order_relaxed);
+			AddRoute(static_cast<SeverityType>(i), sinks[0].get());
+		}
+
 		if (policy.OpenOutputStream(name))
 		{
-			isStillRunning.test_and_set();	// mark the logging daemon as running
+			isStillRunning = true;	// mark the logging daemon as running
 			daemon = std::move(std::thread{ LoggingDaemon<LogPolicy>, this });
 		}
 		else
@@ -128,85 +361,427 @@ namespace util
 	template<typename LogPolicy>
 	Logger<LogPolicy>::~Logger()
 	{
-#ifndef NDEBUG
+		CrashHandler::Unregister(this);
+
 		// print closing message
-		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The file logger was shut down.");
-#endif
+		this->Print<util::SeverityType::debug>("The file logger was shut down.");
+
 		// terminate the daemon by clearing the still running flag and letting it join to the main thread
-		isStillRunning.clear();
+		{
+			std::lock_guard<std::mutex> lock(daemonMutex);
+			isStillRunning = false;
+		}
+		daemonWakeup.notify_one();
 		daemon.join();
 
-		// clear the thread name map
-		threadName.clear();
-		std::map<std::thread::id, std::string>().swap(threadName);
-
-		// clear the log vector
-		logBuffer.clear();
-		logBuffer.shrink_to_fit();
+		// release the registry; threads that are still alive keep their own handles until they exit
+		std::vector<std::shared_ptr<LogThreadContext>>().swap(daemonThreadContexts);
+		{
+			std::lock_guard<std::mutex> lock(threadContextMutex);
+			std::vector<std::shared_ptr<LogThreadContext>>().swap(threadContexts);
+		}
 
-		// close the output stream
+		// flush the additional sinks and close the output stream
+		FlushSinks(SinkMode::synchronous);
 		policy.CloseOutputStream();
 	}
 
 	template<typename LogPolicy>
 	void Logger<LogPolicy>::SetThreadName(const std::string& name)
 	{
-		threadName[std::this_thread::get_id()] = name;
+		std::shared_ptr<LogThreadContext> context = std::make_shared<LogThreadContext>(name, threadBufferCapacity, logBuffer.GetOverflowPolicy());
+		{
+			std::lock_guard<std::mutex> lock(threadContextMutex);
+			threadContexts.push_back(context);
+			threadContextVersion.fetch_add(1, std::memory_order_release);
+		}
+
+		// from now on the thread finds its context without touching shared state
+		SetThreadContext(id, context);
 	}
 
 	template<typename LogPolicy>
-	template<SeverityType severity>
-	void Logger<LogPolicy>::Print(std::stringstream stream)
+	void Logger<LogPolicy>::SetFlushDeadline(std::chrono::milliseconds deadline)
 	{
-		std::stringstream logStream;
+		std::lock_guard<std::mutex> lock(daemonMutex);
+		flushDeadline = deadline;
+	}
 
-		if (!(severity == SeverityType::config))
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::Flush()
+	{
+		// the daemon looks at the buffers after it has seen the request, thus it finds every message logged before the call
+		std::unique_lock<std::mutex> lock(daemonMutex);
+		unsigned long long request = ++flushRequests;
+		daemonWakeup.notify_one();
+		flushCompleted.wait(lock, [this, request] { return completedFlushes >= request; });
+	}
+
+	template<typename LogPolicy>
+	bool Logger<LogPolicy>::EnableCrashHandling(std::size_t blackBoxCapacity)
+	{
+		if (blackBoxOwner)
+		{
+			return true;
+		}
+
+		blackBoxOwner.reset(new LogBlackBox(blackBoxCapacity));
+		blackBox.store(blackBoxOwner.get(), std::memory_order_release);
+		return CrashHandler::Register(this);
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::DumpOnCrash(CrashWriter& writer)
+	{
+		// the last messages handed to the sinks: they may not have reached the disk yet
+		LogBlackBox* box = blackBox.load(std::memory_order_acquire);
+		if (box != nullptr)
+		{
+			writer.Write("--- last processed messages ---\n");
+			box->Dump(writer);
+		}
+
+		// the messages still waiting for the daemon; popping is lock-free, thus the daemon may even be running
+		// note: the registry is read without its lock, it only changes when a thread registers or exits
+		writer.Write("--- pending messages ---\n");
+		while (logBuffer.Pop([&writer](LogRecord& record) { writer.WriteRecord(record, ""); }));
+		for (const auto& context : threadContexts)
+		{
+			const char* name = context->name.c_str();
+			while (context->stagingBuffer.Pop([&writer, name](LogRecord& record) { writer.WriteRecord(record, name); }));
+		}
+	}
+
+	template<typename LogPolicy>
+	unsigned long long Logger<LogPolicy>::GetDroppedNewestCount() const
+	{
+		std::lock_guard<std::mutex> lock(threadContextMutex);
+		unsigned long long count = logBuffer.GetDroppedNewestCount() + retiredDroppedNewest.load(std::memory_order_relaxed);
+		for (const auto& context : threadContexts)
+		{
+			count += context->stagingBuffer.GetDroppedNewestCount();
+		}
+		return count;
+	}
+
+	template<typename LogPolicy>
+	unsigned long long Logger<LogPolicy>::GetDroppedOldestCount() const
+	{
+		std::lock_guard<std::mutex> lock(threadContextMutex);
+		unsigned long long count = logBuffer.GetDroppedOldestCount() + retiredDroppedOldest.load(std::memory_order_relaxed);
+		for (const auto& context : threadContexts)
 		{
-			SYSTEMTIME localTime;
-			GetLocalTime(&localTime);
+			count += context->stagingBuffer.GetDroppedOldestCount();
+		}
+		return count;
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::WakeDaemon(bool urgent, const MPSCRingBuffer<LogRecord>& buffer)
+	{
+		// pairs with the fences in the daemon: either the daemon sees the new message, or we see that it is sleeping
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		DaemonState state = daemonState.load(std::memory_order_relaxed);
+		if (state == DaemonState::busy)
+		{
+			return;
+		}
+		if (state == DaemonState::batching && !urgent && buffer.GetApproximateSize() < batchSize.load(std::memory_order_relaxed))
+		{
+			return;
+		}
 
-			// Log header: log#: MM/dd/yyyy hh:mm:ss
-			if (logLineNumber != 0)
+		// only the producer that changes the state takes the lock, all others return immediately
+		if (daemonState.compare_exchange_strong(state, DaemonState::busy))
+		{
+			std::lock_guard<std::mutex> lock(daemonMutex);
+			daemonWakeup.notify_one();
+		}
+	}
+
+	template<typename LogPolicy>
+	bool Logger<LogPolicy>::HasPendingWork()
+	{
+		return !isStillRunning || flushRequests > completedFlushes || CountPendingMessages() > 0;
+	}
+
+	template<typename LogPolicy>
+	std::size_t Logger<LogPolicy>::CountPendingMessages()
+	{
+		RefreshThreadContexts();
+		std::size_t count = logBuffer.GetApproximateSize();
+		for (const auto& context : daemonThreadContexts)
+		{
+			count += context->stagingBuffer.GetApproximateSize();
+		}
+		return count;
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::RefreshThreadContexts()
+	{
+		// only copy the registry if a thread has registered or retired since the last time
+		unsigned int version = threadContextVersion.load(std::memory_order_acquire);
+		if (version != daemonThreadContextVersion)
+		{
+			std::lock_guard<std::mutex> lock(threadContextMutex);
+			daemonThreadContexts = threadContexts;
+			daemonThreadContextVersion = threadContextVersion.load(std::memory_order_relaxed);
+		}
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::DrainBuffers(bool isFlushing, bool isShuttingDown)
+	{
+		RefreshThreadContexts();
+
+		// every staging buffer is handed off as one batch, thus the messages of a thread stay together and in order
+		bool hasRetiredThreads = false;
+		LogBlackBox* box = blackBox.load(std::memory_order_acquire);
+		DrainBuffer(logBuffer, unnamedThread, box, isFlushing);
+		for (const auto& context : daemonThreadContexts)
+		{
+			bool isRetired = context->isRetired.load(std::memory_order_acquire);
+			DrainBuffer(context->stagingBuffer, context->name, box, isFlushing);
+			hasRetiredThreads = hasRetiredThreads || (isRetired && context->stagingBuffer.IsEmpty());
+		}
+
+		// report the messages dropped by call sites that went quiet; everything is reported before the logger shuts down
+		if (rateLimiter.IsEnabled())
+		{
+			const std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+			rateLimiter.ReportRepeats(now, isShuttingDown, [this](const LogRecord& record, const std::string& threadName) { WriteRecord(record, threadName); });
+		}
+		if (!hasRetiredThreads)
+		{
+			return;
+		}
+
+		// drop the contexts of threads that have exited and whose messages have all been written
+		std::lock_guard<std::mutex> lock(threadContextMutex);
+		for (auto it = threadContexts.begin(); it != threadContexts.end();)
+		{
+			LogThreadContext& context = **it;
+			if (context.isRetired.load(std::memory_order_acquire) && context.stagingBuffer.IsEmpty())
 			{
-				logStream << "\r\n";
+				retiredDroppedNewest.fetch_add(context.stagingBuffer.GetDroppedNewestCount(), std::memory_order_relaxed);
+				retiredDroppedOldest.fetch_add(context.stagingBuffer.GetDroppedOldestCount(), std::memory_order_relaxed);
+				it = threadContexts.erase(it);
 			}
-			logStream << logLineNumber++ << ": " << localTime.wMonth << "/" << localTime.wDay << "/" << localTime.wYear << " " << localTime.wHour << ":" << localTime.wMinute << ":" << localTime.wSecond << "\t";
+			else
+			{
+				++it;
+			}
+		}
+		threadContextVersion.fetch_add(1, std::memory_order_release);
+	}
 
-			// Log warning level
-			switch (severity)
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::DrainBuffer(MPSCRingBuffer<LogRecord>& buffer, const std::string& threadName, LogBlackBox* box, bool isFlushing)
+	{
+		// only take what was there when the daemon started, a busy thread must not starve the others
+		std::size_t target = buffer.GetEnqueuePosition();
+		auto write = [this, &threadName, box](LogRecord& record)
+		{
+			if (box != nullptr)
+			{
+				box->Record(record, threadName);
+			}
+			if (record.previousRepeatCount > 0)
+			{
+				// the repeats of the previous message of the call site come before the new message
+				rateLimiter.ReportPreviousRepeats(record, [this](const LogRecord& repeat, const std::string& repeatThreadName) { WriteRecord(repeat, repeatThreadName); });
+			}
+			if (rateLimiter.IsActive(record.severity))
+			{
+				rateLimiter.RememberWritten(record, threadName);
+			}
+			WriteRecord(record, threadName);
+		};
+		for (;;)
+		{
+			while (buffer.GetDequeuePosition() < target && buffer.Pop(write));
+			if (!isFlushing || buffer.GetDequeuePosition() >= target)
 			{
-			case SeverityType::info:
-				logStream << "INFO:    ";
-				break;
-			case SeverityType::debug:
-				logStream << "DEBUG:   ";
-				break;
-			case SeverityType::warning:
-				logStream << "WARNING: ";
-				break;
-			case SeverityType::error:
-				logStream << "ERROR:   ";
 				break;
 			}
 
-			// Log thread name
-			logStream << threadName[std::this_thread::get_id()] << ":\t";
+			// a flush is waiting for a message a producer has claimed a slot for but not yet finished writing
+			std::this_thread::yield();
+		}
+	}
+
+	template<typename LogPolicy>
+	LogSink* Logger<LogPolicy>::AddSink(std::shared_ptr<LogPolicyInterface> sinkPolicy, SinkMode mode)
+	{
+		std::size_t index = sinkCount.load(std::memory_order_relaxed);
+		if (index == maxSinks || !sinkPolicy)
+		{
+			return nullptr;
+		}
+
+		sinks[index].reset(new LogSink(*sinkPolicy, mode));
+		sinkPolicies[index] = sinkPolicy;
+		sinkCount.store(index + 1, std::memory_order_release);
+		return sinks[index].get();
+	}
+
+	template<typename LogPolicy>
+	bool Logger<LogPolicy>::AddRoute(SeverityType severity, LogSink* sink, unsigned int sampleRate)
+	{
+		RouteTable& table = routeTables[severity];
+		std::size_t index = table.count.load(std::memory_order_relaxed);
+		if (index == maxRoutesPerSeverity || !sink)
+		{
+			return false;
+		}
+
+		Route& route = table.routes[index];
+		route.sink.store(sink, std::memory_order_relaxed);
+		route.sampleRate.store(sampleRate > 0 ? sampleRate : 1, std::memory_order_relaxed);
+		route.sampleCounter.store(0, std::memory_order_relaxed);
+		table.count.store(index + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::ClearRoutes(SeverityType severity)
+	{
+		// sinks are never destroyed while the logger lives, thus readers holding an old route remain valid
+		routeTables[severity].count.store(0, std::memory_order_release);
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::SetSampleRate(SeverityType severity, unsigned int sampleRate)
+	{
+		RouteTable& table = routeTables[severity];
+		std::size_t count = table.count.load(std::memory_order_acquire);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			table.routes[i].sampleRate.store(sampleRate > 0 ? sampleRate : 1, std::memory_order_relaxed);
+		}
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::WriteRecord(const LogRecord& record, const std::string& threadName)
+	{
+		RouteTable& table = routeTables[record.severity];
+		std::size_t count = table.count.load(std::memory_order_acquire);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			Route& route = table.routes[i];
+			LogSink* sink = route.sink.load(std::memory_order_relaxed);
+			if (sink->GetMode() == SinkMode::buffered && route.sampleCounter.fetch_add(1, std::memory_order_relaxed) % route.sampleRate.load(std::memory_order_relaxed) == 0)
+			{
+				sink->Write(record, threadName);
+			}
+		}
+	}
+
+	template<typename LogPolicy>
+	void Logger<LogPolicy>::FlushSinks(SinkMode mode)
+	{
+		std::size_t count = sinkCount.load(std::memory_order_acquire);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			if (sinks[i]->GetMode() == mode)
+			{
+				sinks[i]->Flush();
+			}
+		}
+	}
+
+	template<typename LogPolicy>
+	template<SeverityType severity, std::size_t N, typename... Args>
+	void Logger<LogPolicy>::Print(const char (&format)[N], const Args&... args)
+	{
+		// compile-time and runtime severity filters; configuration messages are never filtered
+		if (severity != SeverityType::config)
+		{
+			if (severity < compileTimeMinimumSeverity || severity < minimumSeverity.load(std::memory_order_relaxed))
+			{
+				return;
+			}
+		}
+
+		// registered threads log into their own staging buffer, all others share the logger's buffer
+		LogThreadContext* context = GetThreadContext(id);
+		MPSCRingBuffer<LogRecord>& buffer = context ? context->stagingBuffer : logBuffer;
+
+		const std::int64_t timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		const std::thread::id threadId = std::this_thread::get_id();
+		auto encode = [&](LogRecord& record)
+		{
+			record.format = format;
+			record.timestamp = timestamp;
+			record.threadId = threadId;
+			record.severity = severity;
+			record.repeatCount = 0;
+			record.previousRepeatCount = 0;
+			LogArgumentEncoder(record).Encode(args...);
+		};
+
+		// limited call sites need the encoded arguments to decide, the admitted record is then copied into the buffer
+		LogRecord admittedRecord;
+		const bool isLimited = severity != SeverityType::config && rateLimiter.IsActive(severity);
+		if (isLimited)
+		{
+			encode(admittedRecord);
+			if (!rateLimiter.Admit(admittedRecord))
+			{
+				return;
+			}
+		}
+		auto write = [&](LogRecord& record)
+		{
+			if (isLimited)
+			{
+				CopyLogRecord(record, admittedRecord);
+			}
+			else
+			{
+				encode(record);
+			}
+		};
+
+		// synchronous sinks are written on the calling thread, buffered sinks are left to the daemon
+		bool hasBufferedRoute = false;
+		RouteTable& table = routeTables[severity];
+		std::size_t count = table.count.load(std::memory_order_acquire);
+		for (std::size_t i = 0; i < count; i++)
+		{
+			Route& route = table.routes[i];
+			LogSink* sink = route.sink.load(std::memory_order_relaxed);
+			if (sink->GetMode() == SinkMode::buffered)
+			{
+				hasBufferedRoute = true;
+			}
+			else if (route.sampleCounter.fetch_add(1, std::memory_order_relaxed) % route.sampleRate.load(std::memory_order_relaxed) == 0)
+			{
+				LogRecord record;
+				write(record);
+				sink->Write(record, context ? context->name : unnamedThread);
+			}
 		}
 
-		// Log message
-		logStream << stream.str();
-		std::lock_guard<std::timed_mutex> lock(writeMutex);
-		logBuffer.push_back(logStream.str());
+		if (hasBufferedRoute && buffer.Push(write))
+		{
+			// errors are written right away, everything else may wait for the batch to fill up
+			WakeDaemon(severity == SeverityType::error, buffer);
+		}
+	}
+
+	template<typename LogPolicy>
+	template<SeverityType severity>
+	void Logger<LogPolicy>::Print(std::stringstream stream)
+	{
+		this->Print<severity>("{}", stream.str());
 	}
 
 	template<typename LogPolicy>
 	template<SeverityType severity>
 	void Logger<LogPolicy>::Print(std::string msg)
 	{
-		std::stringstream stream;
-		stream << msg.c_str();
-		this->Print<severity>(std::stringstream(stream.str()));
+		this->Print<severity>("{}", msg);
 	}
 }
-
-
@@ -0,0 +1,186 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* LogRateLimiter.cpp
+*
+* Per-call-site rate limiting and deduplication of log messages
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// Project includes
+#include "LogRateLimiter.h"
+
+#pragma endregion
+
+namespace util
+{
+	LogRateLimiter::LogRateLimiter() :
+		activeSeverities(0),
+		writtenMessages()
+	{
+		for (std::size_t i = 0; i < maxCallSites; i++)
+		{
+			callSites[i].format.store(nullptr, std::memory_order_relaxed);
+			callSites[i].theoreticalArrival.store(0, std::memory_order_relaxed);
+			callSites[i].lastWrittenTime.store(0, std::memory_order_relaxed);
+			callSites[i].lastHash.store(0, std::memory_order_relaxed);
+			callSites[i].dropped.store(0, std::memory_order_relaxed);
+		}
+		for (Limit& limit : limits)
+		{
+			limit.interval.store(0, std::memory_order_relaxed);
+			limit.tolerance.store(0, std::memory_order_relaxed);
+			limit.deduplicationWindow.store(0, std::memory_order_relaxed);
+		}
+	}
+
+	void LogRateLimiter::SetRateLimit(SeverityType severity, double messagesPerSecond, unsigned int burst)
+	{
+		std::int64_t interval = messagesPerSecond > 0 ? static_cast<std::int64_t>(1e9 / messagesPerSecond) : 0;
+		if (messagesPerSecond > 0 && interval < 1)
+		{
+			interval = 1;
+		}
+		limits[severity].tolerance.store(interval * (burst > 0 ? burst : 1), std::memory_order_relaxed);
+		limits[severity].interval.store(interval, std::memory_order_relaxed);
+		UpdateActiveSeverities();
+	}
+
+	void LogRateLimiter::SetDeduplicationWindow(SeverityType severity, std::chrono::nanoseconds window)
+	{
+		limits[severity].deduplicationWindow.store(window.count() > 0 ? window.count() : 0, std::memory_order_relaxed);
+		UpdateActiveSeverities();
+	}
+
+	void LogRateLimiter::UpdateActiveSeverities()
+	{
+		// configuration messages are never dropped
+		unsigned int mask = 0;
+		for (unsigned int severity = SeverityType::debug; severity < SeverityType::config; severity++)
+		{
+			if (limits[severity].deduplicationWindow.load(std::memory_order_relaxed) > 0 || limits[severity].interval.load(std::memory_order_relaxed) > 0)
+			{
+				mask |= 1u << severity;
+			}
+		}
+		activeSeverities.store(mask, std::memory_order_relaxed);
+	}
+
+	bool LogRateLimiter::Admit(LogRecord& record)
+	{
+		CallSite* site = FindCallSite(record.format, true);
+		if (site == nullptr)
+		{
+			return true;
+		}
+
+		const std::int64_t now = record.timestamp;
+		const std::uint64_t hash = HashArguments(record);
+
+		// drop the message if it is the same as the last one and the window has not passed yet
+		const Limit& limit = limits[record.severity];
+		const std::int64_t window = limit.deduplicationWindow.load(std::memory_order_relaxed);
+		if (window > 0 && site->lastHash.load(std::memory_order_relaxed) == hash && now - site->lastWrittenTime.load(std::memory_order_relaxed) < window)
+		{
+			site->dropped.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		// token bucket: take a token by pushing the theoretical arrival time forward, unless the bucket is empty
+		const std::int64_t interval = limit.interval.load(std::memory_order_relaxed);
+		if (interval > 0)
+		{
+			const std::int64_t tolerance = limit.tolerance.load(std::memory_order_relaxed);
+			std::int64_t arrival = site->theoreticalArrival.load(std::memory_order_relaxed);
+			for (;;)
+			{
+				std::int64_t newArrival = (arrival > now ? arrival : now) + interval;
+				if (newArrival - now > tolerance)
+				{
+					site->dropped.fetch_add(1, std::memory_order_relaxed);
+					return false;
+				}
+				if (site->theoreticalArrival.compare_exchange_weak(arrival, newArrival, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+		}
+
+		// the dropped messages are repeats of this message only if it is the same as the last one; otherwise they belong to
+		// the previous message, which the daemon reports first
+		const bool isRepeat = site->lastHash.exchange(hash, std::memory_order_relaxed) == hash;
+		site->lastWrittenTime.store(now, std::memory_order_relaxed);
+		const std::uint32_t dropped = site->dropped.exchange(0, std::memory_order_relaxed);
+		record.repeatCount = isRepeat ? dropped : 0;
+		record.previousRepeatCount = isRepeat ? 0 : dropped;
+		return true;
+	}
+
+	void LogRateLimiter::RememberWritten(const LogRecord& record, const std::string& threadName)
+	{
+		CallSite* site = FindCallSite(record.format, false);
+		if (site == nullptr)
+		{
+			return;
+		}
+
+		if (!writtenMessages)
+		{
+			writtenMessages.reset(new WrittenMessage[maxCallSites]);
+			for (std::size_t i = 0; i < maxCallSites; i++)
+			{
+				writtenMessages[i].record.format = nullptr;
+			}
+		}
+
+		WrittenMessage& message = writtenMessages[site - callSites];
+		CopyLogRecord(message.record, record);
+		message.threadName = threadName;
+	}
+
+	LogRateLimiter::CallSite* LogRateLimiter::FindCallSite(const char* format, bool insert)
+	{
+		// format strings are string literals, their addresses make good keys
+		std::size_t index = (reinterpret_cast<std::uintptr_t>(format) >> 3) * 0x9E3779B97F4A7C15ull % maxCallSites;
+		for (std::size_t probe = 0; probe < maxCallSites; probe++)
+		{
+			CallSite& site = callSites[(index + probe) % maxCallSites];
+			const char* key = site.format.load(std::memory_order_acquire);
+			if (key == format)
+			{
+				return &site;
+			}
+			if (key == nullptr)
+			{
+				if (!insert)
+				{
+					return nullptr;
+				}
+
+				// claim the free slot; if another producer was faster, it may have claimed it for the same call site
+				if (site.format.compare_exchange_strong(key, format, std::memory_order_acq_rel) || key == format)
+				{
+					return &site;
+				}
+			}
+		}
+		return nullptr;
+	}
+
+	std::uint64_t LogRateLimiter::HashArguments(const LogRecord& record)
+	{
+		// FNV-1a
+		std::uint64_t hash = 14695981039346656037ull;
+		for (std::size_t i = 0; i < record.argumentSize; i++)
+		{
+			hash ^= static_cast<unsigned char>(record.arguments[i]);
+			hash *= 1099511628211ull;
+		}
+		return hash;
+	}
+}
@@ -0,0 +1,176 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* LogRateLimiter.h
+*
+* Per-call-site rate limiting and deduplication of log messages
+*
+* A call site is identified by the address of its format string. Each call site has:
+* - a token bucket, implemented as a generic cell rate algorithm: a single timestamp, the theoretical arrival time, is
+*   pushed forward by one emission interval for every written message; a message is dropped if that would push it more than
+*   burst intervals into the future
+*	- https://en.wikipedia.org/wiki/Generic_cell_rate_algorithm
+* - the hash of the arguments of its last written message: the same message is dropped until the deduplication window
+*   has passed
+*
+* If the next written message of a call site is the one that was repeated, it reports how many messages were dropped
+* before it: "... (repeated N times)". If it is a different message, the logging daemon first reports the dropped messages
+* together with the previous written message. If a call site goes quiet, the logging daemon reports the dropped messages
+* together with the last written message.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <atomic>			// atomic objects (no data races)
+#include <chrono>			// durations
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <memory>			// std::unique_ptr
+#include <string>			// strings
+
+// Project includes
+#include "LogRecord.h"
+
+#pragma endregion
+
+namespace util
+{
+	class LogRateLimiter
+	{
+	public:
+		static const std::size_t maxCallSites = 256;		// call sites beyond this number are never limited
+
+		LogRateLimiter();
+		~LogRateLimiter() {};
+
+		// At most messagesPerSecond messages per call site on average, in bursts of up to burst messages; 0 removes the limit
+		void SetRateLimit(SeverityType severity, double messagesPerSecond, unsigned int burst);
+
+		// Identical messages of a call site are only written once per window; 0 disables deduplication
+		void SetDeduplicationWindow(SeverityType severity, std::chrono::nanoseconds window);
+
+		// True if messages of the given severity are limited or deduplicated
+		bool IsActive(SeverityType severity) const { return (activeSeverities.load(std::memory_order_relaxed) & (1u << severity)) != 0; };
+		bool IsEnabled() const { return activeSeverities.load(std::memory_order_relaxed) != 0; };
+
+		// Producers: returns false if the message must be dropped, otherwise the number of messages of the call site that
+		// were dropped since its last written message is set to record.repeatCount if the message is the same as the last
+		// one, or to record.previousRepeatCount if it is not
+		bool Admit(LogRecord& record);
+
+		// Daemon: remember the last written message of each call site
+		void RememberWritten(const LogRecord& record, const std::string& threadName);
+
+		// Daemon: report the dropped messages of call sites that have been quiet for a while, or of all call sites
+		template<typename Writer>
+		void ReportRepeats(std::int64_t now, bool reportAll, Writer&& write);
+
+		// Daemon: report the previousRepeatCount dropped messages of the call site of the record with the message it wrote
+		// before the record
+		template<typename Writer>
+		void ReportPreviousRepeats(const LogRecord& record, Writer&& write);
+
+	private:
+		struct CallSite
+		{
+			std::atomic<const char*> format;					// the key: the address of the format string, nullptr if the slot is free
+			std::atomic<std::int64_t> theoreticalArrival;		// nanoseconds, state of the token bucket
+			std::atomic<std::int64_t> lastWrittenTime;			// nanoseconds, time of the last written message
+			std::atomic<std::uint64_t> lastHash;				// hash of the arguments of the last written message
+			std::atomic<std::uint32_t> dropped;					// number of messages dropped since the last written message
+		};
+
+		struct WrittenMessage
+		{
+			LogRecord record;
+			std::string threadName;
+		};
+
+		struct Limit
+		{
+			std::atomic<std::int64_t> interval;					// nanoseconds between two messages, 0 if unlimited
+			std::atomic<std::int64_t> tolerance;				// how far the theoretical arrival time may run ahead of now
+			std::atomic<std::int64_t> deduplicationWindow;		// nanoseconds, 0 if disabled
+		};
+
+		CallSite* FindCallSite(const char* format, bool insert);
+		static std::uint64_t HashArguments(const LogRecord& record);
+		void UpdateActiveSeverities();
+
+	private:
+		CallSite callSites[maxCallSites];						// open addressing, call sites are never removed
+		Limit limits[SeverityType::config + 1];					// token bucket and deduplication parameters of each severity
+		std::atomic<unsigned int> activeSeverities;				// bit mask of the severities that are limited or deduplicated
+
+		// Daemon-only
+		std::unique_ptr<WrittenMessage[]> writtenMessages;		// the last written message of each call site, allocated on first use
+	};
+
+	template<typename Writer>
+	void LogRateLimiter::ReportRepeats(std::int64_t now, bool reportAll, Writer&& write)
+	{
+		if (!writtenMessages)
+		{
+			return;
+		}
+
+		for (std::size_t i = 0; i < maxCallSites; i++)
+		{
+			CallSite& site = callSites[i];
+			WrittenMessage& message = writtenMessages[i];
+			if (message.record.format == nullptr || site.dropped.load(std::memory_order_relaxed) == 0)
+			{
+				continue;
+			}
+
+			// a call site is quiet once its deduplication window, or at least one second, has passed without a written message
+			std::int64_t quietTime = limits[message.record.severity].deduplicationWindow.load(std::memory_order_relaxed);
+			if (quietTime < 1000000000)
+			{
+				quietTime = 1000000000;
+			}
+			if (!reportAll && now - site.lastWrittenTime.load(std::memory_order_relaxed) < quietTime)
+			{
+				continue;
+			}
+
+			// the exchange makes sure that the producers and the daemon never report the same dropped messages twice
+			std::uint32_t dropped = site.dropped.exchange(0, std::memory_order_relaxed);
+			if (dropped > 0)
+			{
+				LogRecord& record = message.record;
+				record.timestamp = now;
+				record.repeatCount = dropped;
+				write(static_cast<const LogRecord&>(record), static_cast<const std::string&>(message.threadName));
+			}
+		}
+	}
+
+	template<typename Writer>
+	void LogRateLimiter::ReportPreviousRepeats(const LogRecord& record, Writer&& write)
+	{
+		CallSite* site = FindCallSite(record.format, false);
+		if (site == nullptr || !writtenMessages)
+		{
+			return;
+		}
+
+		// the previous message was only remembered if it went to the daemon
+		WrittenMessage& message = writtenMessages[site - callSites];
+		if (message.record.format == nullptr)
+		{
+			return;
+		}
+
+		LogRecord& previous = message.record;
+		previous.timestamp = record.timestamp;
+		previous.repeatCount = record.previousRepeatCount;
+		previous.previousRepeatCount = 0;
+		write(static_cast<const LogRecord&>(previous), static_cast<const std::string&>(message.threadName));
+	}
+}
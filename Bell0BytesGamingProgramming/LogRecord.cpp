@@ -0,0 +1,355 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* LogRecord.cpp
+*
+* Binary log records: severity definitions, argument encoding and the formatter used by the logging daemon
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C includes
+#include <ctime>			// local time
+#include <cstdio>			// snprintf
+
+// Project includes
+#include "LogRecord.h"
+
+#pragma endregion
+
+namespace util
+{
+	void LogArgumentEncoder::AddRaw(LogArgumentType type, const void* data, std::size_t size)
+	{
+		if (record.argumentSize + 1 + size > LogRecord::argumentCapacity)
+		{
+			return;
+		}
+
+		char* out = record.arguments + record.argumentSize;
+		out[0] = static_cast<char>(type);
+		std::memcpy(out + 1, data, size);
+		record.argumentSize = static_cast<std::uint16_t>(record.argumentSize + 1 + size);
+	}
+
+	void LogArgumentEncoder::AddString(const char* data, std::size_t length)
+	{
+		const std::size_t header = 1 + sizeof(std::uint16_t);
+		if (record.argumentSize + header > LogRecord::argumentCapacity)
+		{
+			return;
+		}
+
+		// truncate strings that do not fit into the record, and mark them as truncated if there is room for the mark
+		static const char mark[] = "...";
+		const std::size_t markLength = sizeof(mark) - 1;
+		std::size_t available = LogRecord::argumentCapacity - record.argumentSize - header;
+		std::uint16_t n = static_cast<std::uint16_t>(length < available ? length : available);
+		const std::size_t copied = n < length && n >= markLength ? n - markLength : n;
+
+		char* out = record.arguments + record.argumentSize;
+		out[0] = static_cast<char>(LogArgumentType::string);
+		std::memcpy(out + 1, &n, sizeof(n));
+		std::memcpy(out + header, data, copied);
+		std::memcpy(out + header + copied, mark, n - copied);
+		record.argumentSize = static_cast<std::uint16_t>(record.argumentSize + header + n);
+	}
+
+	LogFormatter::LogFormatter() :
+		cachedSecond(-1),
+		cachedTime(),
+		cachedTimeLength(0)
+	{
+	}
+
+	void LogFormatter::AppendHeader(std::string& line, unsigned int lineNumber, const LogRecord& record, const std::string& threadName)
+	{
+		// Log header: log#: MM/dd/yyyy hh:mm:ss
+		std::int64_t second = record.timestamp / 1000000000;
+		if (record.timestamp < 0 && record.timestamp % 1000000000 != 0)
+		{
+			second--;
+		}
+		if (second != cachedSecond)
+		{
+			std::time_t time = static_cast<std::time_t>(second);
+			std::tm localTime = {};
+#ifdef _WIN32
+			localtime_s(&localTime, &time);
+#else
+			localtime_r(&time, &localTime);
+#endif
+			int n = std::snprintf(cachedTime, sizeof(cachedTime), "%d/%d/%d %d:%d:%d", localTime.tm_mon + 1, localTime.tm_mday, localTime.tm_year + 1900, localTime.tm_hour, localTime.tm_min, localTime.tm_sec);
+			cachedTimeLength = n > 0 ? static_cast<std::size_t>(n) : 0;
+			cachedSecond = second;
+		}
+
+		AppendUnsigned(line, lineNumber);
+		line += ": ";
+		line.append(cachedTime, cachedTimeLength);
+		line += '\t';
+
+		// Log warning level
+		line += GetSeverityLabel(record.severity);
+
+		// Log thread name
+		line += threadName;
+		line += ":\t";
+	}
+
+	void LogFormatter::AppendMessage(std::string& line, const LogRecord& record)
+	{
+		const char* argument = record.arguments;
+		std::size_t remainingBytes = record.argumentSize;
+
+		for (const char* c = record.format; *c != '\0'; c++)
+		{
+			if (*c == '{')
+			{
+				// find the end of the placeholder, its name is only of interest to structured log policies
+				const char* end = c + 1;
+				while (*end != '\0' && *end != '}')
+				{
+					end++;
+				}
+
+				if (*end == '}' && remainingBytes > 0)
+				{
+					std::size_t used = AppendArgument(line, argument, remainingBytes);
+					if (used > 0)
+					{
+						argument += used;
+						remainingBytes -= used;
+						c = end;
+						continue;
+					}
+				}
+			}
+			line += *c;
+		}
+
+		if (record.repeatCount > 0)
+		{
+			line += " (repeated ";
+			AppendUnsigned(line, record.repeatCount);
+			line += " times)";
+		}
+	}
+
+	std::size_t LogFormatter::DecodeArgument(const char* argument, std::size_t remainingBytes, LogArgument& decoded)
+	{
+		const char* value = argument + 1;
+		decoded.type = static_cast<LogArgumentType>(argument[0]);
+		decoded.text = nullptr;
+		decoded.length = 0;
+		switch (decoded.type)
+		{
+		case LogArgumentType::signedInteger:
+			if (remainingBytes < 1 + sizeof(std::int64_t))
+			{
+				return 0;
+			}
+			std::memcpy(&decoded.signedInteger, value, sizeof(std::int64_t));
+			return 1 + sizeof(std::int64_t);
+
+		case LogArgumentType::unsignedInteger:
+			if (remainingBytes < 1 + sizeof(std::uint64_t))
+			{
+				return 0;
+			}
+			std::memcpy(&decoded.unsignedInteger, value, sizeof(std::uint64_t));
+			return 1 + sizeof(std::uint64_t);
+
+		case LogArgumentType::floatingPoint:
+			if (remainingBytes < 1 + sizeof(double))
+			{
+				return 0;
+			}
+			std::memcpy(&decoded.floatingPoint, value, sizeof(double));
+			return 1 + sizeof(double);
+
+		case LogArgumentType::boolean:
+			if (remainingBytes < 2)
+			{
+				return 0;
+			}
+			decoded.boolean = value[0] != 0;
+			return 2;
+
+		case LogArgumentType::character:
+			if (remainingBytes < 2)
+			{
+				return 0;
+			}
+			decoded.character = value[0];
+			return 2;
+
+		case LogArgumentType::string:
+		{
+			if (remainingBytes < 1 + sizeof(std::uint16_t))
+			{
+				return 0;
+			}
+			std::uint16_t n;
+			std::memcpy(&n, value, sizeof(n));
+			if (remainingBytes < 1 + sizeof(n) + n)
+			{
+				return 0;
+			}
+			decoded.text = value + sizeof(n);
+			decoded.length = n;
+			return 1 + sizeof(n) + n;
+		}
+
+		default:
+			return 0;
+		}
+	}
+
+	std::size_t LogFormatter::AppendArgument(std::string& line, const char* argument, std::size_t remainingBytes)
+	{
+		LogArgument decoded;
+		const std::size_t used = DecodeArgument(argument, remainingBytes, decoded);
+		if (used == 0)
+		{
+			return 0;
+		}
+
+		switch (decoded.type)
+		{
+		case LogArgumentType::signedInteger:
+			AppendSigned(line, decoded.signedInteger);
+			break;
+
+		case LogArgumentType::unsignedInteger:
+			AppendUnsigned(line, decoded.unsignedInteger);
+			break;
+
+		case LogArgumentType::floatingPoint:
+		{
+			// same output as a std::stringstream with its default precision
+			char buffer[32];
+			int n = std::snprintf(buffer, sizeof(buffer), "%g", decoded.floatingPoint);
+			if (n > 0)
+			{
+				line.append(buffer, static_cast<std::size_t>(n));
+			}
+			break;
+		}
+
+		case LogArgumentType::boolean:
+			line += decoded.boolean ? '1' : '0';
+			break;
+
+		case LogArgumentType::character:
+			line += decoded.character;
+			break;
+
+		case LogArgumentType::string:
+			line.append(decoded.text, decoded.length);
+			break;
+		}
+		return used;
+	}
+
+	std::size_t LogFormatter::FormatUnsigned(std::uint64_t value, char* text)
+	{
+		// the digits come out backwards
+		char digits[maxDigits];
+		std::size_t n = 0;
+		do
+		{
+			digits[n++] = static_cast<char>('0' + value % 10);
+			value /= 10;
+		} while (value != 0);
+
+		for (std::size_t i = 0; i < n; i++)
+		{
+			text[i] = digits[n - 1 - i];
+		}
+		return n;
+	}
+
+	void LogFormatter::AppendUnsigned(std::string& line, std::uint64_t value)
+	{
+		char text[maxDigits];
+		line.append(text, FormatUnsigned(value, text));
+	}
+
+	void LogFormatter::AppendSigned(std::string& line, std::int64_t value)
+	{
+		if (value < 0)
+		{
+			line += '-';
+			AppendUnsigned(line, 0 - static_cast<std::uint64_t>(value));
+		}
+		else
+		{
+			AppendUnsigned(line, static_cast<std::uint64_t>(value));
+		}
+	}
+
+	const char* LogFormatter::GetSeverityLabel(SeverityType severity)
+	{
+		switch (severity)
+		{
+		case SeverityType::info:
+			return "INFO:    ";
+		case SeverityType::debug:
+			return "DEBUG:   ";
+		case SeverityType::warning:
+			return "WARNING: ";
+		case SeverityType::error:
+			return "ERROR:   ";
+		default:
+			return "";
+		}
+	}
+
+	const char* LogFormatter::GetSeverityName(SeverityType severity)
+	{
+		switch (severity)
+		{
+		case SeverityType::debug:
+			return "debug";
+		case SeverityType::info:
+			return "info";
+		case SeverityType::warning:
+			return "warning";
+		case SeverityType::error:
+			return "error";
+		case SeverityType::config:
+			return "config";
+		default:
+			return "";
+		}
+	}
+
+	bool LogFormatter::ParseSeverity(const std::string& name, SeverityType& severity)
+	{
+		if (name == "debug")
+		{
+			severity = SeverityType::debug;
+		}
+		else if (name == "info")
+		{
+			severity = SeverityType::info;
+		}
+		else if (name == "warning")
+		{
+			severity = SeverityType::warning;
+		}
+		else if (name == "error")
+		{
+			severity = SeverityType::error;
+		}
+		else
+		{
+			return false;
+		}
+		return true;
+	}
+}
@@ -0,0 +1,185 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* LogRecord.h
+*
+* Binary log records: severity definitions, argument encoding and the formatter used by the logging daemon
+*
+* A log call only stores the address of its format string (the format string id), a timestamp and the raw bytes of its
+* arguments in a fixed-size record. Turning a record into text is left to the logging daemon.
+*
+* Format strings use {} as placeholders, a placeholder may carry a name, i.e. "resolution: {width} x {height}".
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <cstring>			// std::memcpy, std::strlen
+#include <string>			// strings
+#include <thread>			// std::thread::id
+#include <type_traits>		// std::enable_if
+
+#pragma endregion
+
+namespace util
+{
+	// Log levels, ordered by importance
+	enum SeverityType
+	{
+		debug = 0,
+		info,
+		warning,
+		error,
+		config,
+	};
+
+	// Type tags of encoded arguments
+	enum class LogArgumentType : std::uint8_t
+	{
+		signedInteger,		// std::int64_t
+		unsignedInteger,	// std::uint64_t
+		floatingPoint,		// double
+		boolean,			// std::uint8_t
+		character,			// char
+		string,				// std::uint16_t length followed by the characters, not null-terminated
+	};
+
+	// A decoded argument; a string points into the record it was decoded from
+	struct LogArgument
+	{
+		LogArgumentType type;
+		union
+		{
+			std::int64_t signedInteger;
+			std::uint64_t unsignedInteger;
+			double floatingPoint;
+			bool boolean;
+			char character;
+		};
+		const char* text;							// the characters of a string, not null-terminated
+		std::size_t length;							// the number of characters of a string
+	};
+
+	// A single log message as it travels from the producer to the logging daemon
+	struct LogRecord
+	{
+		static constexpr std::size_t argumentCapacity = 464;
+		static constexpr std::size_t maxStringLength = argumentCapacity - 1 - sizeof(std::uint16_t);	// of a string that is the only argument
+
+		const char* format;							// format string id: the address of a string literal, never copied
+		std::int64_t timestamp;						// nanoseconds since the epoch (system clock)
+		std::thread::id threadId;					// the thread that logged the message
+		SeverityType severity;						// the log level
+		std::uint32_t repeatCount;					// number of messages of the same call site dropped before this one
+		std::uint32_t previousRepeatCount;			// dropped repeats of the previous message of the call site, reported first
+		std::uint16_t argumentSize;					// number of used bytes in arguments
+		char arguments[argumentCapacity];			// encoded arguments: type tag followed by the raw value
+	};
+
+	// Copies a record without touching the unused part of its arguments
+	inline void CopyLogRecord(LogRecord& to, const LogRecord& from)
+	{
+		to.format = from.format;
+		to.timestamp = from.timestamp;
+		to.threadId = from.threadId;
+		to.severity = from.severity;
+		to.repeatCount = from.repeatCount;
+		to.previousRepeatCount = from.previousRepeatCount;
+		to.argumentSize = from.argumentSize;
+		std::memcpy(to.arguments, from.arguments, from.argumentSize);
+	}
+
+	// Copies arguments into a log record; arguments that do not fit are dropped, strings are truncated and end with "..."
+	class LogArgumentEncoder
+	{
+	public:
+		explicit LogArgumentEncoder(LogRecord& record) : record(record) { record.argumentSize = 0; };
+
+		void Encode() {};
+
+		template<typename T, typename... Rest>
+		void Encode(const T& first, const Rest&... rest)
+		{
+			Add(first);
+			Encode(rest...);
+		}
+
+	private:
+		void Add(bool value) { std::uint8_t b = value ? 1 : 0; AddRaw(LogArgumentType::boolean, &b, sizeof(b)); };
+		void Add(char value) { AddRaw(LogArgumentType::character, &value, sizeof(value)); };
+		void Add(double value) { AddRaw(LogArgumentType::floatingPoint, &value, sizeof(value)); };
+		void Add(float value) { Add(static_cast<double>(value)); };
+		void Add(const char* value) { AddString(value, value ? std::strlen(value) : 0); };
+		void Add(const std::string& value) { AddString(value.data(), value.size()); };
+
+		template<typename T>
+		typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type Add(T value)
+		{
+			std::int64_t v = value;
+			AddRaw(LogArgumentType::signedInteger, &v, sizeof(v));
+		}
+
+		template<typename T>
+		typename std::enable_if<std::is_integral<T>::value && !std::is_signed<T>::value>::type Add(T value)
+		{
+			std::uint64_t v = value;
+			AddRaw(LogArgumentType::unsignedInteger, &v, sizeof(v));
+		}
+
+		template<typename T>
+		typename std::enable_if<std::is_enum<T>::value>::type Add(T value)
+		{
+			Add(static_cast<typename std::underlying_type<T>::type>(value));
+		}
+
+		void AddRaw(LogArgumentType type, const void* data, std::size_t size);
+		void AddString(const char* data, std::size_t length);
+
+	private:
+		LogRecord& record;
+	};
+
+	// Turns log records into text; every log sink owns its own formatter
+	class LogFormatter
+	{
+	public:
+		LogFormatter();
+
+		// Appends the header "log#: M/d/yyyy h:m:s\tSEVERITY: thread:\t"
+		void AppendHeader(std::string& line, unsigned int lineNumber, const LogRecord& record, const std::string& threadName);
+
+		// Appends the message, substituting the placeholders of the format string with the decoded arguments, and " (repeated N times)"
+		static void AppendMessage(std::string& line, const LogRecord& record);
+
+		// Decodes a single argument; returns the number of bytes it occupies in the record, or 0 if it is corrupt. It does
+		// not allocate, thus the crash writer uses it too
+		static std::size_t DecodeArgument(const char* argument, std::size_t remainingBytes, LogArgument& decoded);
+
+		// Appends the text of a single argument; returns the number of bytes it occupies in the record, or 0 if it is corrupt
+		static std::size_t AppendArgument(std::string& line, const char* argument, std::size_t remainingBytes);
+
+		// Integers in decimal without going through a stream; FormatUnsigned writes at most maxDigits characters and
+		// returns their number, it does not allocate, thus the crash writer uses it too
+		static constexpr std::size_t maxDigits = 20;
+		static std::size_t FormatUnsigned(std::uint64_t value, char* text);
+		static void AppendUnsigned(std::string& line, std::uint64_t value);
+		static void AppendSigned(std::string& line, std::int64_t value);
+
+		static const char* GetSeverityLabel(SeverityType severity);		// "INFO:    ", padded for the text log
+		static const char* GetSeverityName(SeverityType severity);		// "info", as used by the configuration and structured logs
+
+		// Converts "debug", "info", "warning" or "error" to a severity; returns false if the name is unknown
+		static bool ParseSeverity(const std::string& name, SeverityType& severity);
+
+	private:
+		std::int64_t cachedSecond;					// the second the cached time string was rendered for
+		char cachedTime[32];						// "M/d/yyyy h:m:s", the local time is only computed once per second
+		std::size_t cachedTimeLength;
+	};
+}
@@ -0,0 +1,309 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* MappedFileLogPolicy.cpp
+*
+* Log policy writing into a memory-mapped, preallocated file region, with size and session based rotation
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C includes
+#include <cstring>			// std::memcpy
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <cstdio>			// std::rename, std::remove
+#include <fcntl.h>			// open
+#include <sys/mman.h>		// mmap
+#include <unistd.h>			// ftruncate, close
+#endif
+
+// Project includes
+#include "MappedFileLogPolicy.h"
+#include "StringConverter.h"
+
+#pragma endregion
+
+namespace util
+{
+	namespace
+	{
+		// Renames a file, replacing the destination if it exists; missing source files are ignored
+		void ReplaceFile(const std::wstring& from, const std::wstring& to)
+		{
+#ifdef _WIN32
+			MoveFileExW(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING);
+#else
+			std::rename(StringConverter::ws2s(from).c_str(), StringConverter::ws2s(to).c_str());
+#endif
+		}
+
+		void DeleteLogFile(const std::wstring& filename)
+		{
+#ifdef _WIN32
+			DeleteFileW(filename.c_str());
+#else
+			std::remove(StringConverter::ws2s(filename).c_str());
+#endif
+		}
+	}
+
+	MappedFileLogPolicy::MappedFileLogPolicy(std::size_t maxFileSize, unsigned int maxOldFiles) :
+		filename(),
+		maxFileSize(maxFileSize > 0 ? maxFileSize : defaultMaxFileSize),
+		maxOldFiles(maxOldFiles),
+		view(nullptr),
+		mappedSize(0),
+		writtenSize(0),
+		droppedLines(0),
+#ifdef _WIN32
+		fileHandle(nullptr),
+		mappingHandle(nullptr)
+#else
+		fileDescriptor(-1)
+#endif
+	{
+	}
+
+	MappedFileLogPolicy::~MappedFileLogPolicy()
+	{
+		CloseOutputStream();
+	}
+
+	bool MappedFileLogPolicy::OpenOutputStream(const std::wstring& filename)
+	{
+		CloseOutputStream();
+
+		// each session starts with a new file
+		this->filename = filename;
+		RotateFiles();
+		return OpenFile();
+	}
+
+	void MappedFileLogPolicy::CloseOutputStream()
+	{
+		CloseFile();
+	}
+
+	void MappedFileLogPolicy::Write(const std::string& msg)
+	{
+		const std::size_t size = msg.size() + 1;
+#ifdef _WIN32
+		const bool isFileOpen = fileHandle != nullptr;
+#else
+		const bool isFileOpen = fileDescriptor >= 0;
+#endif
+		if (!isFileOpen)
+		{
+			droppedLines.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		if (writtenSize + size > mappedSize)
+		{
+			// start a new file once the current one is full; a single oversized line still gets a file of its own
+			if (writtenSize > 0 && writtenSize + size > maxFileSize)
+			{
+				CloseFile();
+				RotateFiles();
+				if (!OpenFile())
+				{
+					droppedLines.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+
+			// extend the mapped region, but never beyond the maximum file size unless the line does not fit otherwise
+			if (writtenSize + size > mappedSize)
+			{
+				std::size_t newSize = mappedSize;
+				while (newSize < writtenSize + size)
+				{
+					newSize += growthSize;
+				}
+				if (newSize > maxFileSize && writtenSize + size <= maxFileSize)
+				{
+					newSize = maxFileSize;
+				}
+
+				// Map unmaps first: if the larger region cannot be mapped, map the previous one again; if even that fails, nothing
+				// is mapped and the next line tries again
+				const std::size_t previousSize = mappedSize;
+				if (!Map(newSize))
+				{
+					if (previousSize > 0)
+					{
+						Map(previousSize);
+					}
+					droppedLines.fetch_add(1, std::memory_order_relaxed);
+					return;
+				}
+			}
+		}
+
+		std::memcpy(view + writtenSize, msg.data(), msg.size());
+		view[writtenSize + msg.size()] = '\n';
+		writtenSize += size;
+	}
+
+	void MappedFileLogPolicy::Flush()
+	{
+		if (view == nullptr || writtenSize == 0)
+		{
+			return;
+		}
+
+		// start writing the dirty pages back without waiting for the disk
+#ifdef _WIN32
+		FlushViewOfFile(view, writtenSize);
+#else
+		msync(view, writtenSize, MS_ASYNC);
+#endif
+	}
+
+	bool MappedFileLogPolicy::OpenFile()
+	{
+#ifdef _WIN32
+		HANDLE file = CreateFileW(filename.c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, NULL, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE)
+		{
+			return false;
+		}
+		fileHandle = file;
+#else
+		fileDescriptor = open(StringConverter::ws2s(filename).c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+		if (fileDescriptor < 0)
+		{
+			return false;
+		}
+#endif
+
+		writtenSize = 0;
+		mappedSize = 0;
+		if (!Map(growthSize < maxFileSize ? growthSize : maxFileSize))
+		{
+			CloseFile();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFileLogPolicy::CloseFile()
+	{
+		Unmap();
+
+		// cut off the preallocated but unused part of the file
+#ifdef _WIN32
+		if (fileHandle != nullptr)
+		{
+			LARGE_INTEGER size;
+			size.QuadPart = static_cast<LONGLONG>(writtenSize);
+			SetFilePointerEx(fileHandle, size, NULL, FILE_BEGIN);
+			SetEndOfFile(fileHandle);
+			CloseHandle(fileHandle);
+			fileHandle = nullptr;
+		}
+#else
+		if (fileDescriptor >= 0)
+		{
+			if (ftruncate(fileDescriptor, static_cast<off_t>(writtenSize)) != 0)
+			{
+				// the file keeps its trailing zeros
+			}
+			close(fileDescriptor);
+			fileDescriptor = -1;
+		}
+#endif
+		writtenSize = 0;
+	}
+
+	bool MappedFileLogPolicy::Map(std::size_t size)
+	{
+		Unmap();
+
+#ifdef _WIN32
+		// creating the mapping object extends the file to the requested size
+		unsigned long long size64 = size;
+		mappingHandle = CreateFileMappingW(fileHandle, NULL, PAGE_READWRITE, static_cast<DWORD>(size64 >> 32), static_cast<DWORD>(size64 & 0xFFFFFFFF), NULL);
+		if (mappingHandle == nullptr)
+		{
+			return false;
+		}
+		view = static_cast<char*>(MapViewOfFile(mappingHandle, FILE_MAP_WRITE, 0, 0, size));
+		if (view == nullptr)
+		{
+			CloseHandle(mappingHandle);
+			mappingHandle = nullptr;
+			return false;
+		}
+#else
+		if (ftruncate(fileDescriptor, static_cast<off_t>(size)) != 0)
+		{
+			return false;
+		}
+		void* address = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, 0);
+		if (address == MAP_FAILED)
+		{
+			return false;
+		}
+		view = static_cast<char*>(address);
+#endif
+
+		mappedSize = size;
+		return true;
+	}
+
+	void MappedFileLogPolicy::Unmap()
+	{
+#ifdef _WIN32
+		if (view != nullptr)
+		{
+			UnmapViewOfFile(view);
+		}
+		if (mappingHandle != nullptr)
+		{
+			CloseHandle(mappingHandle);
+			mappingHandle = nullptr;
+		}
+#else
+		if (view != nullptr)
+		{
+			munmap(view, mappedSize);
+		}
+#endif
+		view = nullptr;
+		mappedSize = 0;
+	}
+
+	void MappedFileLogPolicy::RotateFiles()
+	{
+		if (maxOldFiles == 0)
+		{
+			DeleteLogFile(filename);
+			return;
+		}
+
+		// logfile.4.log -> logfile.5.log, ..., logfile.log -> logfile.1.log; renaming replaces the oldest file
+		for (unsigned int i = maxOldFiles; i > 0; i--)
+		{
+			ReplaceFile(i == 1 ? filename : GetRotatedName(i - 1), GetRotatedName(i));
+		}
+	}
+
+	std::wstring MappedFileLogPolicy::GetRotatedName(unsigned int index) const
+	{
+		// insert the index in front of the extension, if the file name has one
+		std::size_t separator = filename.find_last_of(L"\\/");
+		std::size_t dot = filename.find_last_of(L'.');
+		if (dot == std::wstring::npos || (separator != std::wstring::npos && dot < separator))
+		{
+			dot = filename.size();
+		}
+		return filename.substr(0, dot) + L"." + std::to_wstring(index) + filename.substr(dot);
+	}
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* MappedFileLogPolicy.h
+*
+* Log policy writing into a memory-mapped, preallocated file region, with size and session based rotation
+*
+* Lines are copied straight into the mapped pages, thus writing a line does not cost a system call. The operating system
+* writes the pages back on its own; Flush() only starts an asynchronous write-back of the pages written so far.
+* The pages belong to the operating system, thus nothing written to them is lost if the process crashes.
+*
+* Rotation: logfile.log -> logfile.1.log -> logfile.2.log -> ..., the oldest file is deleted.
+* The files are rotated once per session, when the policy is opened, and whenever the current file reaches its maximum size.
+*
+* If the file cannot grow, the region mapped so far stays mapped and the lines that do not fit are dropped and counted;
+* the next line tries to grow the file again.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include "Log.h"
+
+#pragma endregion
+
+namespace util
+{
+	class MappedFileLogPolicy : public LogPolicyInterface
+	{
+	public:
+		static const std::size_t defaultMaxFileSize = 8 * 1024 * 1024;	// 8 MB
+		static const unsigned int defaultMaxOldFiles = 5;
+		static const std::size_t growthSize = 1024 * 1024;				// the file is extended and remapped in steps of 1 MB
+
+		MappedFileLogPolicy(std::size_t maxFileSize = defaultMaxFileSize, unsigned int maxOldFiles = defaultMaxOldFiles);
+		~MappedFileLogPolicy();
+
+		MappedFileLogPolicy(const MappedFileLogPolicy&) = delete;
+		MappedFileLogPolicy& operator=(const MappedFileLogPolicy&) = delete;
+
+		bool OpenOutputStream(const std::wstring& filename) override;	// rotates the files of the previous sessions
+		void CloseOutputStream() override;								// unmaps the file and cuts it to the size actually written
+		void Write(const std::string& msg) override;
+		void Flush() override;
+
+		// Lines that could not be written because the file could not be opened or grown
+		unsigned long long GetDroppedLineCount() const { return droppedLines.load(std::memory_order_relaxed); };
+
+	private:
+		bool OpenFile();												// create a new, empty file and map its first region
+		void CloseFile();
+		bool Map(std::size_t size);										// extend the file to the given size and map all of it
+		void Unmap();
+		void RotateFiles();												// shift every file one index up, the oldest one is deleted
+		std::wstring GetRotatedName(unsigned int index) const;			// logfile.log -> logfile.<index>.log
+
+	private:
+		std::wstring filename;				// the name of the current log file
+		const std::size_t maxFileSize;		// size at which the file is rotated
+		const unsigned int maxOldFiles;		// number of rotated files that are kept
+		char* view;							// the mapped region of the file
+		std::size_t mappedSize;				// size of the mapped region
+		std::size_t writtenSize;			// number of bytes written to the mapped region
+		std::atomic<unsigned long long> droppedLines;
+#ifdef _WIN32
+		void* fileHandle;					// HANDLE of the file
+		void* mappingHandle;				// HANDLE of the file mapping object
+#else
+		int fileDescriptor;
+#endif
+	};
+}
@@ -0,0 +1,214 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* PipelinedLoop.cpp
+*
+* Runs the fixed time step on a simulation thread while the main thread renders
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::min, std::max
+#include <stdexcept>		// std::runtime_error
+
+// Project includes
+#include "PipelinedLoop.h"
+#include "FramePacer.h"
+#include "Profiler.h"
+#include "ServiceLocator.h"
+
+#pragma endregion
+
+namespace core
+{
+	namespace
+	{
+		const double maximumFarseer = 1.0;		// a late snapshot is not predicted further than a step
+	}
+
+	PipelinedLoop::PipelinedLoop(const ClockSource& clock, double dt, int maxSkipFrames, CatchUpPolicyType policyType) :
+		clock(clock),
+		secondsPerCount(clock.GetSecondsPerCount()),
+		loop(dt, maxSkipFrames, policyType),
+		snapshots(),
+		isRunning(false),
+		isPaused(false),
+		hasFailed(false),
+		failure(0),
+		published(0),
+		gameTime(0.0),
+		updateTime(0.0),
+		lastFrame(),
+		renderedSnapshot()
+	{
+		loop.SetCostClock(&clock);
+	}
+
+	PipelinedLoop::~PipelinedLoop()
+	{
+		Stop();
+	}
+
+	void PipelinedLoop::Start(UpdateFunction update, SnapshotFunction writeSnapshot)
+	{
+		if (simulationThread.joinable())
+		{
+			throw std::runtime_error("The pipelined loop is already running!");
+		}
+
+		this->update = std::move(update);
+		this->writeSnapshot = std::move(writeSnapshot);
+		loop.Reset();
+		published = 0;
+		gameTime = 0.0;
+		updateTime = 0.0;
+		hasFailed.store(false, std::memory_order_relaxed);
+		failure = 0;
+
+		// the main thread renders the initial state until the first updates are done
+		PublishSnapshot(clock.GetCounts());
+		snapshots.Acquire();
+		renderedSnapshot = snapshots.GetReadBuffer();
+		lastFrame = PipelinedFrame();
+
+		isPaused.store(false, std::memory_order_relaxed);
+		isRunning.store(true, std::memory_order_release);
+		simulationThread = std::thread(&PipelinedLoop::Simulate, this);
+	}
+
+	util::Expected<int> PipelinedLoop::Stop()
+	{
+		if (simulationThread.joinable())
+		{
+			{
+				std::lock_guard<std::mutex> lock(pauseMutex);
+				isRunning.store(false, std::memory_order_release);
+			}
+			pauseCondition.notify_all();
+			simulationThread.join();
+		}
+
+		return failure;
+	}
+
+	void PipelinedLoop::Pause()
+	{
+		isPaused.store(true, std::memory_order_release);
+	}
+
+	void PipelinedLoop::Resume()
+	{
+		if (isPaused.load(std::memory_order_relaxed))
+		{
+			{
+				std::lock_guard<std::mutex> lock(pauseMutex);
+				isPaused.store(false, std::memory_order_release);
+			}
+			pauseCondition.notify_all();
+		}
+	}
+
+	bool PipelinedLoop::AcquireSnapshot()
+	{
+		lastFrame.isNewSnapshot = snapshots.Acquire();
+		const SimulationSnapshot& snapshot = snapshots.GetReadBuffer();
+
+		if (lastFrame.isNewSnapshot)
+		{
+			// the counters of the snapshots the main thread was too slow to render are included
+			lastFrame.snapshots = snapshot.sequence - renderedSnapshot.sequence;
+			lastFrame.updates = (int)(snapshot.updates - renderedSnapshot.updates);
+			lastFrame.updateTime = snapshot.updateTime - renderedSnapshot.updateTime;
+			lastFrame.hitMaxSkipFrames = snapshot.framesAtMaxSkipFrames > renderedSnapshot.framesAtMaxSkipFrames;
+			renderedSnapshot = snapshot;
+		}
+		else
+		{
+			lastFrame.snapshots = 0;
+			lastFrame.updates = 0;
+			lastFrame.updateTime = 0.0;
+			lastFrame.hitMaxSkipFrames = false;
+		}
+
+		// the real time that passed since the state was current, in steps
+		lastFrame.age = (clock.GetCounts() - snapshot.counts) * secondsPerCount;
+		lastFrame.farseer = std::max(0.0, std::min(lastFrame.age / snapshot.stepTime, maximumFarseer));
+		return lastFrame.isNewSnapshot;
+	}
+
+	void PipelinedLoop::Simulate()
+	{
+#if PROFILER_ENABLED
+		Profiler::SetThreadName("Simulation");
+#endif
+		util::ServiceLocator::GetFileLogger()->SetThreadName("simulation");
+
+		// wake up once per step, the updates of the loop pay for the time that passed in between
+		FramePacer pacer(clock, 1.0 / loop.GetDeltaTime(), FrameWaitMode::hybrid);
+		std::int64_t previousCounts = clock.GetCounts();
+
+		while (isRunning.load(std::memory_order_acquire))
+		{
+			if (isPaused.load(std::memory_order_acquire))
+			{
+				std::unique_lock<std::mutex> lock(pauseMutex);
+				pauseCondition.wait(lock, [this] { return !isPaused.load(std::memory_order_acquire) || !isRunning.load(std::memory_order_acquire); });
+
+				// the pause is not caught up on
+				previousCounts = clock.GetCounts();
+				pacer.Restart();
+				continue;
+			}
+
+			const std::int64_t now = clock.GetCounts();
+			const double elapsedTime = (now - previousCounts) * secondsPerCount;
+			previousCounts = now;
+
+			util::Expected<int> result = loop.RunFrame(elapsedTime, [this](double stepTime)
+			{
+				util::Expected<int> result = update(stepTime);
+				if (result.isValid())
+				{
+					gameTime += stepTime;
+				}
+				return result;
+			}, [](double) { return util::Expected<int>(0); });
+
+			if (!result.isValid())
+			{
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::error>("An update failed, the simulation thread stops.");
+				failure = result;
+				hasFailed.store(true, std::memory_order_release);
+				return;
+			}
+
+			if (loop.GetLastFrame().updates > 0)
+			{
+				updateTime += loop.GetLastFrame().updateTime;
+				PublishSnapshot(now);
+			}
+
+			pacer.WaitForNextFrame();
+		}
+	}
+
+	void PipelinedLoop::PublishSnapshot(std::int64_t frameCounts)
+	{
+		// the game writes the state into the slot, the stamp goes into the buffer
+		writeSnapshot(snapshots.GetWriteSlot());
+
+		SimulationSnapshot& snapshot = snapshots.GetWriteBuffer();
+		snapshot.sequence = published++;
+		snapshot.gameTime = gameTime;
+		snapshot.stepTime = loop.GetLastFrame().stepTime;
+		snapshot.counts = frameCounts - (std::int64_t)(loop.GetAccumulatedTime() / secondsPerCount);	// the debt has not been simulated yet
+		snapshot.updates = loop.GetUpdateCount();
+		snapshot.updateTime = updateTime;
+		snapshot.framesAtMaxSkipFrames = loop.GetMaxSkipFramesCount();
+		snapshots.Publish();
+	}
+}
@@ -0,0 +1,140 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* PipelinedLoop.h
+*
+* Runs the fixed time step on a simulation thread while the main thread renders: a frame costs max(update, render)
+* rather than their sum
+*
+* The simulation thread wakes up once per delta-t, runs the updates of a FixedStepLoop on the real time, and publishes
+* a snapshot of the state to render: it asks the game to write the state into the back slot of a triple buffer and
+* stamps it with the simulated time and the real time the state belongs to. The main thread acquires the newest
+* snapshot before every frame and renders it, while the next updates already run. Neither thread ever waits for the
+* other: the hand-off is a single atomic exchange on either side.
+*
+* The snapshots themselves live with the game, in arrays of snapshotSlotCount elements indexed by the slot numbers;
+* the slot the main thread renders is never written by the simulation thread.
+*
+* The farseer of the renderer is computed from the stamp of the snapshot: the real time that has passed since the
+* state was current, in steps.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <atomic>			// atomic objects (no data races)
+#include <condition_variable>	// waking up the simulation thread after a pause
+#include <cstdint>			// fixed width integers
+#include <functional>		// std::function
+#include <mutex>			// mutexes
+#include <thread>			// the simulation thread
+
+// Project includes
+#include "ClockSource.h"
+#include "Expected.h"
+#include "FixedStepLoop.h"
+#include "TripleBuffer.h"
+
+#pragma endregion
+
+namespace core
+{
+	// Stamped on every snapshot by the simulation thread, counters since the start of the loop
+	struct SimulationSnapshot
+	{
+		unsigned long long sequence;				// number of snapshots published before this one, the initial state is 0
+		double gameTime;							// simulated time of the state, in seconds
+		double stepTime;							// the length of the steps that led to the state
+		std::int64_t counts;						// clock counts at which the real time was level with the state
+		unsigned long long updates;					// updates run so far
+		double updateTime;							// real time spent updating so far
+		unsigned long long framesAtMaxSkipFrames;	// simulation frames that hit maxSkipFrames so far
+	};
+
+	// What the main thread got for its last frame
+	struct PipelinedFrame
+	{
+		bool isNewSnapshot;				// the snapshot was published since the previous frame
+		unsigned long long snapshots;	// number of snapshots published since the previous frame, including the skipped ones
+		int updates;					// updates run since the previous frame
+		double updateTime;				// real time the simulation thread spent updating since the previous frame
+		bool hitMaxSkipFrames;			// at least one of those simulation frames hit maxSkipFrames
+		double farseer;					// the fraction of a step to predict beyond the snapshot
+		double age;						// real time since the state of the snapshot was current, in seconds
+	};
+
+	class PipelinedLoop
+	{
+	public:
+		typedef std::function<util::Expected<int>(double)> UpdateFunction;		// update(stepTime)
+		typedef std::function<void(unsigned int)> SnapshotFunction;			// writeSnapshot(slot)
+
+		static constexpr unsigned int snapshotSlotCount = util::TripleBuffer<SimulationSnapshot>::slotCount;
+
+		PipelinedLoop(const ClockSource& clock, double dt, int maxSkipFrames, CatchUpPolicyType policyType = CatchUpPolicyType::strict);
+		~PipelinedLoop();
+
+		PipelinedLoop(const PipelinedLoop&) = delete;
+		PipelinedLoop& operator=(const PipelinedLoop&) = delete;
+
+		// Publishes the current state as the first snapshot, on the calling thread, then starts the simulation thread;
+		// throws std::runtime_error if the loop is already running
+		void Start(UpdateFunction update, SnapshotFunction writeSnapshot);
+
+		// Stops and joins the simulation thread; returns the error of the first update that failed, if any
+		util::Expected<int> Stop();
+
+		// The simulation thread sleeps while paused and does not catch up on the pause afterwards
+		void Pause();
+		void Resume();
+
+		// Main thread: switches to the newest snapshot and computes the farseer from its stamp; returns false if no
+		// snapshot was published since the previous frame, the previous one is rendered again
+		bool AcquireSnapshot();
+
+		// Getters, for the main thread
+		const SimulationSnapshot& GetSnapshot() const { return snapshots.GetReadBuffer(); };
+		unsigned int GetSnapshotSlot() const { return snapshots.GetReadSlot(); };
+		const PipelinedFrame& GetLastFrame() const { return lastFrame; };
+		bool IsRunning() const { return simulationThread.joinable(); };
+		bool HasFailed() const { return hasFailed.load(std::memory_order_acquire); };	// an update failed and the simulation thread stopped
+
+		// The fixed time step of the simulation thread; only safe to read while the loop is stopped
+		const FixedStepLoop& GetLoop() const { return loop; };
+
+	private:
+		void Simulate();				// the simulation thread
+		void PublishSnapshot(std::int64_t frameCounts);
+
+	private:
+		const ClockSource& clock;
+		const double secondsPerCount;
+		FixedStepLoop loop;							// the fixed time step, only touched by the simulation thread while it runs
+		util::TripleBuffer<SimulationSnapshot> snapshots;	// the stamps, the game keeps the states in the same slots
+
+		UpdateFunction update;
+		SnapshotFunction writeSnapshot;
+		std::thread simulationThread;
+		std::atomic<bool> isRunning;				// cleared to stop the simulation thread
+		std::atomic<bool> isPaused;
+		std::mutex pauseMutex;						// only locked to pause and resume, never while running
+		std::condition_variable pauseCondition;
+
+		std::atomic<bool> hasFailed;				// set after failure was written
+		util::Expected<int> failure;				// the first error of an update
+
+		// simulation thread
+		unsigned long long published;				// snapshots published so far
+		double gameTime;							// time simulated so far
+		double updateTime;							// real time spent updating so far
+
+		// main thread
+		PipelinedFrame lastFrame;
+		SimulationSnapshot renderedSnapshot;		// the stamp of the snapshot of the previous frame
+	};
+}
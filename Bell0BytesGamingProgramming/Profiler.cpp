@@ -0,0 +1,440 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Profiler.cpp
+*
+* Hierarchical CPU profiler: scoped zones, per-frame call trees and Chrome trace export
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::sort
+#include <fstream>			// file streams
+#include <iomanip>			// output formatting
+#include <memory>			// smart pointers
+#include <mutex>			// lockable objects
+#include <sstream>			// string streams
+
+// Project includes
+#include "Profiler.h"
+#include "StringConverter.h"
+
+#pragma endregion
+
+namespace core
+{
+	namespace
+	{
+		const std::size_t threadBufferCapacity = 16384;		// zones per thread and frame
+
+		std::size_t RoundUpToPowerOfTwo(std::size_t value)
+		{
+			std::size_t power = 1;
+			while (power < value)
+			{
+				power <<= 1;
+			}
+			return power;
+		}
+
+		// the registered threads and the state of the frames, only created once
+		struct ProfilerState
+		{
+			std::mutex mutex;									// guards the buffers and their names
+			std::vector<std::unique_ptr<ProfileThreadBuffer>> buffers;
+			std::uint32_t nextThreadIndex = 0;
+			unsigned long long retiredDropped = 0;				// dropped zones of threads that exited
+
+			// the frames, only used by the thread ending the frames
+			const ClockSource* frameClock = nullptr;			// the clock the frame times were taken with
+			std::int64_t frameStart = 0;
+			ProfileFrame lastFrame = {};
+			ProfileFrame slowestFrame = {};
+			std::vector<ProfileEvent> events;					// scratch space to sort the events of a thread
+
+			// the Chrome trace capture
+			unsigned int captureFramesLeft = 0;
+			std::wstring captureFilename;
+			std::int64_t captureStart = 0;
+			std::ostringstream capture;
+			bool isFirstCaptureEvent = true;
+		};
+
+		ProfilerState& GetState()
+		{
+			static ProfilerState state;
+			return state;
+		}
+
+		thread_local ProfileThreadBuffer* threadBuffer = nullptr;
+		thread_local bool isThreadExiting = false;				// trivially destructible, thus valid in later thread_local destructors
+
+		// marks the buffer of a thread as retired when the thread exits, thus the profiler can release it; the zones of
+		// thread_local destructors that run after this one are not recorded, their buffer may be gone already
+		struct ThreadBufferOwner
+		{
+			ProfileThreadBuffer* buffer = nullptr;
+			~ThreadBufferOwner()
+			{
+				isThreadExiting = true;
+				threadBuffer = nullptr;
+				if (buffer)
+				{
+					buffer->isRetired.store(true, std::memory_order_release);
+				}
+			}
+		};
+
+		thread_local ThreadBufferOwner threadBufferOwner;
+
+		ProfileThreadBuffer* RegisterThread()
+		{
+			if (!threadBuffer && !isThreadExiting)
+			{
+				ProfilerState& state = GetState();
+				std::lock_guard<std::mutex> lock(state.mutex);
+				state.buffers.push_back(std::unique_ptr<ProfileThreadBuffer>(new ProfileThreadBuffer(state.nextThreadIndex++, threadBufferCapacity)));
+				threadBuffer = state.buffers.back().get();
+				threadBufferOwner.buffer = threadBuffer;
+			}
+			return threadBuffer;
+		}
+
+		double ToMilliseconds(std::int64_t counts, double secondsPerCount)
+		{
+			return counts * secondsPerCount * 1000.0;
+		}
+
+		// adds the events of a thread, sorted by start and depth, to a call tree, merging calls of the same zone
+		void BuildCallTree(const std::vector<ProfileEvent>& events, double secondsPerCount, std::vector<ProfileNode>& roots)
+		{
+			// the open zones; every node lives in the children of the node below it, which do not change while it is open
+			std::vector<ProfileNode*> path;
+			path.reserve(ProfileThreadBuffer::maxDepth);
+
+			for (const ProfileEvent& event : events)
+			{
+				// if the parent of a zone was dropped, the zone is added to its closest ancestor
+				while (path.size() > event.depth)
+				{
+					path.pop_back();
+				}
+
+				std::vector<ProfileNode>& siblings = path.empty() ? roots : path.back()->children;
+				auto node = std::find_if(siblings.begin(), siblings.end(), [&event](const ProfileNode& sibling) { return sibling.name == event.name; });
+				if (node == siblings.end())
+				{
+					siblings.push_back(ProfileNode{ event.name, 0, 0.0, 0.0, {} });
+					node = siblings.end() - 1;
+				}
+				node->calls++;
+				node->totalTime += ToMilliseconds(event.end - event.start, secondsPerCount);
+
+				if (path.size() < ProfileThreadBuffer::maxDepth)
+				{
+					path.push_back(&*node);
+				}
+			}
+		}
+
+		void ComputeSelfTimes(std::vector<ProfileNode>& nodes)
+		{
+			for (ProfileNode& node : nodes)
+			{
+				ComputeSelfTimes(node.children);
+				node.selfTime = node.totalTime;
+				for (const ProfileNode& child : node.children)
+				{
+					node.selfTime -= child.totalTime;
+				}
+			}
+		}
+
+		void WriteNodes(std::ostream& out, const std::vector<ProfileNode>& nodes, int indentation)
+		{
+			for (const ProfileNode& node : nodes)
+			{
+				std::string name = std::string(indentation * 2, ' ') + node.name;
+				out << "\t" << std::left << std::setw(48) << name << std::right << std::setw(6) << node.calls << std::setw(12) << node.totalTime << std::setw(12) << node.selfTime << "\n";
+				WriteNodes(out, node.children, indentation + 1);
+			}
+		}
+
+		// zone names are string literals, only quotes and backslashes need escaping
+		void WriteJsonString(std::ostream& out, const char* text)
+		{
+			out << '"';
+			for (; *text; text++)
+			{
+				if (*text == '"' || *text == '\\')
+				{
+					out << '\\';
+				}
+				out << *text;
+			}
+			out << '"';
+		}
+
+		bool OpenFile(std::ofstream& out, const std::wstring& filename)
+		{
+			// only the Microsoft library accepts wide file names
+#ifdef _WIN32
+			out.open(filename.c_str());
+#else
+			out.open(util::StringConverter::ws2s(filename).c_str());
+#endif
+			return out.is_open();
+		}
+
+		void WriteCapture(ProfilerState& state)
+		{
+			std::ofstream out;
+			if (OpenFile(out, state.captureFilename))
+			{
+				out << "{\"traceEvents\":[" << state.capture.str();
+				for (const std::unique_ptr<ProfileThreadBuffer>& buffer : state.buffers)
+				{
+					std::string threadName = buffer->name.empty() ? "Thread " + std::to_string(buffer->threadIndex) : buffer->name;
+					out << (state.isFirstCaptureEvent ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->threadIndex + 1 << ",\"args\":{\"name\":";
+					WriteJsonString(out, threadName.c_str());
+					out << "}}";
+					state.isFirstCaptureEvent = false;
+				}
+				out << "\n],\"displayTimeUnit\":\"ms\"}\n";
+			}
+
+			state.capture.str(std::string());
+			state.capture.clear();
+			state.captureFilename.clear();
+		}
+	}
+
+	std::atomic<const ClockSource*> Profiler::clock(nullptr);
+
+#pragma region "Thread Buffers"
+	ProfileThreadBuffer::ProfileThreadBuffer(std::uint32_t threadIndex, std::size_t capacity) :
+		threadIndex(threadIndex),
+		name(),
+		isRetired(false),
+		dropped(0),
+		events(RoundUpToPowerOfTwo(capacity)),
+		mask(RoundUpToPowerOfTwo(capacity) - 1),
+		head(0),
+		tail(0),
+		depth(0)
+	{
+	}
+
+	std::int64_t ProfileThreadBuffer::BeginZone(const ClockSource& clock)
+	{
+		depth++;
+		return clock.GetCounts();
+	}
+
+	void ProfileThreadBuffer::EndZone(const ClockSource& clock, const char* name, std::int64_t start)
+	{
+		std::int64_t end = clock.GetCounts();
+		depth--;
+
+		std::size_t position = head.load(std::memory_order_relaxed);
+		if (position - tail.load(std::memory_order_acquire) > mask)
+		{
+			dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+
+		events[position & mask] = ProfileEvent{ name, start, end, depth };
+		head.store(position + 1, std::memory_order_release);
+	}
+
+#pragma endregion
+
+#pragma region "Profiler"
+	void Profiler::SetClock(const ClockSource* clock)
+	{
+		Profiler::clock.store(clock, std::memory_order_release);
+	}
+
+	void Profiler::SetThreadName(const std::string& name)
+	{
+		ProfileThreadBuffer* buffer = RegisterThread();
+		if (!buffer)
+		{
+			return;
+		}
+		ProfilerState& state = GetState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		buffer->name = name;
+	}
+
+	ProfileThreadBuffer* Profiler::GetThreadBuffer(const ClockSource*& clock)
+	{
+		clock = Profiler::clock.load(std::memory_order_acquire);
+		if (!clock)
+		{
+			return nullptr;
+		}
+		return threadBuffer || isThreadExiting ? threadBuffer : RegisterThread();
+	}
+
+	void Profiler::EndFrame()
+	{
+		ProfilerState& state = GetState();
+		const ClockSource* clock = Profiler::clock.load(std::memory_order_acquire);
+		if (!clock)
+		{
+			return;
+		}
+		const std::int64_t frameEnd = clock->GetCounts();
+		const double secondsPerCount = clock->GetSecondsPerCount();
+
+		// a new clock starts over: the counts of the old clock can not be compared to the new ones
+		const bool isFirstFrame = clock != state.frameClock;
+		if (isFirstFrame)
+		{
+			state.frameClock = clock;
+			state.frameStart = frameEnd;
+		}
+
+		ProfileFrame& frame = state.lastFrame;
+		frame.index++;
+		frame.duration = ToMilliseconds(frameEnd - state.frameStart, secondsPerCount);
+		frame.threads.clear();
+
+		{
+			std::lock_guard<std::mutex> lock(state.mutex);
+			for (auto buffer = state.buffers.begin(); buffer != state.buffers.end();)
+			{
+				// a retired thread will not write again: drain it one last time, then release it
+				bool isRetired = (*buffer)->isRetired.load(std::memory_order_acquire);
+
+				state.events.clear();
+				(*buffer)->Drain([&state](const ProfileEvent& event) { state.events.push_back(event); });
+
+				if (!isFirstFrame && !state.events.empty())
+				{
+					std::sort(state.events.begin(), state.events.end(), [](const ProfileEvent& a, const ProfileEvent& b) { return a.start < b.start || (a.start == b.start && a.depth < b.depth); });
+
+					ProfileThreadTree thread;
+					thread.threadName = (*buffer)->name.empty() ? "Thread " + std::to_string((*buffer)->threadIndex) : (*buffer)->name;
+					BuildCallTree(state.events, secondsPerCount, thread.roots);
+					ComputeSelfTimes(thread.roots);
+					frame.threads.push_back(std::move(thread));
+
+					if (state.captureFramesLeft > 0)
+					{
+						for (const ProfileEvent& event : state.events)
+						{
+							state.capture << (state.isFirstCaptureEvent ? "\n" : ",\n") << "{\"name\":";
+							WriteJsonString(state.capture, event.name);
+							state.capture << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << (*buffer)->threadIndex + 1 << ",\"ts\":" << ToMilliseconds(event.start - state.captureStart, secondsPerCount) * 1000.0 << ",\"dur\":" << ToMilliseconds(event.end - event.start, secondsPerCount) * 1000.0 << "}";
+							state.isFirstCaptureEvent = false;
+						}
+					}
+				}
+
+				if (isRetired)
+				{
+					state.retiredDropped += (*buffer)->dropped.load(std::memory_order_relaxed);
+					buffer = state.buffers.erase(buffer);
+				}
+				else
+				{
+					buffer++;
+				}
+			}
+
+			if (state.captureFramesLeft > 0 && !isFirstFrame && --state.captureFramesLeft == 0)
+			{
+				WriteCapture(state);
+			}
+		}
+
+		if (!isFirstFrame && frame.duration > state.slowestFrame.duration)
+		{
+			state.slowestFrame = frame;
+		}
+		state.frameStart = frameEnd;
+	}
+
+	void Profiler::CaptureFrames(unsigned int frames, const std::wstring& filename)
+	{
+		ProfilerState& state = GetState();
+		if (state.captureFramesLeft > 0 || frames == 0)
+		{
+			return;
+		}
+
+		state.captureFramesLeft = frames;
+		state.captureFilename = filename;
+		state.captureStart = state.frameStart;
+		state.isFirstCaptureEvent = true;
+		state.capture << std::fixed << std::setprecision(3);
+	}
+
+	bool Profiler::IsCapturing()
+	{
+		return GetState().captureFramesLeft > 0;
+	}
+
+	const ProfileFrame& Profiler::GetLastFrame()
+	{
+		return GetState().lastFrame;
+	}
+
+	const ProfileFrame& Profiler::GetSlowestFrame()
+	{
+		return GetState().slowestFrame;
+	}
+
+	unsigned long long Profiler::GetDroppedZoneCount()
+	{
+		ProfilerState& state = GetState();
+		std::lock_guard<std::mutex> lock(state.mutex);
+		unsigned long long dropped = state.retiredDropped;
+		for (const std::unique_ptr<ProfileThreadBuffer>& buffer : state.buffers)
+		{
+			dropped += buffer->dropped.load(std::memory_order_relaxed);
+		}
+		return dropped;
+	}
+
+	void Profiler::WriteCallTree(std::ostream& out, const ProfileFrame& frame)
+	{
+		const std::ios_base::fmtflags flags = out.flags();
+		const std::streamsize precision = out.precision();
+
+		out << std::fixed << std::setprecision(3);
+		out << "Frame " << frame.index << ": " << frame.duration << " ms\n";
+		for (const ProfileThreadTree& thread : frame.threads)
+		{
+			out << thread.threadName << "\n";
+			out << "\t" << std::left << std::setw(48) << "Zone" << std::right << std::setw(6) << "Calls" << std::setw(12) << "Total (ms)" << std::setw(12) << "Self (ms)" << "\n";
+			WriteNodes(out, thread.roots, 0);
+		}
+
+		out.flags(flags);
+		out.precision(precision);
+	}
+
+	bool Profiler::WriteReport(const std::wstring& filename)
+	{
+		std::ofstream out;
+		if (!OpenFile(out, filename))
+		{
+			return false;
+		}
+
+		out << "Slowest frame\n";
+		WriteCallTree(out, GetSlowestFrame());
+		out << "\nLast frame\n";
+		WriteCallTree(out, GetLastFrame());
+		out << "\nDropped zones: " << GetDroppedZoneCount() << "\n";
+		return out.good();
+	}
+#pragma endregion
+}
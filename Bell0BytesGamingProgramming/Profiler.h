@@ -0,0 +1,196 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Profiler.h
+*
+* Hierarchical CPU profiler: scoped zones, per-frame call trees and Chrome trace export
+*
+* PROFILE_ZONE("name") measures the rest of the enclosing scope with the clock of the game timer; zones nest. Every
+* thread writes its zones into its own lock-free buffer, without locks or allocations. Once per frame, PROFILE_FRAME()
+* drains the buffers of all threads and aggregates their zones into a call tree of the frame.
+*
+* A capture of the next frames can be written in the Chrome trace event format, to be viewed in chrome://tracing or
+* https://ui.perfetto.dev.
+*
+* Zone names must be string literals: only their address is stored.
+*
+* The zones compile out entirely unless PROFILER_ENABLED is 1; by default, it is only enabled in debug builds.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <atomic>			// atomic objects (no data races)
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <ostream>			// output streams
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "ClockSource.h"
+
+#pragma endregion
+
+#ifndef PROFILER_ENABLED
+#ifndef NDEBUG
+#define PROFILER_ENABLED 1
+#else
+#define PROFILER_ENABLED 0
+#endif
+#endif
+
+#define PROFILER_CONCATENATE_(a, b) a##b
+#define PROFILER_CONCATENATE(a, b) PROFILER_CONCATENATE_(a, b)
+
+#if PROFILER_ENABLED
+#define PROFILE_ZONE(name) core::ProfileZone PROFILER_CONCATENATE(profileZone, __LINE__)(name)
+#define PROFILE_FRAME() core::Profiler::EndFrame()
+#else
+#define PROFILE_ZONE(name) ((void)0)
+#define PROFILE_FRAME() ((void)0)
+#endif
+
+namespace core
+{
+	// A finished zone, in counts of the profiler clock
+	struct ProfileEvent
+	{
+		const char* name;
+		std::int64_t start;
+		std::int64_t end;
+		std::uint32_t depth;					// number of enclosing zones
+	};
+
+	// The zones of a single thread: written by the thread itself, read by the thread ending the frames
+	class ProfileThreadBuffer
+	{
+	public:
+		ProfileThreadBuffer(std::uint32_t threadIndex, std::size_t capacity);
+
+		// Producer
+		std::int64_t BeginZone(const ClockSource& clock);
+		void EndZone(const ClockSource& clock, const char* name, std::int64_t start);
+
+		// Consumer: the reader is called with every event written since the last drain
+		template<typename Reader>
+		void Drain(Reader&& read);
+
+		static const std::uint32_t maxDepth = 64;
+
+		const std::uint32_t threadIndex;		// the Chrome trace thread id
+		std::string name;						// guarded by the profiler mutex
+		std::atomic<bool> isRetired;			// the thread exited
+		std::atomic<unsigned long long> dropped;	// zones lost because the buffer was full
+
+	private:
+		std::vector<ProfileEvent> events;		// ring buffer, the capacity is a power of two
+		const std::size_t mask;
+		std::atomic<std::size_t> head;			// next slot to write, only written by the producer
+		std::atomic<std::size_t> tail;			// next slot to read, only written by the consumer
+		std::uint32_t depth;					// number of open zones, only used by the producer
+	};
+
+	// A zone of the call tree; times in milliseconds
+	struct ProfileNode
+	{
+		const char* name;
+		std::uint32_t calls;					// number of times the zone was entered during the frame
+		double totalTime;
+		double selfTime;						// total time minus the time of the children
+		std::vector<ProfileNode> children;
+	};
+
+	struct ProfileThreadTree
+	{
+		std::string threadName;
+		std::vector<ProfileNode> roots;
+	};
+
+	// The call trees of all threads during one frame
+	struct ProfileFrame
+	{
+		unsigned long long index;				// number of the frame
+		double duration;						// time since the previous frame, in milliseconds
+		std::vector<ProfileThreadTree> threads;
+	};
+
+	class ProfileZone
+	{
+	public:
+		explicit ProfileZone(const char* name);
+		~ProfileZone();
+
+		ProfileZone(const ProfileZone&) = delete;
+		ProfileZone& operator=(const ProfileZone&) = delete;
+
+	private:
+		const char* name;
+		ProfileThreadBuffer* buffer;			// null if the profiler has no clock
+		const ClockSource* clock;
+		std::int64_t start;
+	};
+
+	class Profiler
+	{
+	public:
+		// The clock of the game timer; it must outlive all zones, set to null to stop profiling
+		static void SetClock(const ClockSource* clock);
+		static void SetThreadName(const std::string& name);		// the name of the calling thread in the traces
+
+		// Drains all thread buffers and builds the call tree of the frame that ended
+		static void EndFrame();
+
+		// Writes the zones of the next frames to a Chrome trace file once they ended
+		static void CaptureFrames(unsigned int frames, const std::wstring& filename);
+		static bool IsCapturing();
+
+		// Getters; only valid on the thread ending the frames
+		static const ProfileFrame& GetLastFrame();
+		static const ProfileFrame& GetSlowestFrame();		// the frame with the longest duration since the profiler started
+		static unsigned long long GetDroppedZoneCount();
+
+		// Writes the call trees of the slowest and the last frame
+		static void WriteCallTree(std::ostream& out, const ProfileFrame& frame);
+		static bool WriteReport(const std::wstring& filename);
+
+		// Internal: the buffer of the calling thread, created on first use; null if the profiler has no clock
+		static ProfileThreadBuffer* GetThreadBuffer(const ClockSource*& clock);
+
+	private:
+		static std::atomic<const ClockSource*> clock;
+	};
+
+	inline ProfileZone::ProfileZone(const char* name) : name(name), buffer(nullptr), clock(nullptr), start(0)
+	{
+		buffer = Profiler::GetThreadBuffer(clock);
+		if (buffer)
+		{
+			start = buffer->BeginZone(*clock);
+		}
+	}
+
+	inline ProfileZone::~ProfileZone()
+	{
+		if (buffer)
+		{
+			buffer->EndZone(*clock, name, start);
+		}
+	}
+
+	template<typename Reader>
+	void ProfileThreadBuffer::Drain(Reader&& read)
+	{
+		std::size_t end = head.load(std::memory_order_acquire);
+		std::size_t position = tail.load(std::memory_order_relaxed);
+		for (; position != end; position++)
+		{
+			read(events[position & mask]);
+		}
+		tail.store(position, std::memory_order_release);
+	}
+}
@@ -0,0 +1,260 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Random.cpp
+*
+* Random number generators for graphics: fast, deterministic, and without hidden global state
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// Project includes
+#include "Random.h"
+
+// the batch fill of Philox4x32 is vectorized where the compiler targets SSE2
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RANDOM_SSE2 1
+#include <emmintrin.h>		// SSE2 intrinsics
+#endif
+
+#pragma endregion
+
+namespace graphics
+{
+	namespace
+	{
+		// Philox4x32-10
+		const unsigned int philoxRounds = 10;
+		const std::uint32_t philoxMultiplier0 = 0xd2511f53U;
+		const std::uint32_t philoxMultiplier1 = 0xcd9e8d57U;
+		const std::uint32_t philoxWeyl0 = 0x9e3779b9U;			// the key schedule: the golden ratio
+		const std::uint32_t philoxWeyl1 = 0xbb67ae85U;			// and the square root of 3
+
+		const std::uint64_t pcgMultiplier = 6364136223846793005ULL;
+
+		// 2^64 calls of xoshiro128+
+		const std::uint32_t xoshiroJump[4] = { 0x8764000bU, 0xf542d2d3U, 0x6fa035c3U, 0x77f2db5bU };
+
+		// spreads a seed over the state of a generator
+		std::uint64_t SplitMix64(std::uint64_t& x)
+		{
+			std::uint64_t z = (x += 0x9e3779b97f4a7c15ULL);
+			z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+			z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+			return z ^ (z >> 31);
+		}
+
+#if RANDOM_SSE2
+		// the upper and the lower 32 bits of the products of the four lanes with the multiplier
+		inline void MultiplyHighLow(__m128i a, __m128i multiplier, __m128i& high, __m128i& low)
+		{
+			const __m128i even = _mm_mul_epu32(a, multiplier);
+			const __m128i odd = _mm_mul_epu32(_mm_srli_epi64(a, 32), multiplier);
+			low = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 2, 0)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 2, 0)));
+			high = _mm_unpacklo_epi32(_mm_shuffle_epi32(even, _MM_SHUFFLE(0, 0, 3, 1)), _mm_shuffle_epi32(odd, _MM_SHUFFLE(0, 0, 3, 1)));
+		}
+
+		inline __m128 ToFloats(__m128i bits, __m128 min, __m128 range)
+		{
+			const __m128 unit = _mm_mul_ps(_mm_cvtepi32_ps(_mm_srli_epi32(bits, 8)), _mm_set1_ps(1.0f / 16777216.0f));
+			return _mm_add_ps(min, _mm_mul_ps(unit, range));
+		}
+#endif
+	}
+
+#pragma region "Philox4x32"
+
+	Philox4x32::Philox4x32(std::uint64_t seed, std::uint64_t stream) : key{ (std::uint32_t)seed, (std::uint32_t)(seed >> 32) }, stream{ (std::uint32_t)stream, (std::uint32_t)(stream >> 32) }, position(0), buffer{}
+	{
+
+	}
+
+	void Philox4x32::GenerateBlock(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4])
+	{
+		std::uint32_t c0 = counter[0], c1 = counter[1], c2 = counter[2], c3 = counter[3];
+		std::uint32_t k0 = key[0], k1 = key[1];
+		for (unsigned int round = 0; round < philoxRounds; round++)
+		{
+			const std::uint64_t product0 = (std::uint64_t)philoxMultiplier0 * c0;
+			const std::uint64_t product1 = (std::uint64_t)philoxMultiplier1 * c2;
+			c0 = (std::uint32_t)(product1 >> 32) ^ c1 ^ k0;
+			c1 = (std::uint32_t)product1;
+			c2 = (std::uint32_t)(product0 >> 32) ^ c3 ^ k1;
+			c3 = (std::uint32_t)product0;
+			k0 += philoxWeyl0;
+			k1 += philoxWeyl1;
+		}
+		out[0] = c0;
+		out[1] = c1;
+		out[2] = c2;
+		out[3] = c3;
+	}
+
+	void Philox4x32::LoadBlock(std::uint64_t block)
+	{
+		const std::uint32_t counter[4] = { (std::uint32_t)block, (std::uint32_t)(block >> 32), stream[0], stream[1] };
+		GenerateBlock(counter, key, buffer);
+	}
+
+	void Philox4x32::Discard(std::uint64_t count)
+	{
+		position += count;
+		if ((position & 3) != 0)
+		{
+			LoadBlock(position >> 2);
+		}
+	}
+
+	void Philox4x32::Fill(float* out, std::size_t count, float min, float max)
+	{
+		const float range = max - min;
+		std::size_t i = 0;
+
+		// the rest of the current block
+		while (i < count && (position & 3) != 0)
+		{
+			out[i++] = min + ToUnitFloat(Next()) * range;
+		}
+
+#if RANDOM_SSE2
+		// four blocks at a time, one block per lane
+		const __m128i multiplier0 = _mm_set1_epi32((int)philoxMultiplier0);
+		const __m128i multiplier1 = _mm_set1_epi32((int)philoxMultiplier1);
+		const __m128 minimum = _mm_set1_ps(min);
+		const __m128 ranges = _mm_set1_ps(range);
+		for (; count - i >= 16; i += 16)
+		{
+			const std::uint64_t block = position >> 2;
+			__m128i c0 = _mm_setr_epi32((int)block, (int)(block + 1), (int)(block + 2), (int)(block + 3));
+			__m128i c1 = _mm_setr_epi32((int)(block >> 32), (int)((block + 1) >> 32), (int)((block + 2) >> 32), (int)((block + 3) >> 32));
+			__m128i c2 = _mm_set1_epi32((int)stream[0]);
+			__m128i c3 = _mm_set1_epi32((int)stream[1]);
+			std::uint32_t k0 = key[0], k1 = key[1];
+			for (unsigned int round = 0; round < philoxRounds; round++)
+			{
+				__m128i high0, low0, high1, low1;
+				MultiplyHighLow(c0, multiplier0, high0, low0);
+				MultiplyHighLow(c2, multiplier1, high1, low1);
+				c0 = _mm_xor_si128(_mm_xor_si128(high1, c1), _mm_set1_epi32((int)k0));
+				c1 = low1;
+				c2 = _mm_xor_si128(_mm_xor_si128(high0, c3), _mm_set1_epi32((int)k1));
+				c3 = low0;
+				k0 += philoxWeyl0;
+				k1 += philoxWeyl1;
+			}
+
+			// from one word of every block per vector to one block per vector
+			const __m128i t0 = _mm_unpacklo_epi32(c0, c1);
+			const __m128i t1 = _mm_unpacklo_epi32(c2, c3);
+			const __m128i t2 = _mm_unpackhi_epi32(c0, c1);
+			const __m128i t3 = _mm_unpackhi_epi32(c2, c3);
+			_mm_storeu_ps(out + i, ToFloats(_mm_unpacklo_epi64(t0, t1), minimum, ranges));
+			_mm_storeu_ps(out + i + 4, ToFloats(_mm_unpackhi_epi64(t0, t1), minimum, ranges));
+			_mm_storeu_ps(out + i + 8, ToFloats(_mm_unpacklo_epi64(t2, t3), minimum, ranges));
+			_mm_storeu_ps(out + i + 12, ToFloats(_mm_unpackhi_epi64(t2, t3), minimum, ranges));
+			position += 16;
+		}
+#endif
+
+		while (i < count)
+		{
+			out[i++] = min + ToUnitFloat(Next()) * range;
+		}
+	}
+
+#pragma endregion
+
+#pragma region "Pcg32"
+
+	Pcg32::Pcg32(std::uint64_t seed, std::uint64_t stream) : state(0), increment((stream << 1) | 1)
+	{
+		Next();
+		state += seed;
+		Next();
+	}
+
+	void Pcg32::Discard(std::uint64_t count)
+	{
+		// the LCG of count steps is itself an LCG: square the step while halving count
+		std::uint64_t multiplier = 1, increments = 0;
+		std::uint64_t stepMultiplier = pcgMultiplier, stepIncrement = increment;
+		while (count > 0)
+		{
+			if (count & 1)
+			{
+				multiplier *= stepMultiplier;
+				increments = increments * stepMultiplier + stepIncrement;
+			}
+			stepIncrement = (stepMultiplier + 1) * stepIncrement;
+			stepMultiplier *= stepMultiplier;
+			count >>= 1;
+		}
+		state = multiplier * state + increments;
+	}
+
+	void Pcg32::Fill(float* out, std::size_t count, float min, float max)
+	{
+		const float range = max - min;
+		for (std::size_t i = 0; i < count; i++)
+		{
+			out[i] = min + ToUnitFloat(Next()) * range;
+		}
+	}
+
+#pragma endregion
+
+#pragma region "Xoshiro128Plus"
+
+	Xoshiro128Plus::Xoshiro128Plus(std::uint64_t seed, std::uint64_t stream)
+	{
+		const std::uint64_t a = SplitMix64(seed);
+		const std::uint64_t b = SplitMix64(seed);
+		state[0] = (std::uint32_t)a;
+		state[1] = (std::uint32_t)(a >> 32);
+		state[2] = (std::uint32_t)b;
+		state[3] = (std::uint32_t)(b >> 32);
+
+		// a stream costs a jump: meant for small numbers, such as the index of a thread
+		for (std::uint64_t i = 0; i < stream; i++)
+		{
+			Jump();
+		}
+	}
+
+	void Xoshiro128Plus::Fill(float* out, std::size_t count, float min, float max)
+	{
+		const float range = max - min;
+		for (std::size_t i = 0; i < count; i++)
+		{
+			out[i] = min + ToUnitFloat(Next()) * range;
+		}
+	}
+
+	void Xoshiro128Plus::Jump()
+	{
+		std::uint32_t jumped[4] = {};
+		for (std::uint32_t word : xoshiroJump)
+		{
+			for (unsigned int bit = 0; bit < 32; bit++)
+			{
+				if (word & (1U << bit))
+				{
+					for (unsigned int i = 0; i < 4; i++)
+					{
+						jumped[i] ^= state[i];
+					}
+				}
+				Next();
+			}
+		}
+		for (unsigned int i = 0; i < 4; i++)
+		{
+			state[i] = jumped[i];
+		}
+	}
+
+#pragma endregion
+}
@@ -0,0 +1,159 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Random.h
+*
+* Random number generators for graphics: fast, deterministic, and without hidden global state
+*
+* Unlike rand(), each generator is a small object: threads that use their own generators never share state, and the
+* numbers only depend on the seed and the stream, thus a run can be repeated exactly. Every generator has 32 random bits
+* per call, where rand() has 15 with the Microsoft C runtime.
+*
+* - Philox4x32: counter-based, the n-th number is a function of n, the seed and the stream. Jumps ahead to any position
+*   at no cost and has 2^64 streams; its batch fill is vectorized. The generator of choice to split work among threads.
+*	J. K. Salmon et al.: Parallel Random Numbers: As Easy as 1, 2, 3, SC 2011
+* - Pcg32: a 64-bit linear congruential generator with a permuted output; the smallest state, 2^63 streams, and jumps
+*   ahead in logarithmic time.
+*	M. E. O'Neill: PCG: A Family of Simple Fast Space-Efficient Statistically Good Algorithms for Random Number Generation
+* - Xoshiro128Plus: the fastest one number at a time. Streams are 2^64 numbers apart; it can only jump ahead in steps
+*   of 2^64.
+*	D. Blackman, S. Vigna: Scrambled Linear Pseudorandom Number Generators
+*
+* All of them are uniform random bit generators, thus they work with the distributions of <random>. Floats are made of
+* the upper 24 bits of a number and are in [0, 1). Fill writes exactly the floats NextFloat would, bit for bit.
+*
+* To give each worker its own deterministic numbers, either use the index of its work as the stream, or use one stream
+* and jump to the first number of the work: both give the same result for any number of threads.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+
+#pragma endregion
+
+namespace graphics
+{
+	// The upper 24 bits of a number as a float in [0, 1), exactly
+	inline float ToUnitFloat(std::uint32_t bits) { return (float)(bits >> 8) * (1.0f / 16777216.0f); };
+
+	class Philox4x32
+	{
+	public:
+		typedef std::uint32_t result_type;
+
+		explicit Philox4x32(std::uint64_t seed = 0, std::uint64_t stream = 0);
+
+		// Uniform random bit generator; in parentheses, as windows.h defines min and max as macros
+		static constexpr result_type (min)() { return 0; };
+		static constexpr result_type (max)() { return 0xffffffffU; };
+		result_type operator()() { return Next(); };
+
+		std::uint32_t Next();
+		float NextFloat() { return ToUnitFloat(Next()); };
+		float NextFloat(float min, float max) { return min + ToUnitFloat(Next()) * (max - min); };
+		void Fill(float* out, std::size_t count, float min = 0.0f, float max = 1.0f);
+
+		void Discard(std::uint64_t count);		// skips count numbers, at no cost
+		std::uint64_t GetPosition() const { return position; };
+
+		// The four numbers of a block of the given counter and key: the Philox4x32-10 bijection
+		static void GenerateBlock(const std::uint32_t counter[4], const std::uint32_t key[2], std::uint32_t out[4]);
+
+	private:
+		void LoadBlock(std::uint64_t block);		// generates the block into the buffer
+
+		std::uint32_t key[2];					// the seed
+		std::uint32_t stream[2];				// the upper half of the counter
+		std::uint64_t position;					// numbers generated so far; the block is the lower half of the counter
+		std::uint32_t buffer[4];				// the numbers of the current block
+	};
+
+	class Pcg32
+	{
+	public:
+		typedef std::uint32_t result_type;
+
+		explicit Pcg32(std::uint64_t seed = 0, std::uint64_t stream = 0);
+
+		// Uniform random bit generator; in parentheses, as windows.h defines min and max as macros
+		static constexpr result_type (min)() { return 0; };
+		static constexpr result_type (max)() { return 0xffffffffU; };
+		result_type operator()() { return Next(); };
+
+		std::uint32_t Next();
+		float NextFloat() { return ToUnitFloat(Next()); };
+		float NextFloat(float min, float max) { return min + ToUnitFloat(Next()) * (max - min); };
+		void Fill(float* out, std::size_t count, float min = 0.0f, float max = 1.0f);
+
+		void Discard(std::uint64_t count);		// skips count numbers in O(log count)
+
+	private:
+		std::uint64_t state;
+		std::uint64_t increment;				// the stream, always odd
+	};
+
+	class Xoshiro128Plus
+	{
+	public:
+		typedef std::uint32_t result_type;
+
+		explicit Xoshiro128Plus(std::uint64_t seed = 0, std::uint64_t stream = 0);
+
+		// Uniform random bit generator; in parentheses, as windows.h defines min and max as macros
+		static constexpr result_type (min)() { return 0; };
+		static constexpr result_type (max)() { return 0xffffffffU; };
+		result_type operator()() { return Next(); };
+
+		std::uint32_t Next();
+		float NextFloat() { return ToUnitFloat(Next()); };
+		float NextFloat(float min, float max) { return min + ToUnitFloat(Next()) * (max - min); };
+		void Fill(float* out, std::size_t count, float min = 0.0f, float max = 1.0f);
+
+		void Jump();							// skips 2^64 numbers: to the next stream
+
+	private:
+		std::uint32_t state[4];
+	};
+
+	inline std::uint32_t Philox4x32::Next()
+	{
+		if ((position & 3) == 0)
+		{
+			LoadBlock(position >> 2);
+		}
+		return buffer[position++ & 3];
+	}
+
+	inline std::uint32_t Pcg32::Next()
+	{
+		// XSH RR: xorshift the high bits down, then rotate by the top five bits
+		const std::uint64_t previous = state;
+		state = previous * 6364136223846793005ULL + increment;
+		const std::uint32_t xorShifted = (std::uint32_t)(((previous >> 18) ^ previous) >> 27);
+		const std::uint32_t rotation = (std::uint32_t)(previous >> 59);
+		return (xorShifted >> rotation) | (xorShifted << ((32 - rotation) & 31));
+	}
+
+	inline std::uint32_t Xoshiro128Plus::Next()
+	{
+		const std::uint32_t result = state[0] + state[3];
+		const std::uint32_t t = state[1] << 9;
+
+		state[2] ^= state[0];
+		state[3] ^= state[1];
+		state[1] ^= state[2];
+		state[0] ^= state[3];
+		state[2] ^= t;
+		state[3] = (state[3] << 11) | (state[3] >> 21);
+
+		return result;
+	}
+}
@@ -0,0 +1,43 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* RenderDevice.cpp
+*
+* The shaders of the game as callbacks, for the render devices that run them on the CPU
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstring>			// std::memcpy
+
+// Project includes
+#include "RenderDevice.h"
+#include "Vertex.h"
+
+#pragma endregion
+
+namespace graphics
+{
+	void ShadePackedVertex(const unsigned char* vertex, ShaderVertex& output)
+	{
+		// the vertex buffer may not be aligned for the vertex
+		PackedVertex packed;
+		std::memcpy(&packed, vertex, sizeof(PackedVertex));
+
+		// the input layout reads the halves and normalizes the bytes, the shader takes x, y, z and r, g, b and sets w and
+		// alpha to 1
+		output.position[0] = HalfToFloat(packed.x);
+		output.position[1] = HalfToFloat(packed.y);
+		output.position[2] = HalfToFloat(packed.z);
+		output.position[3] = 1.0f;
+		for (unsigned int channel = 0; channel < 3; channel++)
+		{
+			output.color[channel] = ((packed.color >> (8 * channel)) & 0xff) / 255.0f;
+		}
+		output.color[3] = 1.0f;
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* RenderDevice.h
+*
+* The few rendering calls the game needs, independent of the backend: buffers, shaders, clear, draw and present
+*
+* Direct3D renders on the GPU, the software device renders into memory on the CPU, without a GPU or a window. The
+* shaders are callbacks: the software device runs them, while Direct3D runs the compiled HLSL shaders they mirror.
+*
+* Draws are triangle lists with a depth test (less) and back faces culled, clockwise triangles facing the viewer, as
+* Direct3D does by default.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstddef>			// std::size_t
+#include <functional>		// std::function
+
+// Project includes
+#include "DynamicBuffer.h"
+#include "Expected.h"
+
+#pragma endregion
+
+namespace graphics
+{
+	// Identifies a buffer of a render device
+	typedef unsigned int BufferHandle;
+
+	// The output of the vertex shader, in homogeneous clip space, and, interpolated, the input of the pixel shader
+	struct ShaderVertex
+	{
+		float position[4];
+		float color[4];
+	};
+
+	typedef std::function<void(const unsigned char*, ShaderVertex&)> VertexShaderFunction;		// vertexShader(vertex, output)
+	typedef std::function<void(const ShaderVertex&, float*)> PixelShaderFunction;				// pixelShader(input, rgba)
+
+	// What VertexShader.hlsl does to a packed vertex
+	void ShadePackedVertex(const unsigned char* vertex, ShaderVertex& output);
+
+	class RenderDevice
+	{
+	public:
+		virtual ~RenderDevice() {};
+
+		// Dynamic vertex buffers, written by the CPU and read by the device
+		virtual util::Expected<BufferHandle> CreateBuffer(std::size_t size) = 0;
+		virtual util::Expected<void*> MapBuffer(BufferHandle buffer, MapMode mode) = 0;
+		virtual void UnmapBuffer(BufferHandle buffer) = 0;
+
+		// The vertices of the next draws: stride bytes each, from offset on
+		virtual void SetVertexBuffer(BufferHandle buffer, std::size_t stride, std::size_t offset) = 0;
+
+		// A null pixel shader outputs the interpolated color, as PixelShader.hlsl
+		virtual void SetShaders(const VertexShaderFunction& vertexShader, const PixelShaderFunction& pixelShader) = 0;
+
+		// Clears the render target to the color, and the depth buffer to the far plane
+		virtual void Clear(const float* rgba) = 0;
+
+		// Draws vertexCount vertices as a triangle list, from firstVertex on
+		virtual void Draw(std::size_t vertexCount, std::size_t firstVertex) = 0;
+
+		virtual util::Expected<void> Present() = 0;
+	};
+
+	// Maps a buffer of a render device, for the dynamic buffer manager
+	class RenderBufferDevice : public BufferDevice
+	{
+	public:
+		RenderBufferDevice(RenderDevice& device, BufferHandle buffer) : device(device), buffer(buffer) {};
+		~RenderBufferDevice() {};
+
+		util::Expected<void*> Map(MapMode mode) override { return device.MapBuffer(buffer, mode); };
+		void Unmap() override { device.UnmapBuffer(buffer); };
+
+	private:
+		RenderDevice& device;
+		const BufferHandle buffer;
+	};
+}
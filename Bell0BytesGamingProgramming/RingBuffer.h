@@ -0,0 +1,215 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* RingBuffer.h
+*
+* Bounded lock-free multi-producer/single-consumer ring buffer of preallocated slots
+*
+* Based on Dmitry Vyukov's bounded MPMC queue
+* - http://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+*
+* Every slot carries a sequence number which tells producers and the consumer whether the slot is free or holds data.
+* Slots are never deallocated: producers write into them and the consumer reads from them in place, thus a slot holding
+* a std::string keeps its capacity and steady-state logging does not allocate.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <atomic>			// atomic objects (no data races)
+#include <cstddef>			// std::size_t
+#include <cstdint>			// std::intptr_t
+#include <memory>			// std::unique_ptr
+#include <stdexcept>		// std::invalid_argument
+#include <thread>			// std::this_thread::yield
+
+#pragma endregion
+
+namespace util
+{
+	// What a producer does when it finds the ring full
+	enum class OverflowPolicy
+	{
+		block,				// wait until the consumer has freed a slot
+		dropNewest,			// discard the item that was about to be pushed
+		dropOldest,			// discard the oldest item in the ring to make room for the new one
+	};
+
+	template<typename T>
+	class MPSCRingBuffer
+	{
+	public:
+		MPSCRingBuffer(std::size_t capacity, OverflowPolicy overflowPolicy = OverflowPolicy::block);
+		~MPSCRingBuffer() {};
+
+		MPSCRingBuffer(const MPSCRingBuffer&) = delete;
+		MPSCRingBuffer& operator=(const MPSCRingBuffer&) = delete;
+
+		// Producers: the writer is called with a reference to a free slot; returns false if the item was dropped
+		template<typename Writer>
+		bool Push(Writer&& write);
+
+		// Consumer: the reader is called with a reference to the oldest slot; returns false if the ring was empty
+		template<typename Reader>
+		bool Pop(Reader&& read);
+
+		// Getters
+		std::size_t GetCapacity() const { return capacity; };
+		std::size_t GetApproximateSize() const;
+		std::size_t GetEnqueuePosition() const { return enqueuePosition.load(std::memory_order_acquire); };	// number of slots ever claimed by producers
+		std::size_t GetDequeuePosition() const { return dequeuePosition.load(std::memory_order_acquire); };	// number of slots ever consumed or evicted
+		bool IsEmpty() const { return GetApproximateSize() == 0; };
+		OverflowPolicy GetOverflowPolicy() const { return overflowPolicy; };
+		unsigned long long GetDroppedNewestCount() const { return droppedNewest.load(std::memory_order_relaxed); };
+		unsigned long long GetDroppedOldestCount() const { return droppedOldest.load(std::memory_order_relaxed); };
+		unsigned long long GetDroppedCount() const { return GetDroppedNewestCount() + GetDroppedOldestCount(); };
+
+	private:
+		struct Slot
+		{
+			std::atomic<std::size_t> sequence;				// position at which this slot may next be written (free) or read (full)
+			T data;											// the preallocated payload
+		};
+
+		static constexpr std::size_t cacheLineSize = 64;
+
+		std::unique_ptr<Slot[]> slots;						// the preallocated slots
+		const std::size_t capacity;							// number of slots, always a power of two
+		const std::size_t mask;								// capacity - 1, used to wrap positions
+		const OverflowPolicy overflowPolicy;				// what to do when the ring is full
+
+		alignas(cacheLineSize) std::atomic<std::size_t> enqueuePosition;	// next position to be claimed by a producer
+		alignas(cacheLineSize) std::atomic<std::size_t> dequeuePosition;	// next position to be read by the consumer
+		alignas(cacheLineSize) std::atomic<unsigned long long> droppedNewest;	// number of items rejected because the ring was full
+		std::atomic<unsigned long long> droppedOldest;						// number of items evicted to make room for newer ones
+	};
+
+	template<typename T>
+	MPSCRingBuffer<T>::MPSCRingBuffer(std::size_t capacity, OverflowPolicy overflowPolicy) :
+		slots(new Slot[capacity]),
+		capacity(capacity),
+		mask(capacity - 1),
+		overflowPolicy(overflowPolicy),
+		enqueuePosition(0),
+		dequeuePosition(0),
+		droppedNewest(0),
+		droppedOldest(0)
+	{
+		if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+		{
+			throw std::invalid_argument("The capacity of the ring buffer must be a power of two!");
+		}
+
+		// each slot is initially free to be written at its own index
+		for (std::size_t i = 0; i < capacity; i++)
+		{
+			slots[i].sequence.store(i, std::memory_order_relaxed);
+		}
+	}
+
+	template<typename T>
+	template<typename Writer>
+	bool MPSCRingBuffer<T>::Push(Writer&& write)
+	{
+		Slot* slot;
+		std::size_t position = enqueuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			slot = &slots[position & mask];
+			std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			std::intptr_t difference = (std::intptr_t)sequence - (std::intptr_t)position;
+
+			if (difference == 0)
+			{
+				// the slot is free, try to claim it
+				if (enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// the ring is full
+				switch (overflowPolicy)
+				{
+				case OverflowPolicy::dropNewest:
+					droppedNewest.fetch_add(1, std::memory_order_relaxed);
+					return false;
+
+				case OverflowPolicy::dropOldest:
+					if (Pop([](T&) {}))
+					{
+						droppedOldest.fetch_add(1, std::memory_order_relaxed);
+					}
+					break;
+
+				case OverflowPolicy::block:
+				default:
+					std::this_thread::yield();
+					break;
+				}
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+			else
+			{
+				// another producer claimed the slot, try again
+				position = enqueuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		// write the payload and publish the slot to the consumer
+		write(slot->data);
+		slot->sequence.store(position + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	template<typename Reader>
+	bool MPSCRingBuffer<T>::Pop(Reader&& read)
+	{
+		// note: producers evicting the oldest item also pop, thus the dequeue position must be claimed atomically
+		Slot* slot;
+		std::size_t position = dequeuePosition.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			slot = &slots[position & mask];
+			std::size_t sequence = slot->sequence.load(std::memory_order_acquire);
+			std::intptr_t difference = (std::intptr_t)sequence - (std::intptr_t)(position + 1);
+
+			if (difference == 0)
+			{
+				// the slot holds data, try to claim it
+				if (dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+				{
+					break;
+				}
+			}
+			else if (difference < 0)
+			{
+				// the ring is empty
+				return false;
+			}
+			else
+			{
+				position = dequeuePosition.load(std::memory_order_relaxed);
+			}
+		}
+
+		// read the payload and hand the slot back to the producers
+		read(slot->data);
+		slot->sequence.store(position + mask + 1, std::memory_order_release);
+		return true;
+	}
+
+	template<typename T>
+	std::size_t MPSCRingBuffer<T>::GetApproximateSize() const
+	{
+		std::size_t enqueued = enqueuePosition.load(std::memory_order_relaxed);
+		std::size_t dequeued = dequeuePosition.load(std::memory_order_relaxed);
+		return enqueued > dequeued ? enqueued - dequeued : 0;
+	}
+}
@@ -14,7 +14,6 @@
 
 #pragma region "Includes"
 
-#include "stdafx.h"
 #include "ServiceLocator.h"
 
 #pragma endregion
@@ -22,9 +21,15 @@
 
 namespace util
 {
-	std::shared_ptr<Logger<FileLogPolicy>> ServiceLocator::fileLogger = NULL;
-	void ServiceLocator::ProvideFileLoggingService(std::shared_ptr<Logger<FileLogPolicy>> providedFileLogger)
+	std::shared_ptr<Logger<MappedFileLogPolicy>> ServiceLocator::fileLogger = NULL;
+	void ServiceLocator::ProvideFileLoggingService(std::shared_ptr<Logger<MappedFileLogPolicy>> providedFileLogger)
 	{
 		fileLogger = providedFileLogger;
 	}
+
+	std::shared_ptr<JobSystem> ServiceLocator::jobSystem = NULL;
+	void ServiceLocator::ProvideJobSystem(std::shared_ptr<JobSystem> providedJobSystem)
+	{
+		jobSystem = providedJobSystem;
+	}
 }
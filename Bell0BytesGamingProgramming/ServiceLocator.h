@@ -17,6 +17,8 @@
 #pragma region "Includes"
 
 #include "Log.h"
+#include "MappedFileLogPolicy.h"
+#include "JobSystem.h"
 
 #pragma endregion
 
@@ -25,10 +27,13 @@ namespace util
 	class ServiceLocator
 	{
 	public:
-		static Logger<FileLogPolicy>* GetFileLogger() { return fileLogger.get(); };
-		static void ProvideFileLoggingService(std::shared_ptr<Logger<FileLogPolicy>> providedFileLogger);
+		static Logger<MappedFileLogPolicy>* GetFileLogger() { return fileLogger.get(); };
+		static void ProvideFileLoggingService(std::shared_ptr<Logger<MappedFileLogPolicy>> providedFileLogger);
+		static JobSystem* GetJobSystem() { return jobSystem.get(); };
+		static void ProvideJobSystem(std::shared_ptr<JobSystem> providedJobSystem);
 	private:
-		static std::shared_ptr<Logger<FileLogPolicy>> fileLogger;
+		static std::shared_ptr<Logger<MappedFileLogPolicy>> fileLogger;
+		static std::shared_ptr<JobSystem> jobSystem;
 	};
 }
 
@@ -0,0 +1,362 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* SoftwareRenderDevice.cpp
+*
+* A render device that rasterizes on the CPU into a framebuffer in memory, on all threads of the job system
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::fill, std::min, std::max
+#include <cmath>			// std::floor, std::ceil, std::fabs
+#include <stdexcept>		// std::invalid_argument, std::runtime_error
+
+// Project includes
+#include "SoftwareRenderDevice.h"
+#include "JobSystem.h"
+
+#pragma endregion
+
+namespace graphics
+{
+	namespace
+	{
+		// the fixed point of the screen coordinates: 8 bits below the pixel, as Direct3D
+		const float subpixels = 256.0f;
+		const std::int64_t subpixelSize = 256;
+		const std::int64_t halfPixel = 128;
+
+		// vertices further off the screen drop their triangle, thus the edge functions fit into 64 bits
+		const float guardBand = 16384.0f;
+
+		// a color channel in [0, 1] as a byte; NaN is black
+		inline std::uint32_t ToByte(float value)
+		{
+			value = value > 0.0f ? value : 0.0f;
+			value = value < 1.0f ? value : 1.0f;
+			return (std::uint32_t)(value * 255.0f + 0.5f);
+		}
+
+		inline std::uint32_t ToColor(const float* rgba)
+		{
+			return ToByte(rgba[0]) | ToByte(rgba[1]) << 8 | ToByte(rgba[2]) << 16 | ToByte(rgba[3]) << 24;
+		}
+
+		// jobs per pass at most, well below the jobs a thread of the job system may have unfinished
+		const std::size_t maxJobsPerPass = 1024;
+
+		// calls function(i) for i in [0, count), one job each if there is a job system, or a few each if there are too many
+		template<typename Function>
+		void ForEach(util::JobSystem* jobSystem, std::size_t count, const Function& function)
+		{
+			if (!jobSystem)
+			{
+				for (std::size_t i = 0; i < count; i++)
+				{
+					function(i);
+				}
+				return;
+			}
+
+			const std::size_t grainSize = (count + maxJobsPerPass - 1) / maxJobsPerPass;
+			jobSystem->ParallelFor(0, count, grainSize, [&function](std::size_t first, std::size_t last)
+			{
+				for (std::size_t i = first; i < last; i++)
+				{
+					function(i);
+				}
+			});
+		}
+	}
+
+	SoftwareRenderDevice::SoftwareRenderDevice(unsigned int width, unsigned int height, util::JobSystem* jobSystem, unsigned int tileSize, std::size_t trianglesPerBatch) :
+		width(width),
+		height(height),
+		jobSystem(jobSystem),
+		tileSize(tileSize),
+		tilesX(tileSize > 0 ? (width + tileSize - 1) / tileSize : 0),
+		tilesY(tileSize > 0 ? (height + tileSize - 1) / tileSize : 0),
+		trianglesPerBatch(trianglesPerBatch),
+		colors((std::size_t)width * height, 0),
+		depths((std::size_t)width * height, 1.0f),
+		vertexBuffer(0),
+		vertexStride(0),
+		vertexOffset(0),
+		statistics(),
+		presentedFrames(0)
+	{
+		if (width == 0 || height == 0 || width > (unsigned int)guardBand || height > (unsigned int)guardBand || tileSize == 0 || trianglesPerBatch == 0)
+		{
+			throw std::invalid_argument("Invalid size of the software framebuffer, of its tiles or of its batches!");
+		}
+	}
+
+	util::Expected<BufferHandle> SoftwareRenderDevice::CreateBuffer(std::size_t size)
+	{
+		buffers.emplace_back(size);
+		return static_cast<BufferHandle>(buffers.size() - 1);
+	}
+
+	util::Expected<void*> SoftwareRenderDevice::MapBuffer(BufferHandle buffer, MapMode /*mode*/)
+	{
+		// the draws are done when they return, thus discarding and not overwriting are the same
+		if (buffer >= buffers.size())
+		{
+			return std::runtime_error("Unable to map an unknown buffer!");
+		}
+		return static_cast<void*>(buffers[buffer].data());
+	}
+
+	void SoftwareRenderDevice::SetVertexBuffer(BufferHandle buffer, std::size_t stride, std::size_t offset)
+	{
+		vertexBuffer = buffer;
+		vertexStride = stride;
+		vertexOffset = offset;
+	}
+
+	void SoftwareRenderDevice::SetShaders(const VertexShaderFunction& vertexShader, const PixelShaderFunction& pixelShader)
+	{
+		this->vertexShader = vertexShader;
+		this->pixelShader = pixelShader;
+	}
+
+	void SoftwareRenderDevice::Clear(const float* rgba)
+	{
+		std::fill(colors.begin(), colors.end(), ToColor(rgba));
+		std::fill(depths.begin(), depths.end(), 1.0f);
+	}
+
+	void SoftwareRenderDevice::Draw(std::size_t vertexCount, std::size_t firstVertex)
+	{
+		statistics = {};
+		if (!vertexShader || vertexBuffer >= buffers.size() || vertexStride == 0)
+		{
+			return;
+		}
+
+		// the whole triangles within the buffer
+		const std::size_t bufferSize = buffers[vertexBuffer].size();
+		const std::size_t availableVertices = vertexOffset < bufferSize ? (bufferSize - vertexOffset) / vertexStride : 0;
+		const std::size_t drawnVertices = firstVertex < availableVertices ? (std::min)(vertexCount, availableVertices - firstVertex) : 0;
+		const std::size_t triangleCount = drawnVertices / 3;
+		const std::size_t batchCount = (triangleCount + trianglesPerBatch - 1) / trianglesPerBatch;
+		const std::size_t tileCount = (std::size_t)tilesX * tilesY;
+
+		triangles.resize(triangleCount);
+		if (bins.size() < batchCount * tileCount)
+		{
+			bins.resize(batchCount * tileCount);
+		}
+		batchVisibleTriangles.assign(batchCount, 0);
+		tileShadedPixels.assign(tileCount, 0);
+
+		ForEach(jobSystem, batchCount, [this, triangleCount, firstVertex](std::size_t batch) { SetUpBatch(batch, triangleCount, firstVertex); });
+		ForEach(jobSystem, tileCount, [this, batchCount](std::size_t tile) { RasterizeTile(tile, batchCount); });
+
+		statistics.triangles = triangleCount;
+		for (std::size_t batch = 0; batch < batchCount; batch++)
+		{
+			statistics.visibleTriangles += batchVisibleTriangles[batch];
+			for (std::size_t tile = 0; tile < tileCount; tile++)
+			{
+				statistics.binnedTriangles += bins[batch * tileCount + tile].size();
+			}
+		}
+		for (std::size_t pixels : tileShadedPixels)
+		{
+			statistics.shadedPixels += pixels;
+		}
+	}
+
+	util::Expected<void> SoftwareRenderDevice::Present()
+	{
+		// the picture is in the framebuffer already
+		presentedFrames++;
+		return {};
+	}
+
+	void SoftwareRenderDevice::SetUpBatch(std::size_t batch, std::size_t triangleCount, std::size_t firstVertex)
+	{
+		const std::size_t tileCount = (std::size_t)tilesX * tilesY;
+		std::vector<std::uint32_t>* batchBins = &bins[batch * tileCount];
+		for (std::size_t tile = 0; tile < tileCount; tile++)
+		{
+			batchBins[tile].clear();
+		}
+
+		const unsigned char* vertices = buffers[vertexBuffer].data() + vertexOffset + firstVertex * vertexStride;
+		const std::size_t first = batch * trianglesPerBatch;
+		const std::size_t last = (std::min)(first + trianglesPerBatch, triangleCount);
+		for (std::size_t index = first; index < last; index++)
+		{
+			// the vertex shader, then the viewport: y points down, in fixed point
+			ShaderVertex shaded[3];
+			std::int64_t x[3], y[3];
+			bool isInside = true;
+			for (std::size_t vertex = 0; vertex < 3; vertex++)
+			{
+				vertexShader(vertices + (index * 3 + vertex) * vertexStride, shaded[vertex]);
+				const float w = shaded[vertex].position[3];
+				const float screenX = (shaded[vertex].position[0] / w * 0.5f + 0.5f) * width;
+				const float screenY = (0.5f - shaded[vertex].position[1] / w * 0.5f) * height;
+				isInside = isInside && w > 0.0f && std::fabs(screenX) < guardBand && std::fabs(screenY) < guardBand;
+				if (!isInside)
+				{
+					break;
+				}
+				x[vertex] = (std::int64_t)std::floor(screenX * subpixels + 0.5f);
+				y[vertex] = (std::int64_t)std::floor(screenY * subpixels + 0.5f);
+			}
+			if (!isInside)
+			{
+				continue;
+			}
+
+			// clockwise on the screen faces the viewer; the other triangles and the empty ones are culled
+			const std::int64_t area = (x[1] - x[0]) * (y[2] - y[0]) - (x[2] - x[0]) * (y[1] - y[0]);
+			if (area <= 0)
+			{
+				continue;
+			}
+
+			// the pixels whose centers may be inside
+			const float minX = (float)(std::min)({ x[0], x[1], x[2] }) / subpixels - 0.5f;
+			const float maxX = (float)(std::max)({ x[0], x[1], x[2] }) / subpixels - 0.5f;
+			const float minY = (float)(std::min)({ y[0], y[1], y[2] }) / subpixels - 0.5f;
+			const float maxY = (float)(std::max)({ y[0], y[1], y[2] }) / subpixels - 0.5f;
+			Triangle& triangle = triangles[index];
+			triangle.minX = (int)std::ceil((std::max)(minX, 0.0f));
+			triangle.maxX = (int)std::floor((std::min)(maxX, (float)(width - 1)));
+			triangle.minY = (int)std::ceil((std::max)(minY, 0.0f));
+			triangle.maxY = (int)std::floor((std::min)(maxY, (float)(height - 1)));
+			if (triangle.minX > triangle.maxX || triangle.minY > triangle.maxY)
+			{
+				continue;
+			}
+
+			// the edge opposite to each vertex: its function is the weight of the vertex, times twice the area; the
+			// pixels on the top and left edges are inside, the others outside, thus C is one less for the latter
+			for (std::size_t edge = 0; edge < 3; edge++)
+			{
+				const std::size_t a = (edge + 1) % 3;
+				const std::size_t b = (edge + 2) % 3;
+				const std::int64_t edgeA = y[a] - y[b];
+				const std::int64_t edgeB = x[b] - x[a];
+				const bool isTopLeft = edgeA > 0 || (edgeA == 0 && edgeB > 0);
+				triangle.edges[edge][0] = edgeA;
+				triangle.edges[edge][1] = edgeB;
+				triangle.edges[edge][2] = x[a] * y[b] - x[b] * y[a] - (isTopLeft ? 0 : 1);
+
+				triangle.depths[edge] = shaded[edge].position[2] / shaded[edge].position[3];
+				for (std::size_t channel = 0; channel < 4; channel++)
+				{
+					triangle.colors[edge][channel] = shaded[edge].color[channel];
+				}
+			}
+			triangle.inverseArea = 1.0f / (float)area;
+			batchVisibleTriangles[batch]++;
+
+			// the tiles the triangle may cover: no edge function is negative at all of their pixel centers
+			for (int tileY = triangle.minY / (int)tileSize; tileY <= triangle.maxY / (int)tileSize; tileY++)
+			{
+				const std::int64_t top = (std::int64_t)tileY * tileSize * subpixelSize + halfPixel;
+				const std::int64_t bottom = ((std::int64_t)(std::min)((tileY + 1) * tileSize, height) - 1) * subpixelSize + halfPixel;
+				for (int tileX = triangle.minX / (int)tileSize; tileX <= triangle.maxX / (int)tileSize; tileX++)
+				{
+					const std::int64_t left = (std::int64_t)tileX * tileSize * subpixelSize + halfPixel;
+					const std::int64_t right = ((std::int64_t)(std::min)((tileX + 1) * tileSize, width) - 1) * subpixelSize + halfPixel;
+					bool isCovered = true;
+					for (std::size_t edge = 0; edge < 3 && isCovered; edge++)
+					{
+						const std::int64_t* e = triangle.edges[edge];
+						isCovered = e[0] * (e[0] > 0 ? right : left) + e[1] * (e[1] > 0 ? bottom : top) + e[2] >= 0;
+					}
+					if (isCovered)
+					{
+						batchBins[(std::size_t)tileY * tilesX + tileX].push_back((std::uint32_t)index);
+					}
+				}
+			}
+		}
+	}
+
+	void SoftwareRenderDevice::RasterizeTile(std::size_t tile, std::size_t batchCount)
+	{
+		const std::size_t tileCount = (std::size_t)tilesX * tilesY;
+		const int minX = (int)((tile % tilesX) * tileSize);
+		const int minY = (int)((tile / tilesX) * tileSize);
+		const int maxX = (std::min)(minX + (int)tileSize, (int)width) - 1;
+		const int maxY = (std::min)(minY + (int)tileSize, (int)height) - 1;
+
+		// the batches in order, thus the triangles in the order of the draw
+		std::size_t shadedPixels = 0;
+		for (std::size_t batch = 0; batch < batchCount; batch++)
+		{
+			for (std::uint32_t index : bins[batch * tileCount + tile])
+			{
+				RasterizeTriangle(triangles[index], minX, minY, maxX, maxY, shadedPixels);
+			}
+		}
+		tileShadedPixels[tile] = shadedPixels;
+	}
+
+	void SoftwareRenderDevice::RasterizeTriangle(const Triangle& triangle, int minX, int minY, int maxX, int maxY, std::size_t& shadedPixels)
+	{
+		minX = (std::max)(minX, triangle.minX);
+		minY = (std::max)(minY, triangle.minY);
+		maxX = (std::min)(maxX, triangle.maxX);
+		maxY = (std::min)(maxY, triangle.maxY);
+
+		const std::int64_t* e0 = triangle.edges[0];
+		const std::int64_t* e1 = triangle.edges[1];
+		const std::int64_t* e2 = triangle.edges[2];
+		const std::int64_t left = (std::int64_t)minX * subpixelSize + halfPixel;
+		for (int pixelY = minY; pixelY <= maxY; pixelY++)
+		{
+			// the edge functions are exact, thus stepping along the row gives the same values as evaluating every pixel
+			const std::int64_t centerY = (std::int64_t)pixelY * subpixelSize + halfPixel;
+			std::int64_t w0 = e0[0] * left + e0[1] * centerY + e0[2];
+			std::int64_t w1 = e1[0] * left + e1[1] * centerY + e1[2];
+			std::int64_t w2 = e2[0] * left + e2[1] * centerY + e2[2];
+			std::uint32_t* colorRow = colors.data() + (std::size_t)pixelY * width;
+			float* depthRow = depths.data() + (std::size_t)pixelY * width;
+
+			for (int pixelX = minX; pixelX <= maxX; pixelX++, w0 += e0[0] * subpixelSize, w1 += e1[0] * subpixelSize, w2 += e2[0] * subpixelSize)
+			{
+				if ((w0 | w1 | w2) < 0)
+				{
+					continue;
+				}
+
+				// the weights of the vertices; pixels outside of the depth range are clipped
+				const float l0 = (float)w0 * triangle.inverseArea;
+				const float l1 = (float)w1 * triangle.inverseArea;
+				const float l2 = (float)w2 * triangle.inverseArea;
+				const float depth = l0 * triangle.depths[0] + l1 * triangle.depths[1] + l2 * triangle.depths[2];
+				if (!(depth >= 0.0f && depth <= 1.0f && depth < depthRow[pixelX]))
+				{
+					continue;
+				}
+				depthRow[pixelX] = depth;
+
+				float color[4];
+				for (std::size_t channel = 0; channel < 4; channel++)
+				{
+					color[channel] = l0 * triangle.colors[0][channel] + l1 * triangle.colors[1][channel] + l2 * triangle.colors[2][channel];
+				}
+				if (pixelShader)
+				{
+					const ShaderVertex input = { { pixelX + 0.5f, pixelY + 0.5f, depth, 1.0f }, { color[0], color[1], color[2], color[3] } };
+					pixelShader(input, color);
+				}
+				colorRow[pixelX] = ToColor(color);
+				shadedPixels++;
+			}
+		}
+	}
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* SoftwareRenderDevice.h
+*
+* A render device that rasterizes on the CPU into a framebuffer in memory, on all threads of the job system
+*
+* A draw runs in two parallel passes:
+* - setup: the triangles are split into batches of trianglesPerBatch; every batch runs the vertex shader, maps the
+*   vertices to the viewport, culls the back faces and sorts its triangles into the tiles of the screen they may cover
+* - rasterization: every tile of tileSize * tileSize pixels is a job, which draws the triangles of all batches into it,
+*   in the order of the draw
+*
+* A tile belongs to a single thread, thus the framebuffer needs no locks. Every pixel is computed from the triangle and
+* its own coordinates, not from its neighbours, thus the picture is the same bit for bit with any number of threads and
+* any tile size.
+*
+* The rasterization follows Direct3D: the vertices are snapped to 1/256 of a pixel, pixels are sampled at their centers
+* and the top-left rule decides who draws the pixels on shared edges, thus adjacent triangles never draw a pixel twice or
+* leave a gap. The edge functions are exact, in 64-bit integers; vertices more than 16384 pixels off the screen drop
+* their triangle. Attributes are interpolated linearly in screen space and pixels outside of the depth range [0, 1] are
+* clipped; both are exact for the orthographic vertices of the game, whose w is 1. Triangles with a vertex at w <= 0 are
+* dropped.
+*
+* The framebuffer holds RGBA bytes, red in the lowest byte, and a float depth per pixel.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstdint>			// fixed width integers
+#include <vector>			// vector containers
+
+// Project includes
+#include "RenderDevice.h"
+
+#pragma endregion
+
+// Forward declarations
+namespace util
+{
+	class JobSystem;
+}
+
+namespace graphics
+{
+	// Counters of the last draw
+	struct RasterizerStatistics
+	{
+		std::size_t triangles;				// triangles drawn
+		std::size_t visibleTriangles;		// after culling
+		std::size_t binnedTriangles;		// triangles times the tiles they were sorted into
+		std::size_t shadedPixels;			// pixels that passed the depth test
+	};
+
+	class SoftwareRenderDevice : public RenderDevice
+	{
+	public:
+		// Runs on the calling thread if there is no job system
+		SoftwareRenderDevice(unsigned int width, unsigned int height, util::JobSystem* jobSystem, unsigned int tileSize = 64, std::size_t trianglesPerBatch = 256);
+		~SoftwareRenderDevice() {};
+
+		util::Expected<BufferHandle> CreateBuffer(std::size_t size) override;
+		util::Expected<void*> MapBuffer(BufferHandle buffer, MapMode mode) override;
+		void UnmapBuffer(BufferHandle /*buffer*/) override {};
+
+		void SetVertexBuffer(BufferHandle buffer, std::size_t stride, std::size_t offset) override;
+		void SetShaders(const VertexShaderFunction& vertexShader, const PixelShaderFunction& pixelShader) override;
+
+		void Clear(const float* rgba) override;
+		void Draw(std::size_t vertexCount, std::size_t firstVertex) override;
+		util::Expected<void> Present() override;
+
+		// Getters
+		unsigned int GetWidth() const { return width; };
+		unsigned int GetHeight() const { return height; };
+		const std::vector<std::uint32_t>& GetFramebuffer() const { return colors; };		// row by row, top down
+		const RasterizerStatistics& GetStatistics() const { return statistics; };
+		unsigned long long GetPresentedFrames() const { return presentedFrames; };
+
+	private:
+		// A triangle in screen space, ready to be rasterized; the coordinates are fixed point, in 1/256 of a pixel
+		struct Triangle
+		{
+			std::int64_t edges[3][3];		// A, B, C of the edge functions A * x + B * y + C, non-negative inside
+			float inverseArea;				// 1 / twice the area
+			float depths[3];
+			float colors[3][4];
+			int minX, minY, maxX, maxY;		// the pixels whose centers may be inside
+		};
+
+		void SetUpBatch(std::size_t batch, std::size_t triangleCount, std::size_t firstVertex);
+		void RasterizeTile(std::size_t tile, std::size_t batchCount);
+		void RasterizeTriangle(const Triangle& triangle, int minX, int minY, int maxX, int maxY, std::size_t& shadedPixels);
+
+		const unsigned int width;
+		const unsigned int height;
+		util::JobSystem* jobSystem;							// null to run on the calling thread
+		const unsigned int tileSize;						// pixels per side of a tile
+		const unsigned int tilesX;							// tiles per row
+		const unsigned int tilesY;							// rows of tiles
+		const std::size_t trianglesPerBatch;				// triangles per setup job
+
+		// the render target
+		std::vector<std::uint32_t> colors;
+		std::vector<float> depths;
+
+		// the state of the next draws
+		std::vector<std::vector<unsigned char>> buffers;
+		BufferHandle vertexBuffer;
+		std::size_t vertexStride;
+		std::size_t vertexOffset;
+		VertexShaderFunction vertexShader;
+		PixelShaderFunction pixelShader;
+
+		// the work of a draw, kept to reuse the memory
+		std::vector<Triangle> triangles;					// in the order of the draw
+		std::vector<std::vector<std::uint32_t>> bins;		// per batch and tile: the triangles that may cover the tile
+		std::vector<std::size_t> batchVisibleTriangles;		// per batch
+		std::vector<std::size_t> tileShadedPixels;			// per tile
+
+		RasterizerStatistics statistics;
+		unsigned long long presentedFrames;
+	};
+}
@@ -0,0 +1,417 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Starfield.cpp
+*
+* The stars of the starfield: stored as a structure of arrays, spawned at random, simulated and packed into vertices,
+* vectorized and on all threads of the job system
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::copy, std::fill
+
+// Project includes
+#include "Starfield.h"
+#include "JobSystem.h"
+#include "Random.h"
+
+// the widest instruction sets the compiler targets
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define STARFIELD_SSE2 1
+#include <emmintrin.h>		// SSE2 intrinsics
+#endif
+
+// Visual C++ has no macro for F16C, but every processor with AVX2 has it
+#if defined(__F16C__) || (defined(_MSC_VER) && defined(__AVX2__))
+#define STARFIELD_F16C 1
+#include <immintrin.h>		// F16C intrinsics
+#endif
+
+#pragma endregion
+
+namespace graphics
+{
+	namespace
+	{
+		// every random component is a stream of Philox4x32, the number of a star in the stream being its index
+		const std::size_t spawnedComponents = StarField::spawnedStreamCount;
+
+		// the ranges of the components: positions in [-1, 1), colors in [0, 1), velocities in [-0.25, 0.25) and lifetimes
+		// in [1, 5); the widths are powers of two, thus the floats are exact
+		const float minimums[spawnedComponents] = { -1.0f, -1.0f, -1.0f, 0.0f, 0.0f, 0.0f, -0.25f, -0.25f, -0.25f, 1.0f };
+		const float maximums[spawnedComponents] = { 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 0.25f, 0.25f, 0.25f, 5.0f };
+
+		// the spring toward the center, per second squared and unit of distance
+		const float attraction = 0.5f;
+
+		// the axes of the positions, the previous positions and the velocities
+		const StarStream positionStreams[3] = { StarStream::x, StarStream::y, StarStream::z };
+		const StarStream previousStreams[3] = { StarStream::previousX, StarStream::previousY, StarStream::previousZ };
+		const StarStream velocityStreams[3] = { StarStream::velocityX, StarStream::velocityY, StarStream::velocityZ };
+
+		// what rendering needs
+		const StarStream renderStreams[] = { StarStream::x, StarStream::y, StarStream::z, StarStream::red, StarStream::green, StarStream::blue, StarStream::previousX, StarStream::previousY, StarStream::previousZ };
+
+		// the arrays of a starfield, looked up once per kernel
+		struct Streams
+		{
+			explicit Streams(StarField& stars)
+			{
+				for (std::size_t stream = 0; stream < StarField::streamCount; stream++)
+				{
+					data[stream] = stars.GetStream((StarStream)stream);
+				}
+			};
+
+			float* operator[](StarStream stream) const { return data[(std::size_t)stream]; };
+
+			float* data[StarField::streamCount];
+		};
+
+		// the generator of a component, at the first star
+		inline Philox4x32 GetSpawnGenerator(std::size_t component, std::uint64_t key, std::size_t star)
+		{
+			Philox4x32 generator(key, component);
+			generator.Discard(star);
+			return generator;
+		}
+
+		// a newborn star is where it was
+		void ResetSpawned(const Streams& streams, std::size_t first, std::size_t last)
+		{
+			std::fill(streams[StarStream::age] + first, streams[StarStream::age] + last, 0.0f);
+			for (std::size_t axis = 0; axis < 3; axis++)
+			{
+				std::copy(streams[positionStreams[axis]] + first, streams[positionStreams[axis]] + last, streams[previousStreams[axis]] + first);
+			}
+		}
+
+		void SpawnStar(const Streams& streams, std::size_t star, std::uint64_t key)
+		{
+			for (std::size_t component = 0; component < spawnedComponents; component++)
+			{
+				streams.data[component][star] = GetSpawnGenerator(component, key, star).NextFloat(minimums[component], maximums[component]);
+			}
+			ResetSpawned(streams, star, star + 1);
+		}
+
+		// a color channel in [0, 1] as a byte; NaN is black, as with the SIMD kernel
+		inline std::uint32_t ToByte(float value)
+		{
+			value = value > 0.0f ? value : 0.0f;
+			value = value < 1.0f ? value : 1.0f;
+			return (std::uint32_t)(value * 255.0f + 0.5f);
+		}
+
+#if STARFIELD_SSE2
+		// four stars at a time; returns the lanes of the stars that died
+		inline int SimulateVector(const Streams& streams, std::size_t star, __m128 dt, __m128 pull)
+		{
+			for (std::size_t axis = 0; axis < 3; axis++)
+			{
+				float* position = streams[positionStreams[axis]] + star;
+				float* velocity = streams[velocityStreams[axis]] + star;
+				const __m128 oldPosition = _mm_loadu_ps(position);
+				const __m128 newVelocity = _mm_sub_ps(_mm_loadu_ps(velocity), _mm_mul_ps(oldPosition, pull));
+				_mm_storeu_ps(streams[previousStreams[axis]] + star, oldPosition);
+				_mm_storeu_ps(velocity, newVelocity);
+				_mm_storeu_ps(position, _mm_add_ps(oldPosition, _mm_mul_ps(newVelocity, dt)));
+			}
+
+			float* age = streams[StarStream::age] + star;
+			const __m128 newAge = _mm_add_ps(_mm_loadu_ps(age), dt);
+			_mm_storeu_ps(age, newAge);
+			return _mm_movemask_ps(_mm_cmpnlt_ps(newAge, _mm_loadu_ps(streams[StarStream::lifetime] + star)));
+		}
+
+		// four half floats in the lower 16 bits of the lanes
+		inline __m128i ToHalves(__m128 values)
+		{
+#if STARFIELD_F16C
+			return _mm_unpacklo_epi16(_mm_cvtps_ph(values, _MM_FROUND_TO_NEAREST_INT), _mm_setzero_si128());
+#else
+			// FloatToHalf, branch-free
+			__m128i bits = _mm_castps_si128(values);
+			const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32((int)0x80000000U));
+			bits = _mm_xor_si128(bits, sign);
+
+			const __m128i isOverflow = _mm_cmpgt_epi32(bits, _mm_set1_epi32((143 << 23) - 1));
+			const __m128i isSubnormal = _mm_cmpgt_epi32(_mm_set1_epi32(113 << 23), bits);
+			const __m128i infinity = _mm_set1_epi32(0x7c00);
+			const __m128i overflow = _mm_or_si128(infinity, _mm_and_si128(_mm_cmpgt_epi32(bits, _mm_set1_epi32(255 << 23)), _mm_set1_epi32(0x0200)));
+
+			const __m128i subnormalMagic = _mm_set1_epi32(126 << 23);
+			const __m128i subnormal = _mm_sub_epi32(_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(bits), _mm_castsi128_ps(subnormalMagic))), subnormalMagic);
+
+			const __m128i odd = _mm_and_si128(_mm_srli_epi32(bits, 13), _mm_set1_epi32(1));
+			const __m128i normal = _mm_srli_epi32(_mm_add_epi32(_mm_add_epi32(bits, _mm_set1_epi32((int)((std::uint32_t)(15 - 127) * (1U << 23) + 0xfff))), odd), 13);
+
+			__m128i halves = _mm_or_si128(_mm_and_si128(isSubnormal, subnormal), _mm_andnot_si128(isSubnormal, normal));
+			halves = _mm_or_si128(_mm_and_si128(isOverflow, overflow), _mm_andnot_si128(isOverflow, halves));
+			return _mm_or_si128(halves, _mm_srli_epi32(sign, 16));
+#endif
+		}
+
+		// four color channels as bytes in the lower 8 bits of the lanes
+		inline __m128i ToBytes(__m128 values)
+		{
+			values = _mm_min_ps(_mm_max_ps(values, _mm_setzero_ps()), _mm_set1_ps(1.0f));
+			return _mm_cvttps_epi32(_mm_add_ps(_mm_mul_ps(values, _mm_set1_ps(255.0f)), _mm_set1_ps(0.5f)));
+		}
+
+		// four positions at the farseer between the previous and the current ones, as half floats
+		inline __m128i InterpolateToHalves(const float* previous, const float* current, __m128 farseer)
+		{
+			const __m128 from = _mm_loadu_ps(previous);
+			return ToHalves(_mm_add_ps(from, _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(current), from), farseer)));
+		}
+
+		void PackVectors(const StarField& stars, PackedVertex* vertices, std::size_t first, std::size_t vectors, float farseer)
+		{
+			const __m128 t = _mm_set1_ps(farseer);
+			for (std::size_t vector = 0; vector < vectors; vector++)
+			{
+				const std::size_t star = first + vector * 4;
+				alignas(16) std::uint32_t x[4], y[4], z[4], colors[4];
+				_mm_store_si128(reinterpret_cast<__m128i*>(x), InterpolateToHalves(stars.GetStream(StarStream::previousX) + star, stars.GetStream(StarStream::x) + star, t));
+				_mm_store_si128(reinterpret_cast<__m128i*>(y), InterpolateToHalves(stars.GetStream(StarStream::previousY) + star, stars.GetStream(StarStream::y) + star, t));
+				_mm_store_si128(reinterpret_cast<__m128i*>(z), InterpolateToHalves(stars.GetStream(StarStream::previousZ) + star, stars.GetStream(StarStream::z) + star, t));
+
+				const __m128i red = ToBytes(_mm_loadu_ps(stars.GetStream(StarStream::red) + star));
+				const __m128i green = _mm_slli_epi32(ToBytes(_mm_loadu_ps(stars.GetStream(StarStream::green) + star)), 8);
+				const __m128i blue = _mm_slli_epi32(ToBytes(_mm_loadu_ps(stars.GetStream(StarStream::blue) + star)), 16);
+				const __m128i alpha = _mm_set1_epi32((int)0xff000000U);
+				_mm_store_si128(reinterpret_cast<__m128i*>(colors), _mm_or_si128(_mm_or_si128(red, green), _mm_or_si128(blue, alpha)));
+
+				// the vertices are 12 bytes, thus four of them are three unaligned vectors: written one by one
+				for (std::size_t lane = 0; lane < 4; lane++)
+				{
+					vertices[star + lane] = { (std::uint16_t)x[lane], (std::uint16_t)y[lane], (std::uint16_t)z[lane], halfOne, colors[lane] };
+				}
+			}
+		}
+#endif
+	}
+
+	void StarField::Resize(std::size_t size)
+	{
+		this->size = size;
+		for (std::vector<float>& stream : streams)
+		{
+			stream.resize(size);
+		}
+	}
+
+	void StarField::CopyRenderState(const StarField& source)
+	{
+		// the vectors keep their capacity, thus only the first copy allocates
+		size = source.size;
+		for (StarStream stream : renderStreams)
+		{
+			streams[(std::size_t)stream].assign(source.streams[(std::size_t)stream].begin(), source.streams[(std::size_t)stream].end());
+		}
+	}
+
+	std::uint64_t GetStarfieldKey(std::uint32_t seed, std::uint64_t step)
+	{
+		// Philox4x32 scrambles its key, thus consecutive steps get unrelated numbers
+		return (std::uint64_t)seed | (std::uint64_t)(std::uint32_t)step << 32;
+	}
+
+#pragma region "Spawning"
+
+	void SpawnStarsScalar(StarField& stars, std::size_t first, std::size_t last, std::uint64_t key)
+	{
+		const Streams streams(stars);
+		for (std::size_t component = 0; component < spawnedComponents; component++)
+		{
+			Philox4x32 generator = GetSpawnGenerator(component, key, first);
+			float* out = streams.data[component];
+			for (std::size_t star = first; star < last; star++)
+			{
+				out[star] = generator.NextFloat(minimums[component], maximums[component]);
+			}
+		}
+		ResetSpawned(streams, first, last);
+	}
+
+	void SpawnStars(StarField& stars, std::size_t first, std::size_t last, std::uint64_t key)
+	{
+		// the fill of Philox4x32 is vectorized where it can be
+		const Streams streams(stars);
+		for (std::size_t component = 0; component < spawnedComponents; component++)
+		{
+			GetSpawnGenerator(component, key, first).Fill(streams.data[component] + first, last - first, minimums[component], maximums[component]);
+		}
+		ResetSpawned(streams, first, last);
+	}
+
+	void SpawnStarfield(StarField& stars, std::uint64_t key, util::JobSystem* jobSystem, std::size_t starsPerJob)
+	{
+		if (!jobSystem || stars.GetSize() <= starsPerJob)
+		{
+			SpawnStars(stars, 0, stars.GetSize(), key);
+			return;
+		}
+
+		StarField* field = &stars;
+		jobSystem->ParallelFor(0, stars.GetSize(), starsPerJob, [field, key](std::size_t first, std::size_t last)
+		{
+			SpawnStars(*field, first, last, key);
+		});
+	}
+
+#pragma endregion
+
+#pragma region "Simulation"
+
+	void SimulateStarsScalar(StarField& stars, std::size_t first, std::size_t last, float dt, std::uint64_t key)
+	{
+		const Streams streams(stars);
+		const float pull = attraction * dt;
+		float* age = streams[StarStream::age];
+		const float* lifetime = streams[StarStream::lifetime];
+		for (std::size_t star = first; star < last; star++)
+		{
+			// semi-implicit Euler: the new velocity moves the star
+			for (std::size_t axis = 0; axis < 3; axis++)
+			{
+				float& position = streams[positionStreams[axis]][star];
+				float& velocity = streams[velocityStreams[axis]][star];
+				streams[previousStreams[axis]][star] = position;
+				velocity = velocity - position * pull;
+				position = position + velocity * dt;
+			}
+
+			age[star] = age[star] + dt;
+			if (!(age[star] < lifetime[star]))
+			{
+				SpawnStar(streams, star, key);
+			}
+		}
+	}
+
+	void SimulateStars(StarField& stars, std::size_t first, std::size_t last, float dt, std::uint64_t key)
+	{
+#if STARFIELD_SSE2
+		// whole vectors in SIMD, then the stars that died one by one, then the rest one star at a time
+		const Streams streams(stars);
+		const __m128 step = _mm_set1_ps(dt);
+		const __m128 pull = _mm_set1_ps(attraction * dt);
+		for (; last - first >= 4; first += 4)
+		{
+			int deaths = SimulateVector(streams, first, step, pull);
+			for (std::size_t lane = 0; deaths != 0; lane++, deaths >>= 1)
+			{
+				if (deaths & 1)
+				{
+					SpawnStar(streams, first + lane, key);
+				}
+			}
+		}
+#endif
+		SimulateStarsScalar(stars, first, last, dt, key);
+	}
+
+	void SimulateStarfield(StarField& stars, float dt, std::uint64_t key, util::JobSystem* jobSystem, std::size_t starsPerJob)
+	{
+		if (!jobSystem || stars.GetSize() <= starsPerJob)
+		{
+			SimulateStars(stars, 0, stars.GetSize(), dt, key);
+			return;
+		}
+
+		StarField* field = &stars;
+		jobSystem->ParallelFor(0, stars.GetSize(), starsPerJob, [field, dt, key](std::size_t first, std::size_t last)
+		{
+			SimulateStars(*field, first, last, dt, key);
+		});
+	}
+
+#pragma endregion
+
+#pragma region "Packing"
+
+	void PackStarsScalar(const StarField& stars, PackedVertex* vertices, std::size_t first, std::size_t last, float farseer)
+	{
+		const float* x = stars.GetStream(StarStream::x);
+		const float* y = stars.GetStream(StarStream::y);
+		const float* z = stars.GetStream(StarStream::z);
+		const float* previousX = stars.GetStream(StarStream::previousX);
+		const float* previousY = stars.GetStream(StarStream::previousY);
+		const float* previousZ = stars.GetStream(StarStream::previousZ);
+		const float* red = stars.GetStream(StarStream::red);
+		const float* green = stars.GetStream(StarStream::green);
+		const float* blue = stars.GetStream(StarStream::blue);
+		for (std::size_t star = first; star < last; star++)
+		{
+			const std::uint16_t halfX = FloatToHalf(previousX[star] + (x[star] - previousX[star]) * farseer);
+			const std::uint16_t halfY = FloatToHalf(previousY[star] + (y[star] - previousY[star]) * farseer);
+			const std::uint16_t halfZ = FloatToHalf(previousZ[star] + (z[star] - previousZ[star]) * farseer);
+			const std::uint32_t color = ToByte(red[star]) | ToByte(green[star]) << 8 | ToByte(blue[star]) << 16 | 0xff000000U;
+			vertices[star] = { halfX, halfY, halfZ, halfOne, color };
+		}
+	}
+
+	void PackStars(const StarField& stars, PackedVertex* vertices, std::size_t first, std::size_t last, float farseer)
+	{
+#if STARFIELD_SSE2
+		const std::size_t vectors = (last - first) / 4;
+		PackVectors(stars, vertices, first, vectors, farseer);
+		first += vectors * 4;
+#endif
+		PackStarsScalar(stars, vertices, first, last, farseer);
+	}
+
+	void PackStarfield(const StarField& stars, PackedVertex* vertices, float farseer, util::JobSystem* jobSystem, std::size_t starsPerJob)
+	{
+		if (!jobSystem || stars.GetSize() <= starsPerJob)
+		{
+			PackStars(stars, vertices, 0, stars.GetSize(), farseer);
+			return;
+		}
+
+		const StarField* field = &stars;
+		jobSystem->ParallelFor(0, stars.GetSize(), starsPerJob, [field, vertices, farseer](std::size_t first, std::size_t last)
+		{
+			PackStars(*field, vertices, first, last, farseer);
+		});
+	}
+
+#pragma endregion
+
+	const char* GetSpawningKernelName()
+	{
+		// the fill of Philox4x32
+#if STARFIELD_SSE2
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+	const char* GetSimulationKernelName()
+	{
+#if STARFIELD_SSE2
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+
+	const char* GetPackingKernelName()
+	{
+#if STARFIELD_F16C
+		return "sse2+f16c";
+#elif STARFIELD_SSE2
+		return "sse2";
+#else
+		return "scalar";
+#endif
+	}
+}
@@ -0,0 +1,129 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Starfield.h
+*
+* The stars of the starfield: stored as a structure of arrays, spawned at random, simulated and packed into vertices,
+* vectorized and on all threads of the job system
+*
+* Each component of the stars has its own array, thus the kernels load and store whole vectors of one component and
+* never shuffle. The packing stage turns the arrays into the 12-byte vertices the GPU reads: half the bytes of the full
+* vertex to write through the mapped vertex buffer.
+*
+* A star lives for a random time, then spawns again somewhere else. In between, it moves: a spring pulls it toward the
+* center of the starfield, integrated with semi-implicit Euler, i.e. first the velocity, then the position with the new
+* velocity, which keeps the orbits stable. Every step keeps the previous positions, thus the stars can be drawn anywhere
+* between the last two steps: the farseer of the game loop.
+*
+* The random numbers come from Philox4x32 of Random.h, which is counter-based: the key is the seed and the number of the
+* step, every spawned component has its own stream, and the number of a star in that stream is its index. No state is
+* carried from one number to the next, thus any range of stars can be spawned on its own, in any order and with any
+* instruction set, and the starfield is the same bit for bit no matter how it is split among the threads.
+*
+* The SIMD kernels and the scalar ones do the same floating point operations in the same order, thus they agree bit for
+* bit; packing rounds to the nearest even everywhere. Spawning uses the SSE2 fill of Philox4x32; simulating uses SSE2,
+* and packing SSE2 and F16C if the compiler targets it. Elsewhere, the scalar kernels run.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <vector>			// vector containers
+
+// Project includes
+#include "Vertex.h"
+
+#pragma endregion
+
+// Forward declarations
+namespace util
+{
+	class JobSystem;
+}
+
+namespace graphics
+{
+	// The components of a star, one array each; the first ones are random when a star spawns
+	enum class StarStream
+	{
+		x,
+		y,
+		z,
+		red,
+		green,
+		blue,
+		velocityX,
+		velocityY,
+		velocityZ,
+		lifetime,			// seconds, in [1, 5)
+		age,				// seconds since the star spawned
+		previousX,			// the position before the last step
+		previousY,
+		previousZ
+	};
+
+	class StarField
+	{
+	public:
+		static constexpr std::size_t streamCount = 14;
+		static constexpr std::size_t spawnedStreamCount = 10;		// the random streams, from x to lifetime
+
+		explicit StarField(std::size_t size = 0) { Resize(size); };
+		~StarField() {};
+
+		void Resize(std::size_t size);
+
+		// Copies what is needed to draw the stars: the positions, the previous positions and the colors; the other
+		// streams of this copy are empty
+		void CopyRenderState(const StarField& source);
+
+		// Getters
+		std::size_t GetSize() const { return size; };
+		float* GetStream(StarStream stream) { return streams[(std::size_t)stream].data(); };
+		const float* GetStream(StarStream stream) const { return streams[(std::size_t)stream].data(); };
+
+	private:
+		std::size_t size;								// number of stars
+		std::vector<float> streams[streamCount];		// one array per component
+	};
+
+	// The key of one step of the starfield, the spawns of the initial starfield being step 0: the seed in the lower half,
+	// the step in the upper half; the steps wrap after 2^32, more than two years at 60 steps per second
+	std::uint64_t GetStarfieldKey(std::uint32_t seed, std::uint64_t step);
+
+	// Spawns the stars [first, last) with the given key; the SIMD kernel, if there is one
+	void SpawnStars(StarField& stars, std::size_t first, std::size_t last, std::uint64_t key);
+
+	// Spawns the same stars one float at a time: the reference of the SIMD kernels
+	void SpawnStarsScalar(StarField& stars, std::size_t first, std::size_t last, std::uint64_t key);
+
+	// Spawns all stars, split into jobs of starsPerJob stars; runs on the calling thread if there is no job system
+	void SpawnStarfield(StarField& stars, std::uint64_t key, util::JobSystem* jobSystem, std::size_t starsPerJob = 4096);
+
+	// Moves the stars [first, last) by a step of dt seconds; the stars that die spawn again with the key of the step
+	void SimulateStars(StarField& stars, std::size_t first, std::size_t last, float dt, std::uint64_t key);
+	void SimulateStarsScalar(StarField& stars, std::size_t first, std::size_t last, float dt, std::uint64_t key);
+
+	// Moves all stars, split into jobs of starsPerJob stars; runs on the calling thread if there is no job system
+	void SimulateStarfield(StarField& stars, float dt, std::uint64_t key, util::JobSystem* jobSystem, std::size_t starsPerJob = 4096);
+
+	// Packs the stars [first, last) into vertices[first, last), at the farseer between their previous and their current
+	// positions; colors are clamped to [0, 1]
+	void PackStars(const StarField& stars, PackedVertex* vertices, std::size_t first, std::size_t last, float farseer);
+	void PackStarsScalar(const StarField& stars, PackedVertex* vertices, std::size_t first, std::size_t last, float farseer);
+
+	// Packs all stars, split into jobs of starsPerJob stars; runs on the calling thread if there is no job system
+	void PackStarfield(const StarField& stars, PackedVertex* vertices, float farseer, util::JobSystem* jobSystem, std::size_t starsPerJob = 4096);
+
+	// The names of the kernels used by SpawnStars, SimulateStars and PackStars
+	const char* GetSpawningKernelName();
+	const char* GetSimulationKernelName();
+	const char* GetPackingKernelName();
+}
@@ -9,7 +9,9 @@
 
 #pragma region "Includes"
 
-#include "stdafx.h"
+// C++ includes
+#include <codecvt>			// UTF-8 conversion
+#include <locale>			// std::wstring_convert
 
 #include "StringConverter.h"
 
@@ -11,7 +11,7 @@
 
 #pragma region "Includes"
 
-#include "stdafx.h"
+#include <string>			// strings
 
 #pragma endregion
 
@@ -0,0 +1,272 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* StructuredLogPolicy.cpp
+*
+* Log policy writing structured records instead of free-form text lines
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <functional>		// std::hash
+
+// Project includes
+#include "StructuredLogPolicy.h"
+
+#pragma endregion
+
+namespace util
+{
+	namespace
+	{
+		// Thread ids are opaque, their hash is stable for the lifetime of the thread
+		std::uint64_t GetNumericThreadId(std::thread::id id)
+		{
+			return static_cast<std::uint64_t>(std::hash<std::thread::id>()(id));
+		}
+	}
+
+	StructuredLogPolicy::StructuredLogPolicy(StructuredLogFormat format, std::unique_ptr<LogPolicyInterface> output) :
+		format(format),
+		output(output ? std::move(output) : std::unique_ptr<LogPolicyInterface>(new FileLogPolicy())),
+		line(),
+		scratch()
+	{
+		line.reserve(4 * LogRecord::argumentCapacity);
+		scratch.reserve(2 * LogRecord::argumentCapacity);
+	}
+
+	bool StructuredLogPolicy::OpenOutputStream(const std::wstring& filename)
+	{
+		if (!output->OpenOutputStream(filename))
+		{
+			return false;
+		}
+
+		if (format == StructuredLogFormat::chromeTrace)
+		{
+			output->Write("[");
+		}
+		return true;
+	}
+
+	void StructuredLogPolicy::CloseOutputStream()
+	{
+		// the trailing comma of the last event is allowed by the trace viewers, the closing bracket is optional
+		output->CloseOutputStream();
+	}
+
+	void StructuredLogPolicy::Write(const std::string& msg)
+	{
+		LogRecord record;
+		record.format = "{}";
+		record.timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		record.threadId = std::this_thread::get_id();
+		record.severity = SeverityType::info;
+		record.repeatCount = 0;
+		record.previousRepeatCount = 0;
+		LogArgumentEncoder(record).Encode(msg);
+		WriteRecord(record, std::string());
+	}
+
+	void StructuredLogPolicy::Flush()
+	{
+		output->Flush();
+	}
+
+	void StructuredLogPolicy::WriteRecord(const LogRecord& record, const std::string& threadName)
+	{
+		line.clear();
+		if (format == StructuredLogFormat::chromeTrace)
+		{
+			EncodeTraceEvent(record, threadName);
+		}
+		else
+		{
+			EncodeJsonLine(record, threadName);
+		}
+		output->Write(line);
+	}
+
+	void StructuredLogPolicy::EncodeJsonLine(const LogRecord& record, const std::string& threadName)
+	{
+		line += "{\"ts\":";
+		LogFormatter::AppendSigned(line, record.timestamp);
+		line += ",\"severity\":\"";
+		line += LogFormatter::GetSeverityName(record.severity);
+		line += "\",\"thread\":";
+		AppendString(threadName.data(), threadName.size());
+		line += ",\"tid\":";
+		LogFormatter::AppendUnsigned(line, GetNumericThreadId(record.threadId));
+
+		line += ",\"message\":";
+		scratch.clear();
+		LogFormatter::AppendMessage(scratch, record);
+		AppendString(scratch.data(), scratch.size());
+
+		if (record.repeatCount > 0)
+		{
+			line += ",\"repeated\":";
+			LogFormatter::AppendUnsigned(line, record.repeatCount);
+		}
+
+		line += ",\"fields\":{";
+		AppendFields(record);
+		line += "}}";
+	}
+
+	void StructuredLogPolicy::EncodeTraceEvent(const LogRecord& record, const std::string& threadName)
+	{
+		// instant event on the thread's track, the trace viewers expect microseconds
+		line += "{\"name\":";
+		scratch.clear();
+		LogFormatter::AppendMessage(scratch, record);
+		AppendString(scratch.data(), scratch.size());
+
+		line += ",\"cat\":\"";
+		line += LogFormatter::GetSeverityName(record.severity);
+		line += "\",\"ph\":\"i\",\"s\":\"t\",\"ts\":";
+		std::int64_t microseconds = record.timestamp / 1000;
+		std::int64_t nanoseconds = record.timestamp % 1000;
+		if (nanoseconds < 0)
+		{
+			microseconds--;
+			nanoseconds += 1000;
+		}
+		LogFormatter::AppendSigned(line, microseconds);
+		line += '.';
+		line += static_cast<char>('0' + nanoseconds / 100);
+		line += static_cast<char>('0' + nanoseconds / 10 % 10);
+		line += static_cast<char>('0' + nanoseconds % 10);
+		line += ",\"pid\":0,\"tid\":";
+		LogFormatter::AppendUnsigned(line, GetNumericThreadId(record.threadId));
+
+		line += ",\"args\":{\"thread\":";
+		AppendString(threadName.data(), threadName.size());
+		if (record.argumentSize > 0)
+		{
+			line += ',';
+			AppendFields(record);
+		}
+		line += "}},";
+	}
+
+	void StructuredLogPolicy::AppendFields(const LogRecord& record)
+	{
+		const char* argument = record.arguments;
+		std::size_t remainingBytes = record.argumentSize;
+		unsigned int index = 0;
+
+		for (const char* c = record.format; *c != '\0' && remainingBytes > 0; c++)
+		{
+			if (*c != '{')
+			{
+				continue;
+			}
+
+			const char* end = c + 1;
+			while (*end != '\0' && *end != '}')
+			{
+				end++;
+			}
+			if (*end != '}')
+			{
+				break;
+			}
+
+			// decode the value first, a corrupt argument ends the list
+			LogArgumentType type = static_cast<LogArgumentType>(argument[0]);
+			scratch.clear();
+			std::size_t used = LogFormatter::AppendArgument(scratch, argument, remainingBytes);
+			if (used == 0)
+			{
+				break;
+			}
+
+			if (index > 0)
+			{
+				line += ',';
+			}
+			if (end > c + 1)
+			{
+				AppendString(c + 1, static_cast<std::size_t>(end - c - 1));
+			}
+			else
+			{
+				line += "\"arg";
+				LogFormatter::AppendUnsigned(line, index);
+				line += '"';
+			}
+			line += ':';
+
+			switch (type)
+			{
+			case LogArgumentType::signedInteger:
+			case LogArgumentType::unsignedInteger:
+				line += scratch;
+				break;
+
+			case LogArgumentType::floatingPoint:
+				// JSON has no nan or infinity
+				if (scratch.find_first_of("ni") == std::string::npos)
+				{
+					line += scratch;
+				}
+				else
+				{
+					AppendString(scratch.data(), scratch.size());
+				}
+				break;
+
+			case LogArgumentType::boolean:
+				line += scratch == "1" ? "true" : "false";
+				break;
+
+			default:
+				AppendString(scratch.data(), scratch.size());
+				break;
+			}
+
+			argument += used;
+			remainingBytes -= used;
+			index++;
+			c = end;
+		}
+	}
+
+	void StructuredLogPolicy::AppendString(const char* text, std::size_t length)
+	{
+		static const char hexDigits[] = "0123456789abcdef";
+
+		line += '"';
+		for (std::size_t i = 0; i < length; i++)
+		{
+			unsigned char c = static_cast<unsigned char>(text[i]);
+			switch (c)
+			{
+			case '"': line += "\\\""; break;
+			case '\\': line += "\\\\"; break;
+			case '\n': line += "\\n"; break;
+			case '\r': line += "\\r"; break;
+			case '\t': line += "\\t"; break;
+			default:
+				if (c < 0x20)
+				{
+					line += "\\u00";
+					line += hexDigits[c >> 4];
+					line += hexDigits[c & 0xF];
+				}
+				else
+				{
+					line += static_cast<char>(c);
+				}
+				break;
+			}
+		}
+		line += '"';
+	}
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* StructuredLogPolicy.h
+*
+* Log policy writing structured records instead of free-form text lines
+*
+* JSON lines: one object per message
+*	{"ts":1500000000000000000,"severity":"debug","thread":"main","tid":42,"message":"resolution: 800 x 600","fields":{"width":800,"height":600}}
+*
+* Chrome trace: the JSON array format of the trace event profiler (chrome://tracing, Perfetto), one instant event per message
+* - https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+*
+* Named placeholders become fields of the same name, unnamed placeholders are called arg0, arg1, ...
+* The encoder reuses its buffers, thus steady-state logging does not allocate.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include "Log.h"
+
+#pragma endregion
+
+namespace util
+{
+	enum class StructuredLogFormat
+	{
+		jsonLines,			// one JSON object per line
+		chromeTrace,		// a JSON array of trace events, the closing bracket is optional, thus the file stays valid if the game crashes
+	};
+
+	class StructuredLogPolicy : public LogPolicyInterface
+	{
+	public:
+		// The encoded lines are handed to the output policy, a file log policy by default
+		StructuredLogPolicy(StructuredLogFormat format = StructuredLogFormat::jsonLines, std::unique_ptr<LogPolicyInterface> output = nullptr);
+		~StructuredLogPolicy() {};
+
+		bool OpenOutputStream(const std::wstring& filename) override;
+		void CloseOutputStream() override;
+		void Write(const std::string& msg) override;			// plain text is written as a message without fields
+		void Flush() override;
+
+		bool IsStructured() const override { return true; };
+		void WriteRecord(const LogRecord& record, const std::string& threadName) override;
+
+	private:
+		void EncodeJsonLine(const LogRecord& record, const std::string& threadName);
+		void EncodeTraceEvent(const LogRecord& record, const std::string& threadName);
+		void AppendFields(const LogRecord& record);			// "key":value,... for every placeholder of the format string
+		void AppendString(const char* text, std::size_t length);	// quoted and escaped
+
+	private:
+		const StructuredLogFormat format;					// JSON lines or Chrome trace
+		std::unique_ptr<LogPolicyInterface> output;			// where the encoded lines go
+		std::string line;									// the encoded record, reused for every message
+		std::string scratch;								// the decoded message or field value, reused for every message
+	};
+}
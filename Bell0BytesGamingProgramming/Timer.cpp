@@ -11,8 +11,6 @@
 
 #pragma region "Includes"
 
-#include "stdafx.h"
-
 // Project includes
 #include "ServiceLocator.h"
 #include "Timer.h"
@@ -22,7 +20,12 @@
 
 namespace core
 {
-	Timer::Timer() :
+	Timer::Timer(ClockSourceType clockSourceType) : Timer(ClockSource::Create(clockSourceType))
+	{
+	}
+
+	Timer::Timer(std::unique_ptr<ClockSource> clockSource) :
+		clockSource(std::move(clockSource)),
 		startTime(0),
 		totalIdleTime(0),
 		pausedTime(0),
@@ -32,58 +35,39 @@ namespace core
 		deltaTime(0.0),
 		isStopped(false)
 	{
-		long long int frequency = 0;
-		if (QueryPerformanceFrequency((LARGE_INTEGER*)&frequency))
-		{
-			// Seconds per count is the reciprocal of the frequency
-			secondsPerCount = 1.0 / (double)frequency;
-
-#ifndef NDEBUG
-			// log success
-			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The high-precision timer was created successfully.");
-#endif
-		}
-		else
+		if (!this->clockSource)
 		{
-			throw std::runtime_error("The hardware does not support a high-precision timer!");
+			throw std::runtime_error("The timer needs a clock source!");
 		}
+		secondsPerCount = this->clockSource->GetSecondsPerCount();
+
+		// log success
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The high-precision timer was created successfully, using the {clock} clock at {frequency} Hz.", this->clockSource->GetName(), 1.0 / secondsPerCount);
 	}
 
 	Timer::~Timer()
 	{
-#ifndef NDEBUG
 		// log success
-		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The timer was successfully destroyed.");
-#endif
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The timer was successfully destroyed.");
 	}
 
 	util::Expected<void> Timer::Start()
 	{
 		if (isStopped)
 		{
-			long long int now = 0;
-			if (QueryPerformanceCounter((LARGE_INTEGER*)&now))
-			{
-				// Add the duration of the pause to the total idle time
-				totalIdleTime += (now - pausedTime);
+			std::int64_t now = clockSource->GetCounts();
 
-				// Set the previous time to the current time
-				previousTime = now;
+			// Add the duration of the pause to the total idle time
+			totalIdleTime += (now - pausedTime);
 
-				// Reset the pausedTime to 0 and isStopped to false
-				pausedTime = 0;
-				isStopped = false;
+			// Set the previous time to the current time
+			previousTime = now;
 
-#ifndef NDEBUG
-				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The timer was started.");
-#endif
+			// Reset the pausedTime to 0 and isStopped to false
+			pausedTime = 0;
+			isStopped = false;
 
-				return {};
-			}
-			else
-			{
-				return std::runtime_error("Unable to query the performance counter!");
-			}
+			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The timer was started.");
 		}
 
 		return {};
@@ -93,23 +77,11 @@ namespace core
 	{
 		if (!isStopped)
 		{
-			long long int now = 0;
-			if (QueryPerformanceCounter((LARGE_INTEGER*)&now))
-			{
-				// Set the paused time
-				pausedTime = now;
-				isStopped = true;
-
-#ifndef NDEBUG
-				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The timer was stopped.");
-#endif
+			// Set the paused time
+			pausedTime = clockSource->GetCounts();
+			isStopped = true;
 
-				return {};
-			}
-			else
-			{
-				return std::runtime_error("Unable to query the performance counter!");
-			}
+			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The timer was stopped.");
 		}
 
 		return {};
@@ -117,24 +89,17 @@ namespace core
 
 	util::Expected<void> Timer::Reset()
 	{
-		long long int now = 0;
-		if (QueryPerformanceCounter((LARGE_INTEGER*)&now))
-		{
-			startTime = now;
-			previousTime = now;
-			pausedTime = 0;
-			isStopped = false;
+		std::int64_t now = clockSource->GetCounts();
+		startTime = now;
+		currentTime = now;
+		previousTime = now;
+		totalIdleTime = 0;
+		pausedTime = 0;
+		isStopped = false;
 
-#ifndef NDEBUG
-			util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>("The timer was reset.");
-#endif
+		util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The timer was reset.");
 
-			return {};
-		}
-		else
-		{
-			return std::runtime_error("Unable to query the performance counter!");
-		}
+		return {};
 	}
 
 	// Update the delta time between two frames
@@ -147,23 +112,17 @@ namespace core
 		}
 		else
 		{
-			if (QueryPerformanceCounter((LARGE_INTEGER*)&currentTime))
-			{
-				deltaTime = (currentTime - previousTime) * secondsPerCount;
+			currentTime = clockSource->GetCounts();
+			deltaTime = (currentTime - previousTime) * secondsPerCount;
 
-				previousTime = currentTime;
+			previousTime = currentTime;
 
-				if (deltaTime < 0.0)
-				{
-					deltaTime = 0.0;
-				}
-
-				return {};
-			}
-			else
+			if (deltaTime < 0.0)
 			{
-				return std::runtime_error("Unable to query the performance counter!");
+				deltaTime = 0.0;
 			}
+
+			return {};
 		}
 	}
 
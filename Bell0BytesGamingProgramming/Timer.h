@@ -7,15 +7,21 @@
 *
 * High resolution timer.
 *
+* The timer reads one of the clock sources of ClockSource.h; by default the cheapest reliable source of the machine.
+* Any other source, i.e. a VirtualClock, can be injected.
+*
 ********************************************************************************************************************************/
 
 #pragma endregion
 
 #pragma region "Includes"
 
-#include "stdafx.h"
+// C++ includes
+#include <cstdint>			// fixed width integers
+#include <memory>			// std::unique_ptr
 
 // Project includes
+#include "ClockSource.h"
 #include "Expected.h"
 
 #pragma endregion
@@ -25,12 +31,14 @@ namespace core
 	class Timer
 	{
 	public:
-		Timer();
+		Timer(ClockSourceType clockSourceType = ClockSourceType::automatic);
+		explicit Timer(std::unique_ptr<ClockSource> clockSource);		// i.e. a VirtualClock
 		~Timer();
 
 		// Getters
 		double GetTotalTime() const;	// total runtime
 		double GetDeltaTime() const;	// time between frames
+		const ClockSource& GetClockSource() const { return *clockSource; };
 
 		util::Expected<void> Start();
 		util::Expected<void> Reset();
@@ -38,12 +46,14 @@ namespace core
 		util::Expected<void> Stop();
 
 	private:
+		std::unique_ptr<ClockSource> clockSource;	// the clock the counts are read from
+
 		// times measured in counts
-		long long int startTime;			// time at the start of the application
-		long long int totalIdleTime;		// total time the game was idle
-		long long int pausedTime;			// time at the moment the game was paused last
-		long long int currentTime;			// stores the current time; i.e. time at the current frame
-		long long int previousTime;		    // stores the time at the last inquiry before current; i.e. time at the previous frame
+		std::int64_t startTime;				// time at the start of the application
+		std::int64_t totalIdleTime;			// total time the game was idle
+		std::int64_t pausedTime;			// time at the moment the game was paused last
+		std::int64_t currentTime;			// stores the current time; i.e. time at the current frame
+		std::int64_t previousTime;		    // stores the time at the last inquiry before current; i.e. time at the previous frame
 
 		// times measured in seconds
 		double secondsPerCount;			    // reciprocal of the frequency, computed once at the initialization of the class
@@ -0,0 +1,103 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* TripleBuffer.h
+*
+* Lock-free hand-off of the latest value from one writer thread to one reader thread
+*
+* The writer owns the back slot, the reader owns the front slot, and the third slot sits in the middle. Publishing swaps
+* the back slot with the middle one, acquiring swaps the front slot with the middle one if it holds a value the reader
+* has not seen yet; both are a single atomic exchange, neither side ever waits for the other. Values the reader was too
+* slow to acquire are overwritten, thus the reader always sees the newest complete value, and the writer never touches
+* the slot the reader is looking at.
+*
+* The slot indices are exposed as well, thus data too large to be copied into the buffer can be kept in arrays of
+* slotCount elements next to it and handed off with it.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <atomic>			// atomic objects (no data races)
+#include <cstddef>			// std::size_t
+
+#pragma endregion
+
+namespace util
+{
+	template<typename T>
+	class TripleBuffer
+	{
+	public:
+		static constexpr unsigned int slotCount = 3;
+
+		TripleBuffer();
+		~TripleBuffer() {};
+
+		TripleBuffer(const TripleBuffer&) = delete;
+		TripleBuffer& operator=(const TripleBuffer&) = delete;
+
+		// Writer: fills the back slot, then publishes it as the newest value
+		T& GetWriteBuffer() { return slots[back].data; };
+		unsigned int GetWriteSlot() const { return back; };
+		void Publish();
+
+		// Reader: switches to the newest published value; returns false if nothing was published since the last call
+		bool Acquire();
+		const T& GetReadBuffer() const { return slots[front].data; };
+		unsigned int GetReadSlot() const { return front; };
+
+		// Getters
+		bool HasNewValue() const { return (middle.load(std::memory_order_acquire) & freshBit) != 0; };	// a published value waits to be acquired
+
+	private:
+		static constexpr std::size_t cacheLineSize = 64;
+		static constexpr unsigned int indexMask = 3;
+		static constexpr unsigned int freshBit = 4;			// set while the middle slot holds a value the reader has not acquired
+
+		// the writer and the reader work on different slots at the same time
+		struct alignas(cacheLineSize) Slot
+		{
+			T data;
+		};
+
+		Slot slots[slotCount];
+
+		alignas(cacheLineSize) unsigned int back;						// the slot the writer fills, only touched by the writer
+		alignas(cacheLineSize) std::atomic<unsigned int> middle;		// the slot in between, and the fresh bit
+		alignas(cacheLineSize) unsigned int front;						// the slot the reader reads, only touched by the reader
+	};
+
+	template<typename T>
+	TripleBuffer<T>::TripleBuffer() :
+		slots(),
+		back(0),
+		middle(1),
+		front(2)
+	{
+	}
+
+	template<typename T>
+	void TripleBuffer<T>::Publish()
+	{
+		// release: the value in the back slot is complete before the reader can take it
+		back = middle.exchange(back | freshBit, std::memory_order_acq_rel) & indexMask;
+	}
+
+	template<typename T>
+	bool TripleBuffer<T>::Acquire()
+	{
+		if ((middle.load(std::memory_order_relaxed) & freshBit) == 0)
+		{
+			return false;
+		}
+
+		// acquire: the value the writer published is visible once the slot is taken; the fresh bit is cleared
+		front = middle.exchange(front, std::memory_order_acq_rel) & indexMask;
+		return true;
+	}
+}
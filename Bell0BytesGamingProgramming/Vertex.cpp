@@ -0,0 +1,96 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Vertex.cpp
+*
+* The vertex formats of the game, independent of Direct3D
+*
+* The half float conversions are those of Fabian Giesen:
+* - https://gist.github.com/rygorous/2156668
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstring>			// std::memcpy
+
+// Project includes
+#include "Vertex.h"
+
+#pragma endregion
+
+namespace graphics
+{
+	namespace
+	{
+		inline std::uint32_t ToBits(float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			return bits;
+		}
+
+		inline float ToFloat(std::uint32_t bits)
+		{
+			float value;
+			std::memcpy(&value, &bits, sizeof(value));
+			return value;
+		}
+	}
+
+	std::uint16_t FloatToHalf(float value)
+	{
+		const std::uint32_t halfOverflow = 143U << 23;			// 2^16: too large for a half
+		const std::uint32_t halfNormal = 113U << 23;			// 2^-14: the smallest normal half
+		const std::uint32_t subnormalMagic = 126U << 23;		// 0.5: adding it shifts the subnormal bits in place
+
+		std::uint32_t bits = ToBits(value);
+		const std::uint32_t sign = bits & 0x80000000U;
+		bits ^= sign;
+
+		std::uint32_t half;
+		if (bits >= halfOverflow)
+		{
+			// infinity, or a quiet NaN
+			half = bits > (255U << 23) ? 0x7e00 : 0x7c00;
+		}
+		else if (bits < halfNormal)
+		{
+			// subnormal or zero: the addition rounds to the nearest even
+			half = ToBits(ToFloat(bits) + ToFloat(subnormalMagic)) - subnormalMagic;
+		}
+		else
+		{
+			// normal: rebias the exponent, then round the 13 dropped bits to the nearest even
+			const std::uint32_t odd = (bits >> 13) & 1;
+			bits += (std::uint32_t)(15 - 127) * (1U << 23) + 0xfff + odd;
+			half = bits >> 13;
+		}
+		return (std::uint16_t)(half | (sign >> 16));
+	}
+
+	float HalfToFloat(std::uint16_t half)
+	{
+		const std::uint32_t exponentMask = 0x7c00U << 13;
+		const float subnormalMagic = ToFloat(113U << 23);
+
+		std::uint32_t bits = (std::uint32_t)(half & 0x7fff) << 13;
+		const std::uint32_t exponent = bits & exponentMask;
+		bits += (127U - 15U) << 23;
+
+		if (exponent == exponentMask)
+		{
+			// infinity or NaN
+			bits += (128U - 16U) << 23;
+		}
+		else if (exponent == 0)
+		{
+			// subnormal or zero
+			bits = ToBits(ToFloat(bits + (1U << 23)) - subnormalMagic);
+		}
+		return ToFloat(bits | (std::uint32_t)(half & 0x8000) << 16);
+	}
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Vertex.h
+*
+* The vertex formats of the game, independent of Direct3D
+*
+* The packed format comes with the description of its elements, from which Direct3D builds the input layout. The full
+* vertex is only used on the CPU, i.e. by the benchmarks that compare the formats.
+*
+* The packed vertex is half the size of the full one: the position as four half floats, w always being 1.0, and the
+* color as four bytes. Half floats have 11 significant bits, thus positions in [-1, 1] are off by at most 2^-12.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <cstdint>			// fixed width integers
+
+#pragma endregion
+
+namespace graphics
+{
+	// The data formats of vertex elements
+	enum class VertexFormat
+	{
+		float3,				// three 32-bit floats
+		half4,				// four 16-bit floats
+		unorm8x4			// four bytes, read as floats in [0, 1]
+	};
+
+	// One element of a vertex, as seen by the input assembler
+	struct VertexElement
+	{
+		const char* semantic;
+		unsigned int semanticIndex;
+		VertexFormat format;
+		unsigned int offset;		// in bytes, from the start of the vertex
+	};
+
+	// Represents a single vertex (point)
+	struct Vertex
+	{
+		// position
+		float x;
+		float y;
+		float z;
+
+		// color
+		float r;
+		float g;
+		float b;
+	};
+
+	// A single vertex in 12 bytes
+	struct PackedVertex
+	{
+		// position, half floats
+		std::uint16_t x;
+		std::uint16_t y;
+		std::uint16_t z;
+		std::uint16_t w;
+
+		// color: red in the lowest byte, alpha in the highest
+		std::uint32_t color;
+	};
+	static_assert(sizeof(PackedVertex) == 12, "The packed vertex must be 12 bytes!");
+
+	const VertexElement packedVertexLayout[] =
+	{
+		{ "POSITION", 0, VertexFormat::half4, 0 },
+		{ "COLOR", 0, VertexFormat::unorm8x4, 8 }
+	};
+
+	// Half floats, rounded to the nearest even
+	std::uint16_t FloatToHalf(float value);
+	float HalfToFloat(std::uint16_t half);
+	const std::uint16_t halfOne = 0x3c00;
+}
@@ -69,9 +69,7 @@ namespace core
 			catch (std::exception& e)
 			{
 				// Log the error
-				std::stringstream errorMessage;
-				errorMessage << "Creating the game window failed with: " << e.what();
-				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::error>(std::stringstream(errorMessage.str()));
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::error>("Creating the game window failed with: {}", e.what());
 			
 				throw std::runtime_error("Window creation failed!");
 			}
@@ -308,11 +306,7 @@ namespace core
 				// Read desired resolution from config file. Default: 200x200
 				m_clientWidth = lua["config"]["resolution"]["width"].get_or(200);
 				m_clientHeight = lua["config"]["resolution"]["height"].get_or(200);
-#ifndef NDEBUG
-				std::stringstream res;
-				res << "The client resolution was read from the Lua configuration file: " << m_clientWidth << " x " << m_clientHeight << ".";
-				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::info>(res.str());
-#endif
+				util::ServiceLocator::GetFileLogger()->Print<util::SeverityType::debug>("The client resolution was read from the Lua configuration file: {width} x {height}.", m_clientWidth, m_clientHeight);
 			}
 			catch (std::exception)
 			{
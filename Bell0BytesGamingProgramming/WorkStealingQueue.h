@@ -0,0 +1,157 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* WorkStealingQueue.h
+*
+* Bounded lock-free work-stealing deque: the owner thread pushes and pops at the bottom, other threads steal at the top
+*
+* Based on the Chase-Lev deque, with the memory orderings of Lê, Pop, Cohen and Zappa Nardelli
+* - D. Chase, Y. Lev: Dynamic Circular Work-Stealing Deque, SPAA 2005
+* - N. M. Lê et al.: Correct and Efficient Work-Stealing for Weak Memory Models, PPoPP 2013
+*
+* The owner works on the newest items, which are still in its cache, while thieves take the oldest ones, which tend to
+* be the largest pieces of work. Only the last item is contended; pushing and popping are otherwise free of atomic
+* read-modify-write operations. The capacity is fixed: Push returns false when the deque is full.
+*
+* The items must be trivially copyable, i.e. pointers.
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <atomic>			// atomic objects (no data races)
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <memory>			// std::unique_ptr
+#include <stdexcept>		// std::invalid_argument
+
+#pragma endregion
+
+namespace util
+{
+	template<typename T>
+	class WorkStealingQueue
+	{
+	public:
+		explicit WorkStealingQueue(std::size_t capacity);
+		~WorkStealingQueue() {};
+
+		WorkStealingQueue(const WorkStealingQueue&) = delete;
+		WorkStealingQueue& operator=(const WorkStealingQueue&) = delete;
+
+		// Owner: adds an item at the bottom; returns false if the deque is full
+		bool Push(T item);
+
+		// Owner: takes the newest item; returns false if the deque is empty
+		bool Pop(T& item);
+
+		// Any thread: takes the oldest item; returns false if the deque is empty or another thread took the item first
+		bool Steal(T& item);
+
+		// Getters
+		std::size_t GetCapacity() const { return capacity; };
+		std::size_t GetApproximateSize() const;
+		bool IsEmpty() const { return GetApproximateSize() == 0; };
+
+	private:
+		static constexpr std::size_t cacheLineSize = 64;
+
+		std::unique_ptr<std::atomic<T>[]> items;			// the circular array
+		const std::size_t capacity;							// number of items, always a power of two
+		const std::size_t mask;								// capacity - 1, used to wrap positions
+
+		// padded rather than aligned, thus the deque can be allocated with new before C++17
+		char topPadding[cacheLineSize];
+		std::atomic<std::int64_t> top;						// the oldest item, advanced by thieves and by the owner taking the last item
+		char bottomPadding[cacheLineSize];
+		std::atomic<std::int64_t> bottom;					// one past the newest item, only written by the owner
+		char endPadding[cacheLineSize];
+	};
+
+	template<typename T>
+	WorkStealingQueue<T>::WorkStealingQueue(std::size_t capacity) :
+		items(new std::atomic<T>[capacity]),
+		capacity(capacity),
+		mask(capacity - 1),
+		top(0),
+		bottom(0)
+	{
+		if (capacity < 2 || (capacity & (capacity - 1)) != 0)
+		{
+			throw std::invalid_argument("The capacity of the work-stealing queue must be a power of two!");
+		}
+	}
+
+	template<typename T>
+	bool WorkStealingQueue<T>::Push(T item)
+	{
+		const std::int64_t b = bottom.load(std::memory_order_relaxed);
+		const std::int64_t t = top.load(std::memory_order_acquire);
+		if (b - t >= (std::int64_t)capacity)
+		{
+			return false;
+		}
+
+		// the item must be visible before a thief can see the new bottom
+		items[b & mask].store(item, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_release);
+		bottom.store(b + 1, std::memory_order_relaxed);
+		return true;
+	}
+
+	template<typename T>
+	bool WorkStealingQueue<T>::Pop(T& item)
+	{
+		// reserve the newest item, then look whether a thief got there first
+		const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+		bottom.store(b, std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		std::int64_t t = top.load(std::memory_order_relaxed);
+
+		if (t > b)
+		{
+			// the deque was empty
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return false;
+		}
+
+		item = items[b & mask].load(std::memory_order_relaxed);
+		if (t == b)
+		{
+			// the last item: race the thieves for it
+			const bool isWon = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+			bottom.store(b + 1, std::memory_order_relaxed);
+			return isWon;
+		}
+		return true;
+	}
+
+	template<typename T>
+	bool WorkStealingQueue<T>::Steal(T& item)
+	{
+		std::int64_t t = top.load(std::memory_order_acquire);
+		std::atomic_thread_fence(std::memory_order_seq_cst);
+		const std::int64_t b = bottom.load(std::memory_order_acquire);
+
+		if (t >= b)
+		{
+			return false;
+		}
+
+		// read the item before claiming it, the owner may overwrite the slot as soon as top has moved on
+		item = items[t & mask].load(std::memory_order_relaxed);
+		return top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+	}
+
+	template<typename T>
+	std::size_t WorkStealingQueue<T>::GetApproximateSize() const
+	{
+		const std::int64_t b = bottom.load(std::memory_order_acquire);
+		const std::int64_t t = top.load(std::memory_order_acquire);
+		return b > t ? (std::size_t)(b - t) : 0;
+	}
+}
@@ -0,0 +1,212 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Benchmark.cpp
+*
+* Common utilities of the benchmarks: command line options, percentiles and machine-readable results
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include "Benchmark.h"
+
+// C++ includes
+#include <algorithm>		// std::sort
+#include <cmath>			// std::isfinite
+#include <cstdlib>			// std::strtoll, std::strtod
+#include <iomanip>			// std::setprecision
+
+#pragma endregion
+
+namespace benchmarks
+{
+	Options::Options(int argc, char* argv[])
+	{
+		for (int i = 1; i < argc; i++)
+		{
+			std::string argument = argv[i];
+			if (argument.compare(0, 2, "--") != 0)
+			{
+				continue;
+			}
+
+			// a flag without a value is stored with an empty value
+			std::string value;
+			if (i + 1 < argc && std::string(argv[i + 1]).compare(0, 2, "--") != 0)
+			{
+				value = argv[++i];
+			}
+			values.emplace_back(argument.substr(2), value);
+		}
+	}
+
+	bool Options::Has(const std::string& name) const
+	{
+		return Find(name) != nullptr;
+	}
+
+	std::string Options::GetString(const std::string& name, const std::string& defaultValue) const
+	{
+		const std::string* value = Find(name);
+		return value != nullptr && !value->empty() ? *value : defaultValue;
+	}
+
+	long long Options::GetInteger(const std::string& name, long long defaultValue) const
+	{
+		const std::string* value = Find(name);
+		return value != nullptr && !value->empty() ? std::strtoll(value->c_str(), nullptr, 10) : defaultValue;
+	}
+
+	double Options::GetDouble(const std::string& name, double defaultValue) const
+	{
+		const std::string* value = Find(name);
+		return value != nullptr && !value->empty() ? std::strtod(value->c_str(), nullptr) : defaultValue;
+	}
+
+	const std::string* Options::Find(const std::string& name) const
+	{
+		for (const auto& value : values)
+		{
+			if (value.first == name)
+			{
+				return &value.second;
+			}
+		}
+		return nullptr;
+	}
+
+	Statistics ComputeStatistics(std::vector<double>& samples)
+	{
+		Statistics statistics = {};
+		statistics.count = samples.size();
+		if (samples.empty())
+		{
+			return statistics;
+		}
+
+		std::sort(samples.begin(), samples.end());
+		double sum = 0;
+		for (double sample : samples)
+		{
+			sum += sample;
+		}
+
+		// nearest-rank percentiles
+		auto percentile = [&samples](double p)
+		{
+			std::size_t rank = static_cast<std::size_t>(std::ceil(p * samples.size()));
+			return samples[rank > 0 ? rank - 1 : 0];
+		};
+		statistics.mean = sum / samples.size();
+		statistics.p50 = percentile(0.5);
+		statistics.p99 = percentile(0.99);
+		statistics.p999 = percentile(0.999);
+		statistics.max = samples.back();
+		return statistics;
+	}
+
+	std::vector<unsigned int> GetThreadCounts(unsigned int maxThreads)
+	{
+		std::vector<unsigned int> counts;
+		for (unsigned int n = 1; n < maxThreads; n *= 2)
+		{
+			counts.push_back(n);
+		}
+		counts.push_back(maxThreads > 0 ? maxThreads : 1);
+		return counts;
+	}
+
+	ResultWriter& ResultWriter::Begin(const char* benchmark)
+	{
+		out << '{';
+		hasFields = false;
+		return Add("benchmark", benchmark);
+	}
+
+	ResultWriter& ResultWriter::Add(const char* key, const std::string& value)
+	{
+		AddKey(key);
+		out << '"';
+		for (char c : value)
+		{
+			if (c == '"' || c == '\\')
+			{
+				out << '\\';
+			}
+			out << c;
+		}
+		out << '"';
+		return *this;
+	}
+
+	ResultWriter& ResultWriter::Add(const char* key, const char* value)
+	{
+		return Add(key, std::string(value));
+	}
+
+	ResultWriter& ResultWriter::Add(const char* key, double value)
+	{
+		AddKey(key);
+		if (std::isfinite(value))
+		{
+			out << std::setprecision(6) << value;
+		}
+		else
+		{
+			out << "null";
+		}
+		return *this;
+	}
+
+	ResultWriter& ResultWriter::Add(const char* key, bool value)
+	{
+		AddKey(key);
+		out << (value ? "true" : "false");
+		return *this;
+	}
+
+	ResultWriter& ResultWriter::Add(const char* key, long long value)
+	{
+		AddKey(key);
+		out << value;
+		return *this;
+	}
+
+	ResultWriter& ResultWriter::Add(const char* key, unsigned long long value)
+	{
+		AddKey(key);
+		out << value;
+		return *this;
+	}
+
+	ResultWriter& ResultWriter::Add(const char* prefix, const Statistics& statistics)
+	{
+		const std::string name = prefix;
+		Add((name + "Count").c_str(), static_cast<unsigned long long>(statistics.count));
+		Add((name + "Mean").c_str(), statistics.mean);
+		Add((name + "P50").c_str(), statistics.p50);
+		Add((name + "P99").c_str(), statistics.p99);
+		Add((name + "P999").c_str(), statistics.p999);
+		Add((name + "Max").c_str(), statistics.max);
+		return *this;
+	}
+
+	void ResultWriter::End()
+	{
+		out << "}\n";
+		out.flush();
+	}
+
+	void ResultWriter::AddKey(const char* key)
+	{
+		if (hasFields)
+		{
+			out << ',';
+		}
+		out << '"' << key << "\":";
+		hasFields = true;
+	}
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* Benchmark.h
+*
+* Common utilities of the benchmarks: command line options, percentiles and machine-readable results
+*
+* Every benchmark writes one JSON object per measurement and line, thus runs can be compared with standard tools, i.e.
+*	./LoggerBenchmark > before.jsonl
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+#include <cstddef>			// std::size_t
+#include <cstdint>			// fixed width integers
+#include <ostream>			// output streams
+#include <string>			// strings
+#include <vector>			// vector containers
+
+#pragma endregion
+
+namespace benchmarks
+{
+	// Command line options of the form --name value
+	class Options
+	{
+	public:
+		Options(int argc, char* argv[]);
+
+		bool Has(const std::string& name) const;
+		std::string GetString(const std::string& name, const std::string& defaultValue) const;
+		long long GetInteger(const std::string& name, long long defaultValue) const;
+		double GetDouble(const std::string& name, double defaultValue) const;
+
+	private:
+		const std::string* Find(const std::string& name) const;
+
+	private:
+		std::vector<std::pair<std::string, std::string>> values;
+	};
+
+	// Summary of a set of samples
+	struct Statistics
+	{
+		std::size_t count;
+		double mean;
+		double p50;
+		double p99;
+		double p999;
+		double max;
+	};
+
+	// Sorts the samples in place
+	Statistics ComputeStatistics(std::vector<double>& samples);
+
+	// The thread counts to measure: 1, 2, 4, ... up to and including maxThreads
+	std::vector<unsigned int> GetThreadCounts(unsigned int maxThreads);
+
+	// Writes one result per line: {"benchmark":"logger","threads":4,...}
+	class ResultWriter
+	{
+	public:
+		explicit ResultWriter(std::ostream& out) : out(out), hasFields(false) {};
+
+		ResultWriter& Begin(const char* benchmark);
+		ResultWriter& Add(const char* key, const std::string& value);
+		ResultWriter& Add(const char* key, const char* value);
+		ResultWriter& Add(const char* key, double value);
+		ResultWriter& Add(const char* key, bool value);
+		ResultWriter& Add(const char* key, long long value);
+		ResultWriter& Add(const char* key, unsigned long long value);
+		ResultWriter& Add(const char* key, int value) { return Add(key, static_cast<long long>(value)); };
+		ResultWriter& Add(const char* key, unsigned int value) { return Add(key, static_cast<unsigned long long>(value)); };
+		ResultWriter& Add(const char* prefix, const Statistics& statistics);		// prefixCount, prefixMean, prefixP50, ...
+		void End();
+
+	private:
+		void AddKey(const char* key);
+
+	private:
+		std::ostream& out;
+		bool hasFields;
+	};
+}
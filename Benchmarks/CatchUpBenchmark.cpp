@@ -0,0 +1,113 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* CatchUpBenchmark.cpp
+*
+* How the catch-up policies of the fixed time step cope with updates that can not keep up, on virtual time
+*
+* Every update costs a fixed share of delta-t in virtual time; above 1, no policy can simulate the game at full speed. For
+* every cost and policy, the headless loop runs for a while and reports:
+* - the game speed: simulated game time per virtual real time, 1.0 is full speed
+* - the time the policy dropped or dilated, the steps that were skipped and the largest debt
+* - the frames the loop flagged as falling behind, and the final cost ratio of an update
+*
+* Options:
+*	--seconds <s>		virtual real time per run (default: 10)
+*	--dt <s>			fixed time step (default: 1/240)
+*	--frameTime <s>		virtual time between two frames without updates (default: 1/60)
+*	--maxSkipFrames <n>	max number of updates per frame (default: 10)
+*	--costs <list>		update costs as shares of dt, comma separated (default: 0.5,0.9,1.2,2)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <sstream>			// string streams
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/HeadlessRunner.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	std::vector<double> ParseList(const std::string& list)
+	{
+		std::vector<double> values;
+		std::istringstream in(list);
+		std::string value;
+		while (std::getline(in, value, ','))
+		{
+			values.push_back(std::stod(value));
+		}
+		return values;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const double seconds = options.GetDouble("seconds", 10.0);
+	const double dt = options.GetDouble("dt", 1.0 / 240.0);
+	const double frameTime = options.GetDouble("frameTime", 1.0 / 60.0);
+	const int maxSkipFrames = static_cast<int>(options.GetInteger("maxSkipFrames", 10));
+	const std::vector<double> costs = ParseList(options.GetString("costs", "0.5,0.9,1.2,2"));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/CatchUpBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	const core::CatchUpPolicyType policies[] = { core::CatchUpPolicyType::strict, core::CatchUpPolicyType::clamp, core::CatchUpPolicyType::timeDilation, core::CatchUpPolicyType::adaptiveStep };
+	for (double cost : costs)
+	{
+		for (core::CatchUpPolicyType policy : policies)
+		{
+			core::HeadlessRunner runner(dt, maxSkipFrames, frameTime);
+			runner.SetCatchUpPolicy(core::CatchUpPolicy::Create(policy));
+			runner.SetUpdateCost(cost * dt);
+
+			double gameTime = 0.0;
+			util::Expected<int> result = runner.Run(seconds, [&gameTime](double stepTime) { gameTime += stepTime; return util::Expected<int>(0); }, [](double) { return util::Expected<int>(0); });
+			if (!result.isValid())
+			{
+				std::cerr << "The headless run failed!" << std::endl;
+				return 1;
+			}
+
+			const core::HeadlessRunStatistics& statistics = runner.GetStatistics();
+			const core::CatchUpTelemetry& telemetry = runner.GetLoop().GetTelemetry();
+			results.Begin("catchUp")
+				.Add("policy", core::CatchUpPolicy::GetName(policy))
+				.Add("updateCost", cost)
+				.Add("frames", statistics.frames)
+				.Add("updates", statistics.updates)
+				.Add("gameSpeed", gameTime / statistics.simulatedSeconds)
+				.Add("meanFrameMs", statistics.simulatedSeconds * 1000.0 / statistics.frames)
+				.Add("framesAtMaxSkipFrames", statistics.framesAtMaxSkipFrames)
+				.Add("droppedSeconds", telemetry.droppedTime)
+				.Add("dilatedSeconds", telemetry.dilatedTime)
+				.Add("skippedSteps", telemetry.skippedSteps)
+				.Add("debtSeconds", telemetry.debt)
+				.Add("maxDebtSeconds", telemetry.maxDebt)
+				.Add("spiralFrames", telemetry.spiralFrames)
+				.Add("costRatio", telemetry.updateCostRatio)
+				.Add("stepMs", runner.GetLoop().GetLastFrame().stepTime * 1000.0)
+				.End();
+		}
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
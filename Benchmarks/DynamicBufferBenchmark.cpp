@@ -0,0 +1,121 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* DynamicBufferBenchmark.cpp
+*
+* Cost of uploading vertices that changed in part: rewriting the whole buffer every frame against writing the dirty
+* ranges only, on the fake device
+*
+* Every frame changes random spans of vertices, a given fraction of them, then uploads. For every fraction:
+* - discard: the whole buffer is marked dirty, as the game did before; dirty: only the spans that changed
+* - the time per upload (ms), the bytes and ranges written per frame and the fraction of uploads that discarded
+* - whether the region drawn from held the current vertices after every frame
+*
+* Options:
+*	--vertices <n>		vertices per buffer (default: 50000)
+*	--span <n>			vertices per changed span (default: 16)
+*	--frames <n>		frames per fraction (default: 600)
+*	--regions <n>		copies of the vertices in the buffer (default: 4)
+*	--gap <n>			bytes between ranges that are written as one (default: 256)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::max
+#include <chrono>			// clocks
+#include <cstring>			// std::memcmp
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/DynamicBuffer.h"
+#include "../Bell0BytesGamingProgramming/Random.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+#include "../Bell0BytesGamingProgramming/Vertex.h"
+
+#pragma endregion
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const std::size_t vertexCount = static_cast<std::size_t>(options.GetInteger("vertices", 50000));
+	const std::size_t span = static_cast<std::size_t>(options.GetInteger("span", 16));
+	const long long frames = options.GetInteger("frames", 600);
+	const unsigned int regionCount = static_cast<unsigned int>(options.GetInteger("regions", 4));
+	const std::size_t gap = static_cast<std::size_t>(options.GetInteger("gap", 256));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/DynamicBufferBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	const std::size_t bytes = vertexCount * sizeof(graphics::PackedVertex);
+	for (double fraction : { 0.0, 0.001, 0.01, 0.1, 0.5, 1.0 })
+	{
+		const std::size_t spans = fraction == 0.0 ? 0 : (std::max)((std::size_t)1, (std::size_t)(fraction * vertexCount / span));
+		for (bool isDiscarding : { true, false })
+		{
+			// the same spans change for both strategies
+			graphics::Pcg32 random(0x5eed);
+			std::vector<graphics::PackedVertex> vertices(vertexCount, graphics::PackedVertex{});
+			graphics::FakeBufferDevice device(bytes * regionCount);
+			graphics::DynamicBuffer buffer(device, bytes, regionCount, gap);
+
+			std::vector<double> times;
+			bool isCorrect = true;
+			for (long long frame = 0; frame < frames; frame++)
+			{
+				for (std::size_t i = 0; i < spans; i++)
+				{
+					const std::size_t first = random.Next() % vertexCount;
+					const std::size_t last = (std::min)(first + span, vertexCount);
+					for (std::size_t vertex = first; vertex < last; vertex++)
+					{
+						vertices[vertex].color = random.Next();
+					}
+					if (!isDiscarding)
+					{
+						buffer.MarkDirty(first * sizeof(graphics::PackedVertex), (last - first) * sizeof(graphics::PackedVertex));
+					}
+				}
+				if (isDiscarding)
+				{
+					buffer.MarkAllDirty();
+				}
+
+				const auto start = std::chrono::steady_clock::now();
+				const bool isUploaded = buffer.Upload(vertices.data()).isValid();
+				times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+				isCorrect = isCorrect && isUploaded && std::memcmp(device.GetMemory() + buffer.GetRegionOffset(), vertices.data(), bytes) == 0;
+			}
+
+			const graphics::DynamicBufferStatistics& statistics = buffer.GetStatistics();
+			const benchmarks::Statistics time = benchmarks::ComputeStatistics(times);
+			results.Begin("dynamicBuffer")
+				.Add("strategy", isDiscarding ? "discard" : "dirty")
+				.Add("dirtyFraction", fraction)
+				.Add("vertices", static_cast<unsigned long long>(vertexCount))
+				.Add("regions", regionCount)
+				.Add("ms", time)
+				.Add("bytesPerFrame", (double)statistics.bytes / frames)
+				.Add("rangesPerFrame", (double)statistics.ranges / frames)
+				.Add("discardFraction", statistics.uploads == 0 ? 0.0 : (double)statistics.discards / statistics.uploads)
+				.Add("skips", statistics.skips)
+				.Add("isCorrect", isCorrect)
+				.End();
+		}
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
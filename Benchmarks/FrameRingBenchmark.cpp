@@ -0,0 +1,173 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* FrameRingBenchmark.cpp
+*
+* Stress test of the frame ring allocator on the CPU: producers on 1, 2, 4, ... threads allocate and fill transient data
+* every frame, while a simulated GPU lags a few frames behind and checks the data of every frame it completes
+*
+* Every frame, the jobs allocate chunks of random sizes and fill them with a tag of their frame and index. The GPU
+* completes a frame lag frames after it ended: it checks that every chunk of the frame still holds its tag, i.e. that no
+* later allocation was handed the bytes of a frame in flight and that no two producers got the same bytes, then the
+* frame is reclaimed. For every thread count:
+* - fill: the time per frame (ms) and the allocations per millisecond, allocating and filling
+* - allocate: the same, allocating only, which is the cost of the compare-and-swap on the head under contention
+* - the failed allocations, the peak bytes of a frame and in use, and whether every chunk was intact
+*
+* Options:
+*	--capacity <n>		bytes in the ring (default: 8388608)
+*	--allocations <n>	allocations per frame (default: 4096)
+*	--size <n>			largest allocation in bytes (default: 1024)
+*	--lag <n>			frames between the end of a frame and its completion by the GPU (default: 2)
+*	--frames <n>		frames per thread count (default: 1000)
+*	--grain <n>			allocations per job (default: 64)
+*	--threads <n>		max number of threads (default: hardware concurrency)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::fill
+#include <atomic>			// atomic objects (no data races)
+#include <chrono>			// clocks
+#include <cstdint>			// fixed width integers
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <thread>			// std::thread::hardware_concurrency
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/FrameRingAllocator.h"
+#include "../Bell0BytesGamingProgramming/JobSystem.h"
+#include "../Bell0BytesGamingProgramming/Random.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	// the bytes are handed out in words, thus sizes and offsets are multiples of the alignment
+	const std::size_t alignment = 16;
+
+	// a chunk of a frame, as allocated by a producer
+	struct Chunk
+	{
+		std::size_t offset;
+		std::size_t size;			// 0 if the allocation failed
+		std::uint32_t tag;
+	};
+
+	std::uint32_t GetTag(unsigned long long frame, std::size_t allocation)
+	{
+		return (std::uint32_t)(frame * 0x9e3779b9U) ^ (std::uint32_t)(allocation * 0x85ebca6bU) ^ 0x5eed;
+	}
+
+	bool IsIntact(const std::vector<std::uint32_t>& memory, const std::vector<Chunk>& chunks)
+	{
+		for (const Chunk& chunk : chunks)
+		{
+			const std::uint32_t* words = memory.data() + chunk.offset / sizeof(std::uint32_t);
+			for (std::size_t word = 0; word < chunk.size / sizeof(std::uint32_t); word++)
+			{
+				if (words[word] != chunk.tag)
+				{
+					return false;
+				}
+			}
+		}
+		return true;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const std::size_t capacity = static_cast<std::size_t>(options.GetInteger("capacity", 8388608));
+	const std::size_t allocations = static_cast<std::size_t>(options.GetInteger("allocations", 4096));
+	const std::size_t maxSize = static_cast<std::size_t>(options.GetInteger("size", 1024));
+	const unsigned int lag = static_cast<unsigned int>(options.GetInteger("lag", 2));
+	const long long frames = options.GetInteger("frames", 1000);
+	const std::size_t grain = static_cast<std::size_t>(options.GetInteger("grain", 64));
+	const unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", std::thread::hardware_concurrency()));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/FrameRingBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	// what the GPU would read
+	std::vector<std::uint32_t> memory(capacity / sizeof(std::uint32_t));
+
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		util::JobSystem jobSystem(threadCount - 1);
+		for (bool isFilling : { true, false })
+		{
+			graphics::FrameRingAllocator ring(capacity, lag + 1);
+			std::vector<std::vector<Chunk>> framesInFlight(lag + 1, std::vector<Chunk>(allocations));
+			std::fill(memory.begin(), memory.end(), 0);
+
+			std::vector<double> times;
+			bool isIntact = true;
+			for (long long frame = 0; frame < frames; frame++)
+			{
+				// the producers
+				std::vector<Chunk>* chunks = &framesInFlight[frame % (lag + 1)];
+				std::vector<std::uint32_t>* words = &memory;
+				graphics::FrameRingAllocator* allocator = &ring;
+				const auto start = std::chrono::steady_clock::now();
+				jobSystem.ParallelFor(0, allocations, grain, [chunks, words, allocator, frame, maxSize, isFilling](std::size_t first, std::size_t last)
+				{
+					graphics::Pcg32 random((std::uint64_t)frame, first);
+					for (std::size_t i = first; i < last; i++)
+					{
+						const std::size_t size = alignment * (1 + random.Next() % (maxSize / alignment));
+						const graphics::RingAllocation allocation = allocator->Allocate(size, alignment);
+						Chunk& chunk = (*chunks)[i];
+						chunk = { allocation.offset, allocation.isValid && isFilling ? size : 0, GetTag(frame, i) };
+						if (chunk.size > 0)
+						{
+							std::fill(words->begin() + chunk.offset / sizeof(std::uint32_t), words->begin() + (chunk.offset + size) / sizeof(std::uint32_t), chunk.tag);
+						}
+					}
+				});
+				times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+				ring.EndFrame((unsigned long long)frame);
+
+				// the GPU completes the frame that ended lag frames ago
+				if (frame >= lag)
+				{
+					const long long completed = frame - lag;
+					isIntact = isIntact && IsIntact(memory, framesInFlight[completed % (lag + 1)]);
+					ring.Reclaim((unsigned long long)completed);
+				}
+			}
+
+			const graphics::FrameRingStatistics& statistics = ring.GetStatistics();
+			const benchmarks::Statistics time = benchmarks::ComputeStatistics(times);
+			results.Begin("frameRing")
+				.Add("producers", isFilling ? "fill" : "allocate")
+				.Add("threads", threadCount)
+				.Add("capacity", static_cast<unsigned long long>(capacity))
+				.Add("allocations", static_cast<unsigned long long>(allocations))
+				.Add("lag", lag)
+				.Add("ms", time)
+				.Add("allocationsPerMs", allocations / time.p50)
+				.Add("failedAllocations", ring.GetFailedAllocations())
+				.Add("peakFrameBytes", static_cast<unsigned long long>(statistics.peakFrameBytes))
+				.Add("peakUsedBytes", static_cast<unsigned long long>(statistics.peakUsedBytes))
+				.Add("isIntact", isIntact)
+				.End();
+		}
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
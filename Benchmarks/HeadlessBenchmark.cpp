@@ -0,0 +1,191 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* HeadlessBenchmark.cpp
+*
+* Soak and performance run of the fixed time step game loop on virtual time, without a window or a GPU
+*
+* The simulation mirrors the work of the game: every update regenerates the star field, every render reads it once.
+* Each configuration is run twice; the step counts of both runs must be identical. The real time spent updating and
+* rendering is recorded per frame; the report of the last run is written to HeadlessBenchmark.frames.txt.
+*
+* Options:
+*	--seconds <s>		simulated seconds per run (default: 10)
+*	--stars <n>			number of stars (default: 50000)
+*	--dt <s>			fixed time step (default: 1/240)
+*	--frameTime <s>		virtual time between two frames (default: 1/60)
+*	--hitch <s>			every 60th frame takes this long instead, 0 disables hitches (default: 0.25)
+*	--maxSkipFrames <n>	max number of updates per frame (default: 10)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// clocks
+#include <cstdlib>			// rand
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/FrameStatistics.h"
+#include "../Bell0BytesGamingProgramming/HeadlessRunner.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	struct Star
+	{
+		float x, y, z;
+		float r, g, b;
+	};
+
+	float RandomZeroToOne()
+	{
+		return static_cast<float>(rand() / static_cast<float>(RAND_MAX));
+	}
+
+	// The CPU side of the game: random stars every update, one pass over them every render
+	class StarFieldSimulation
+	{
+	public:
+		explicit StarFieldSimulation(std::size_t stars) : starField(stars), checksum(0.0) {};
+
+		util::Expected<int> Update(double)
+		{
+			for (Star& star : starField)
+			{
+				star = { RandomZeroToOne() * 2 - 1, RandomZeroToOne() * 2 - 1, RandomZeroToOne() * 2 - 1, RandomZeroToOne(), RandomZeroToOne(), RandomZeroToOne() };
+			}
+			return 0;
+		}
+
+		util::Expected<int> Render(double farseer)
+		{
+			double sum = 0.0;
+			for (const Star& star : starField)
+			{
+				sum += star.z;
+			}
+			checksum += sum * farseer;
+			return 0;
+		}
+
+		double GetChecksum() const { return checksum; };
+
+	private:
+		std::vector<Star> starField;
+		double checksum;				// keeps the renderer from being optimized away
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const double seconds = options.GetDouble("seconds", 10.0);
+	const std::size_t stars = static_cast<std::size_t>(options.GetInteger("stars", 50000));
+	const double dt = options.GetDouble("dt", 1.0 / 240.0);
+	const double frameTime = options.GetDouble("frameTime", 1.0 / 60.0);
+	const double hitch = options.GetDouble("hitch", 0.25);
+	const int maxSkipFrames = static_cast<int>(options.GetInteger("maxSkipFrames", 10));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/HeadlessBenchmark.log")));
+
+	std::vector<double> frameTimes(60, frameTime);
+	if (hitch > 0.0)
+	{
+		frameTimes.back() = hitch;
+	}
+
+	benchmarks::ResultWriter results(std::cout);
+	core::HeadlessRunStatistics firstRun = {};
+	for (int run = 0; run < 2; run++)
+	{
+		StarFieldSimulation simulation(stars);
+		core::HeadlessRunner runner(dt, maxSkipFrames);
+		runner.SetFrameTimes(frameTimes);
+
+		// the frame times are virtual, the update and render times are real
+		core::FrameStatistics frameStatistics;
+		double updateTime = 0.0;
+		double renderTime = 0.0;
+		auto update = [&simulation, &updateTime](double deltaTime)
+		{
+			auto start = std::chrono::steady_clock::now();
+			util::Expected<int> result = simulation.Update(deltaTime);
+			updateTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			return result;
+		};
+		auto render = [&](double farseer)
+		{
+			auto start = std::chrono::steady_clock::now();
+			util::Expected<int> result = simulation.Render(farseer);
+			renderTime += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+			// the render ends the frame
+			const core::FixedStepFrame& frame = runner.GetLoop().GetLastFrame();
+			frameStatistics.Record({ runner.GetFrameTime(), updateTime, renderTime, frame.updates, frame.hitMaxSkipFrames });
+			updateTime = 0.0;
+			renderTime = 0.0;
+			return result;
+		};
+
+		srand(1);
+		util::Expected<int> result = runner.Run(seconds, update, render);
+		if (!result.isValid())
+		{
+			std::cerr << "The headless run failed!" << std::endl;
+			return 1;
+		}
+
+		const core::HeadlessRunStatistics& statistics = runner.GetStatistics();
+		if (run == 0)
+		{
+			firstRun = statistics;
+		}
+		const core::FrameTimeSummary frameSummary = frameStatistics.GetSessionSummary();
+		frameStatistics.WriteReport(util::StringConverter::s2ws(directory + "/HeadlessBenchmark.frames.txt"));
+
+		const bool isDeterministic = statistics.frames == firstRun.frames && statistics.updates == firstRun.updates && statistics.framesAtMaxSkipFrames == firstRun.framesAtMaxSkipFrames;
+
+		results.Begin("headless")
+			.Add("run", run)
+			.Add("stars", static_cast<unsigned long long>(stars))
+			.Add("dt", dt)
+			.Add("frameTime", frameTime)
+			.Add("hitch", hitch)
+			.Add("simulatedSeconds", statistics.simulatedSeconds)
+			.Add("wallSeconds", statistics.wallSeconds)
+			.Add("speedup", statistics.simulatedSeconds / statistics.wallSeconds)
+			.Add("frames", statistics.frames)
+			.Add("updates", statistics.updates)
+			.Add("framesAtMaxSkipFrames", statistics.framesAtMaxSkipFrames)
+			.Add("updatesPerSecond", statistics.updates / statistics.wallSeconds)
+			.Add("deterministic", isDeterministic)
+			.Add("frameTimeP99Ms", frameSummary.p99FrameTime)
+			.Add("frameTimeMaxMs", frameSummary.maxFrameTime)
+			.Add("updateMsPerFrame", frameSummary.meanUpdateTime)
+			.Add("renderMsPerFrame", frameSummary.meanRenderTime)
+			.Add("checksum", simulation.GetChecksum())
+			.End();
+
+		if (!isDeterministic)
+		{
+			return 1;
+		}
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
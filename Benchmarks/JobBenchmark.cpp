@@ -0,0 +1,132 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* JobBenchmark.cpp
+*
+* Scaling of the work-stealing job system from one thread to all cores, and the cost of a job
+*
+* For 1, 2, 4, ... threads (the calling thread and threads - 1 workers):
+* - parallelFor: a compute-bound loop over an array, split by ParallelFor; the time per pass (ms), the speedup over one
+*   thread, and the efficiency: the speedup per thread
+* - jobs: a root job with many empty children, spawned and waited for by the calling thread; nanoseconds per job
+* - the jobs that were stolen, and how often the workers went to sleep
+*
+* Options:
+*	--items <n>			array size of the parallel loop (default: 1000000)
+*	--grain <n>			indices per job of the parallel loop (default: 4096)
+*	--passes <n>		samples per thread count (default: 50)
+*	--jobs <n>			empty jobs per sample (default: 2000)
+*	--threads <n>		max number of threads (default: hardware concurrency)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// clocks
+#include <cmath>			// std::sqrt
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <thread>			// std::thread::hardware_concurrency
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/JobSystem.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	// a few dozen floating point operations per item
+	void Compute(std::vector<float>& values, std::size_t first, std::size_t last)
+	{
+		for (std::size_t i = first; i < last; i++)
+		{
+			float x = values[i];
+			for (int j = 0; j < 16; j++)
+			{
+				x = std::sqrt(x * x + 1.0f) * 0.5f;
+			}
+			values[i] = x;
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const std::size_t items = static_cast<std::size_t>(options.GetInteger("items", 1000000));
+	const std::size_t grain = static_cast<std::size_t>(options.GetInteger("grain", 4096));
+	const long long passes = options.GetInteger("passes", 50);
+	const long long jobs = options.GetInteger("jobs", 2000);
+	const unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", std::thread::hardware_concurrency()));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/JobBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	std::vector<float> values(items, 1.0f);
+	double singleThreadMs = 0.0;
+
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		util::JobSystem jobSystem(threadCount - 1);
+
+		// parallel loop
+		std::vector<double> passTimes;
+		jobSystem.ParallelFor(0, items, grain, [&values](std::size_t first, std::size_t last) { Compute(values, first, last); });
+		for (long long pass = 0; pass < passes; pass++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			jobSystem.ParallelFor(0, items, grain, [&values](std::size_t first, std::size_t last) { Compute(values, first, last); });
+			passTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		const benchmarks::Statistics passStatistics = benchmarks::ComputeStatistics(passTimes);
+		if (threadCount == 1)
+		{
+			singleThreadMs = passStatistics.p50;
+		}
+
+		// empty jobs
+		std::vector<double> jobCosts;
+		for (long long pass = 0; pass < passes; pass++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			util::Job* root = jobSystem.CreateJob([] {});
+			for (long long job = 0; job < jobs; job++)
+			{
+				jobSystem.Run(jobSystem.CreateChildJob(root, [] {}));
+			}
+			jobSystem.Run(root);
+			jobSystem.Wait(root);
+			jobCosts.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / (jobs + 1));
+		}
+
+		const util::JobSystemStatistics statistics = jobSystem.GetStatistics();
+		const double speedup = singleThreadMs / passStatistics.p50;
+		results.Begin("jobSystem")
+			.Add("threads", threadCount)
+			.Add("items", static_cast<unsigned long long>(items))
+			.Add("grain", static_cast<unsigned long long>(grain))
+			.Add("parallelForMs", passStatistics)
+			.Add("speedup", speedup)
+			.Add("efficiency", speedup / threadCount)
+			.Add("jobNs", benchmarks::ComputeStatistics(jobCosts))
+			.Add("executedJobs", statistics.executedJobs)
+			.Add("stolenJobs", statistics.stolenJobs)
+			.Add("inlineJobs", statistics.inlineJobs)
+			.Add("sleeps", statistics.sleeps)
+			.End();
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
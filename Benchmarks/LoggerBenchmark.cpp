@@ -0,0 +1,250 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* LoggerBenchmark.cpp
+*
+* Throughput and latency of util::Logger
+*
+* For every log policy, number of producer threads and message size:
+* - the latency of each Print call as seen by the producer (p50 / p99 / p999 / max, in nanoseconds)
+* - the sustained number of messages per second while all producers log as fast as they can
+* - the drain lag: time from Print to the moment the daemon handed the message to the sinks (in microseconds)
+* - the time Flush() needs to catch up once the producers are done
+*
+* Options:
+*	--threads <n>		maximum number of producer threads, the benchmark runs 1, 2, 4, ... up to n (default: hardware threads, at most 8)
+*	--messages <n>		messages per producer thread (default: 100000)
+*	--policy <name>		null, file, mapped or all (default: all)
+*	--directory <path>	where the log files are written (default: /tmp)
+*	--unregistered		the producers do not call SetThreadName and share the logger's buffer
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <atomic>			// atomic objects (no data races)
+#include <chrono>			// clocks
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <thread>			// producers
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/Log.h"
+#include "../Bell0BytesGamingProgramming/MappedFileLogPolicy.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	// Discards every line: measures the logger and the formatting without any I/O
+	class NullLogPolicy : public util::LogPolicyInterface
+	{
+	public:
+		bool OpenOutputStream(const std::wstring&) override { return true; };
+		void CloseOutputStream() override {};
+		void Write(const std::string&) override {};
+		void Flush() override {};
+	};
+
+	// Structured sink measuring the time between Print and the moment the daemon hands the record to the sinks
+	class DrainLagProbe : public util::LogPolicyInterface
+	{
+	public:
+		explicit DrainLagProbe(std::size_t capacity) { lags.reserve(capacity); };
+
+		bool OpenOutputStream(const std::wstring&) override { return true; };
+		void CloseOutputStream() override {};
+		void Write(const std::string&) override {};
+		void Flush() override {};
+
+		bool IsStructured() const override { return true; };
+		void WriteRecord(const util::LogRecord& record, const std::string&) override
+		{
+			if (lags.size() < lags.capacity())
+			{
+				std::int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+				lags.push_back((now - record.timestamp) / 1000.0);
+			}
+		};
+
+		std::vector<double> lags;			// microseconds, only written by the daemon
+	};
+
+	enum class MessageSize
+	{
+		empty,			// format string only
+		small,			// three integers
+		medium,			// integer, double and a short string
+		large,			// a 400 character string
+	};
+
+	const char* GetName(MessageSize size)
+	{
+		switch (size)
+		{
+		case MessageSize::empty: return "empty";
+		case MessageSize::small: return "small";
+		case MessageSize::medium: return "medium";
+		default: return "large";
+		}
+	}
+
+	const std::string shortText(24, 's');
+	const std::string longText(400, 'l');
+
+	template<typename LogPolicy>
+	void LogMessage(util::Logger<LogPolicy>& logger, MessageSize size, int i)
+	{
+		switch (size)
+		{
+		case MessageSize::empty:
+			logger.template Print<util::SeverityType::info>("The benchmark logged a message.");
+			break;
+		case MessageSize::small:
+			logger.template Print<util::SeverityType::info>("Message {} of frame {} on track {}.", i, i / 60, i % 7);
+			break;
+		case MessageSize::medium:
+			logger.template Print<util::SeverityType::info>("Message {index}: {value} {text}", i, i * 0.25, shortText);
+			break;
+		case MessageSize::large:
+			logger.template Print<util::SeverityType::info>("Message {}: {}", i, longText);
+			break;
+		}
+	}
+
+	struct Configuration
+	{
+		std::string policyName;
+		std::wstring filename;
+		unsigned int threads;
+		MessageSize size;
+		int messagesPerThread;
+		bool registerThreads;
+	};
+
+	template<typename LogPolicy>
+	void Run(const Configuration& configuration, benchmarks::ResultWriter& results)
+	{
+		const std::size_t totalMessages = static_cast<std::size_t>(configuration.threads) * configuration.messagesPerThread;
+
+		util::Logger<LogPolicy> logger(configuration.filename);
+		std::shared_ptr<DrainLagProbe> probe = std::make_shared<DrainLagProbe>(totalMessages);
+		logger.AddRoute(util::SeverityType::info, logger.AddSink(probe));
+
+		// the producers wait for each other, then log as fast as they can
+		std::vector<std::vector<double>> latencies(configuration.threads);
+		std::atomic<unsigned int> readyThreads(0);
+		std::atomic<bool> start(false);
+		std::vector<std::thread> producers;
+		for (unsigned int t = 0; t < configuration.threads; t++)
+		{
+			producers.emplace_back([&, t]
+			{
+				std::vector<double>& samples = latencies[t];
+				samples.resize(configuration.messagesPerThread);
+				if (configuration.registerThreads)
+				{
+					logger.SetThreadName("producer " + std::to_string(t));
+				}
+
+				readyThreads.fetch_add(1);
+				while (!start.load(std::memory_order_acquire))
+				{
+					std::this_thread::yield();
+				}
+
+				for (int i = 0; i < configuration.messagesPerThread; i++)
+				{
+					auto begin = std::chrono::steady_clock::now();
+					LogMessage(logger, configuration.size, i);
+					auto end = std::chrono::steady_clock::now();
+					samples[i] = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - begin).count());
+				}
+			});
+		}
+
+		while (readyThreads.load() < configuration.threads)
+		{
+			std::this_thread::yield();
+		}
+		auto begin = std::chrono::steady_clock::now();
+		start.store(true, std::memory_order_release);
+		for (auto& producer : producers)
+		{
+			producer.join();
+		}
+		auto produced = std::chrono::steady_clock::now();
+		logger.Flush();
+		auto flushed = std::chrono::steady_clock::now();
+
+		std::vector<double> allLatencies;
+		allLatencies.reserve(totalMessages);
+		for (const auto& samples : latencies)
+		{
+			allLatencies.insert(allLatencies.end(), samples.begin(), samples.end());
+		}
+
+		const double seconds = std::chrono::duration<double>(produced - begin).count();
+		const double secondsUntilFlushed = std::chrono::duration<double>(flushed - begin).count();
+		results.Begin("logger")
+			.Add("policy", configuration.policyName)
+			.Add("threads", configuration.threads)
+			.Add("messageSize", GetName(configuration.size))
+			.Add("registeredThreads", configuration.registerThreads ? 1 : 0)
+			.Add("messages", static_cast<unsigned long long>(totalMessages))
+			.Add("seconds", seconds)
+			.Add("messagesPerSecond", totalMessages / seconds)
+			.Add("sustainedMessagesPerSecond", totalMessages / secondsUntilFlushed)
+			.Add("flushMilliseconds", std::chrono::duration<double, std::milli>(flushed - produced).count())
+			.Add("dropped", logger.GetDroppedMessageCount())
+			.Add("latencyNs", benchmarks::ComputeStatistics(allLatencies))
+			.Add("drainLagUs", benchmarks::ComputeStatistics(probe->lags))
+			.End();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	unsigned int hardwareThreads = std::thread::hardware_concurrency();
+	unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", hardwareThreads > 0 && hardwareThreads < 8 ? hardwareThreads : 8));
+	const int messagesPerThread = static_cast<int>(options.GetInteger("messages", 100000));
+	const std::string policy = options.GetString("policy", "all");
+	const std::string directory = options.GetString("directory", "/tmp");
+	const bool registerThreads = !options.Has("unregistered");
+
+	benchmarks::ResultWriter results(std::cout);
+	for (unsigned int threads : benchmarks::GetThreadCounts(maxThreads))
+	{
+		for (MessageSize size : { MessageSize::empty, MessageSize::small, MessageSize::medium, MessageSize::large })
+		{
+			Configuration configuration = { "", L"", threads, size, messagesPerThread, registerThreads };
+			if (policy == "all" || policy == "null")
+			{
+				configuration.policyName = "null";
+				Run<NullLogPolicy>(configuration, results);
+			}
+			if (policy == "all" || policy == "file")
+			{
+				configuration.policyName = "file";
+				configuration.filename = util::StringConverter::s2ws(directory + "/LoggerBenchmark.log");
+				Run<util::FileLogPolicy>(configuration, results);
+			}
+			if (policy == "all" || policy == "mapped")
+			{
+				configuration.policyName = "mapped";
+				configuration.filename = util::StringConverter::s2ws(directory + "/LoggerBenchmarkMapped.log");
+				Run<util::MappedFileLogPolicy>(configuration, results);
+			}
+		}
+	}
+	return 0;
+}
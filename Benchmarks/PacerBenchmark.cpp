@@ -0,0 +1,120 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* PacerBenchmark.cpp
+*
+* Precision and CPU cost of the frame limiter: sleeping, spinning and the hybrid wait
+*
+* For every target frame rate and wait mode, a game loop with a fixed amount of work per frame is paced for a while:
+* - the jitter: the absolute difference between the actual and the target frame time (p50 / p99 / max, in ms)
+* - the mean frame time, the frames that missed the grid and how late the waits woke up
+* - the CPU time the process used per second of real time; 1.0 is a whole core
+*
+* Options:
+*	--seconds <s>		real time per configuration (default: 2)
+*	--work <ms>			busy work per frame (default: 2)
+*	--rates <list>		target frame rates, comma separated (default: 60,144,240)
+*	--directory <path>	where the log and the report of the last configuration are written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// clocks
+#include <ctime>			// std::clock, process CPU time
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <sstream>			// string streams
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/FramePacer.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	std::vector<double> ParseRates(const std::string& list)
+	{
+		std::vector<double> rates;
+		std::istringstream in(list);
+		std::string rate;
+		while (std::getline(in, rate, ','))
+		{
+			rates.push_back(std::stod(rate));
+		}
+		return rates;
+	}
+
+	// the work of a frame: spins for the given time on the clock
+	void Work(const core::ClockSource& clock, double seconds)
+	{
+		const std::int64_t end = clock.GetCounts() + (std::int64_t)(seconds / clock.GetSecondsPerCount());
+		while (clock.GetCounts() < end)
+		{
+		}
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const double seconds = options.GetDouble("seconds", 2.0);
+	const double work = options.GetDouble("work", 2.0) / 1000.0;
+	const std::vector<double> rates = ParseRates(options.GetString("rates", "60,144,240"));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/PacerBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	std::unique_ptr<core::ClockSource> clock = core::ClockSource::Create();
+	const core::FrameWaitMode waitModes[] = { core::FrameWaitMode::sleep, core::FrameWaitMode::spin, core::FrameWaitMode::hybrid };
+
+	for (double rate : rates)
+	{
+		for (core::FrameWaitMode waitMode : waitModes)
+		{
+			core::FramePacer pacer(*clock, rate, waitMode);
+
+			const std::clock_t cpuStart = std::clock();
+			const auto start = std::chrono::steady_clock::now();
+			while (std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds)
+			{
+				Work(*clock, work);
+				pacer.WaitForNextFrame();
+			}
+			const double wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+			const double cpuSeconds = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+
+			const core::FramePacingSummary summary = pacer.GetSummary();
+			results.Begin("framePacer")
+				.Add("targetFrameRate", rate)
+				.Add("waitMode", core::FramePacer::GetName(waitMode))
+				.Add("workMs", work * 1000.0)
+				.Add("frames", summary.frames)
+				.Add("meanFrameTimeMs", summary.meanFrameTime)
+				.Add("jitterP50Ms", summary.p50Jitter)
+				.Add("jitterP99Ms", summary.p99Jitter)
+				.Add("jitterMaxMs", summary.maxJitter)
+				.Add("missedFrames", summary.missedFrames)
+				.Add("overshootMs", summary.meanOvershoot)
+				.Add("sleepShare", summary.sleepShare)
+				.Add("sleepOvershootMs", pacer.GetSleepOvershoot() * 1000.0)
+				.Add("cpuPerSecond", cpuSeconds / wallSeconds)
+				.End();
+
+			pacer.WriteReport(util::StringConverter::s2ws(directory + "/PacerBenchmark.txt"));
+		}
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
@@ -0,0 +1,223 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* PipelineBenchmark.cpp
+*
+* Frame rate of the serial game loop against the pipelined one, with updates and rendering of a fixed cost
+*
+* Every update does a fixed amount of busy work and writes its number into every star, every frame does busy work and checks that
+* all stars of the snapshot it renders carry the same number. The work is calibrated once, thus on a machine with fewer
+* cores than threads it takes longer, as real work would. Serially, a frame costs the render time plus the updates
+* it runs; pipelined, it should approach the longer of the two. For both loops:
+* - the frame rate, the frame times (ms) and the game speed: simulated time per real time, 1.0 is full speed
+* - the snapshots that were torn, i.e. written while they were rendered, always 0
+* - the age of the rendered snapshots, and the CPU time the process used per second of real time
+*
+* Options:
+*	--seconds <s>		real time per loop (default: 3)
+*	--update <ms>		work per update (default: 2)
+*	--render <ms>		work per frame (default: 8)
+*	--dt <s>			fixed time step (default: 1/240)
+*	--stars <n>			size of the state copied into the snapshots (default: 50000)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::max
+#include <cstdint>			// fixed width integers
+#include <ctime>			// std::clock, process CPU time
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/FixedStepLoop.h"
+#include "../Bell0BytesGamingProgramming/PipelinedLoop.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	// busy work of a fixed number of iterations: on a busy machine it takes longer, as real work would
+	std::uint64_t Work(std::uint64_t iterations)
+	{
+		volatile std::uint64_t sum = 0;
+		for (std::uint64_t i = 0; i < iterations; i++)
+		{
+			sum = sum + i;
+		}
+		return sum;
+	}
+
+	// the iterations of Work per second, measured on an idle thread
+	double CalibrateWork(const core::ClockSource& clock)
+	{
+		const std::uint64_t iterations = 1000000;
+		double best = 0.0;
+		for (int run = 0; run < 5; run++)
+		{
+			const std::int64_t start = clock.GetCounts();
+			Work(iterations);
+			const double seconds = (clock.GetCounts() - start) * clock.GetSecondsPerCount();
+			best = std::max(best, iterations / seconds);
+		}
+		return best;
+	}
+
+	// the game: the state, its snapshots, and what the loops measure
+	struct Game
+	{
+		Game(std::size_t stars, std::uint64_t updateWork, std::uint64_t renderWork) : updateWork(updateWork), renderWork(renderWork), stars(stars, 0), updates(0), tornSnapshots(0)
+		{
+			for (std::vector<std::uint64_t>& snapshot : snapshots)
+			{
+				snapshot.assign(stars, 0);
+			}
+		};
+
+		util::Expected<int> Update(double)
+		{
+			Work(updateWork);
+			updates++;
+			for (std::uint64_t& star : stars)
+			{
+				star = updates;
+			}
+			return 0;
+		}
+
+		void WriteSnapshot(unsigned int slot)
+		{
+			snapshots[slot] = stars;
+		}
+
+		void Render(unsigned int slot)
+		{
+			Work(renderWork);
+			const std::vector<std::uint64_t>& snapshot = snapshots[slot];
+			for (std::uint64_t star : snapshot)
+			{
+				if (star != snapshot.front())
+				{
+					tornSnapshots++;
+					break;
+				}
+			}
+		}
+
+		const std::uint64_t updateWork;		// iterations of busy work
+		const std::uint64_t renderWork;
+		std::vector<std::uint64_t> stars;
+		std::vector<std::uint64_t> snapshots[core::PipelinedLoop::snapshotSlotCount];
+		std::uint64_t updates;
+		unsigned long long tornSnapshots;
+	};
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const double seconds = options.GetDouble("seconds", 3.0);
+	const double updateWork = options.GetDouble("update", 2.0) / 1000.0;
+	const double renderWork = options.GetDouble("render", 8.0) / 1000.0;
+	const double dt = options.GetDouble("dt", 1.0 / 240.0);
+	const std::size_t stars = static_cast<std::size_t>(options.GetInteger("stars", 50000));
+	const std::string directory = options.GetString("directory", "/tmp");
+	const int maxSkipFrames = 10;
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/PipelineBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	std::unique_ptr<core::ClockSource> clock = core::ClockSource::Create();
+	const double secondsPerCount = clock->GetSecondsPerCount();
+	const double iterationsPerSecond = CalibrateWork(*clock);
+
+	for (bool isPipelined : { false, true })
+	{
+		Game game(stars, (std::uint64_t)(updateWork * iterationsPerSecond), (std::uint64_t)(renderWork * iterationsPerSecond));
+		std::vector<double> frameTimes;
+		double gameTime = 0.0;
+		double snapshotAge = 0.0;
+
+		const std::clock_t cpuStart = std::clock();
+		const std::int64_t start = clock->GetCounts();
+		const std::int64_t end = start + (std::int64_t)(seconds / secondsPerCount);
+		std::int64_t previous = start;
+
+		if (isPipelined)
+		{
+			core::PipelinedLoop pipeline(*clock, dt, maxSkipFrames, core::CatchUpPolicyType::clamp);
+			pipeline.Start([&game](double stepTime) { return game.Update(stepTime); }, [&game](unsigned int slot) { game.WriteSnapshot(slot); });
+			while (previous < end)
+			{
+				pipeline.AcquireSnapshot();
+				snapshotAge += pipeline.GetLastFrame().age;
+				game.Render(pipeline.GetSnapshotSlot());
+
+				const std::int64_t now = clock->GetCounts();
+				frameTimes.push_back((now - previous) * secondsPerCount * 1000.0);
+				previous = now;
+			}
+			if (!pipeline.Stop().isValid())
+			{
+				std::cerr << "The simulation thread failed!" << std::endl;
+				return 1;
+			}
+			gameTime = pipeline.GetSnapshot().gameTime;
+		}
+		else
+		{
+			core::FixedStepLoop loop(dt, maxSkipFrames, core::CatchUpPolicyType::clamp);
+			while (previous < end)
+			{
+				const std::int64_t now = clock->GetCounts();
+				loop.RunFrame((now - previous) * secondsPerCount, [&game, &gameTime](double stepTime)
+				{
+					gameTime += stepTime;
+					return game.Update(stepTime);
+				}, [&game](double)
+				{
+					game.WriteSnapshot(0);
+					game.Render(0);
+					return util::Expected<int>(0);
+				});
+
+				frameTimes.push_back((now - previous) * secondsPerCount * 1000.0);
+				previous = now;
+			}
+		}
+
+		const double wallSeconds = (clock->GetCounts() - start) * secondsPerCount;
+		const double cpuSeconds = (double)(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+		const std::size_t frames = frameTimes.size();
+		benchmarks::Statistics frameStatistics = benchmarks::ComputeStatistics(frameTimes);
+
+		results.Begin("pipeline")
+			.Add("loop", isPipelined ? "pipelined" : "serial")
+			.Add("updateMs", updateWork * 1000.0)
+			.Add("renderMs", renderWork * 1000.0)
+			.Add("dt", dt)
+			.Add("stars", static_cast<unsigned long long>(stars))
+			.Add("framesPerSecond", frames / wallSeconds)
+			.Add("frameMs", frameStatistics)
+			.Add("gameSpeed", gameTime / wallSeconds)
+			.Add("updates", static_cast<unsigned long long>(game.updates))
+			.Add("tornSnapshots", game.tornSnapshots)
+			.Add("snapshotAgeMs", isPipelined && frames > 0 ? snapshotAge * 1000.0 / frames : 0.0)
+			.Add("cpuPerSecond", cpuSeconds / wallSeconds)
+			.End();
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
@@ -0,0 +1,193 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* ProfilerBenchmark.cpp
+*
+* Cost of the profiler zones and of ending a frame, with one or more threads recording zones
+*
+* - the cost of a zone while the profiler has no clock, and while it is recording (nanoseconds per zone)
+* - for 1, 2, 4, ... threads recording nested zones: the zones recorded per second, the zones dropped because a buffer
+*   was full, and the time PROFILE_FRAME() takes to drain the buffers and build the call trees
+* - a Chrome trace of the last frames, written to ProfilerBenchmark.json, and the call trees to ProfilerBenchmark.txt
+*
+* Options:
+*	--zones <n>			number of zones to measure the zone cost (default: 1000000)
+*	--batch <n>			zones per sample (default: 1000)
+*	--frames <n>		frames per thread count (default: 200)
+*	--frameTime <ms>	time between two frames (default: 2)
+*	--threads <n>		max number of threads recording zones (default: hardware concurrency)
+*	--directory <path>	where the log, trace and call tree files are written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <atomic>			// atomic objects (no data races)
+#include <chrono>			// clocks
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <thread>			// threads
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/Profiler.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	// zones per sample, in nanoseconds per zone
+	benchmarks::Statistics MeasureZoneCost(long long zones, long long batch)
+	{
+		std::vector<double> costs;
+		costs.reserve(static_cast<std::size_t>(zones / batch + 1));
+		for (long long done = 0; done < zones; done += batch)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (long long i = 0; i < batch; i++)
+			{
+				PROFILE_ZONE("Empty zone");
+			}
+			auto end = std::chrono::steady_clock::now();
+			costs.push_back(std::chrono::duration<double, std::nano>(end - start).count() / batch);
+
+			// keep the buffer from filling up
+			core::Profiler::EndFrame();
+		}
+		return benchmarks::ComputeStatistics(costs);
+	}
+
+	// a small call tree: one frame zone with three jobs of two steps each
+	void RecordWork(volatile unsigned long long& sink)
+	{
+		PROFILE_ZONE("Worker frame");
+		for (int job = 0; job < 3; job++)
+		{
+			PROFILE_ZONE("Job");
+			{
+				PROFILE_ZONE("Prepare");
+				for (int i = 0; i < 500; i++)
+				{
+					sink = sink + i;
+				}
+			}
+			{
+				PROFILE_ZONE("Execute");
+				for (int i = 0; i < 2000; i++)
+				{
+					sink = sink + i;
+				}
+			}
+		}
+	}
+
+	unsigned long long CountZones(const std::vector<core::ProfileNode>& nodes)
+	{
+		unsigned long long zones = 0;
+		for (const core::ProfileNode& node : nodes)
+		{
+			zones += node.calls + CountZones(node.children);
+		}
+		return zones;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const long long zones = options.GetInteger("zones", 1000000);
+	const long long batch = options.GetInteger("batch", 1000);
+	const long long frames = options.GetInteger("frames", 200);
+	const double frameTime = options.GetDouble("frameTime", 2.0);
+	const unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", std::thread::hardware_concurrency()));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/ProfilerBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	std::unique_ptr<core::ClockSource> clock = core::ClockSource::Create();
+	core::Profiler::SetThreadName("Main thread");
+
+	// a zone without a clock only checks whether the profiler is running
+	results.Begin("profilerZone").Add("recording", false).Add("zoneNs", MeasureZoneCost(zones, batch)).End();
+
+	core::Profiler::SetClock(clock.get());
+	core::Profiler::EndFrame();
+	results.Begin("profilerZone").Add("recording", true).Add("clock", clock->GetName()).Add("zoneNs", MeasureZoneCost(zones, batch)).End();
+
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		std::atomic<bool> isRunning(true);
+		std::vector<std::thread> threads;
+		for (unsigned int t = 0; t < threadCount; t++)
+		{
+			threads.emplace_back([&isRunning, t]()
+			{
+				core::Profiler::SetThreadName("Worker " + std::to_string(t));
+				volatile unsigned long long sink = 0;
+				while (isRunning.load(std::memory_order_relaxed))
+				{
+					RecordWork(sink);
+				}
+			});
+		}
+
+		const unsigned long long droppedBefore = core::Profiler::GetDroppedZoneCount();
+		const bool isLastRun = threadCount == benchmarks::GetThreadCounts(maxThreads).back();
+		if (isLastRun)
+		{
+			core::Profiler::CaptureFrames(5, util::StringConverter::s2ws(directory + "/ProfilerBenchmark.json"));
+		}
+
+		// the first frame only drains the zones recorded before
+		core::Profiler::EndFrame();
+		std::vector<double> endFrameCosts;
+		unsigned long long recordedZones = 0;
+		auto start = std::chrono::steady_clock::now();
+		for (long long frame = 0; frame < frames; frame++)
+		{
+			std::this_thread::sleep_for(std::chrono::duration<double, std::milli>(frameTime));
+
+			auto endFrameStart = std::chrono::steady_clock::now();
+			core::Profiler::EndFrame();
+			endFrameCosts.push_back(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - endFrameStart).count());
+
+			for (const core::ProfileThreadTree& thread : core::Profiler::GetLastFrame().threads)
+			{
+				recordedZones += CountZones(thread.roots);
+			}
+		}
+		const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+		isRunning = false;
+		for (std::thread& thread : threads)
+		{
+			thread.join();
+		}
+
+		// release the buffers of the threads that exited
+		core::Profiler::EndFrame();
+
+		results.Begin("profilerFrame")
+			.Add("threads", threadCount)
+			.Add("frames", frames)
+			.Add("zonesPerSecond", recordedZones / seconds)
+			.Add("droppedZones", core::Profiler::GetDroppedZoneCount() - droppedBefore)
+			.Add("endFrameUs", benchmarks::ComputeStatistics(endFrameCosts))
+			.End();
+	}
+
+	core::Profiler::WriteReport(util::StringConverter::s2ws(directory + "/ProfilerBenchmark.txt"));
+	core::Profiler::SetClock(nullptr);
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
@@ -0,0 +1,244 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* RandomBenchmark.cpp
+*
+* Throughput of the random number generators of Random.h, against rand() and std::mt19937
+*
+* For every generator, filling an array with floats in [-1, 1):
+* - next: one NextFloat at a time; fill: the batch API
+* - the time per array (ms), the nanoseconds per float and the millions of floats per second
+* - whether the batch API wrote the same floats as NextFloat, bit for bit
+*
+* For the generators that jump ahead, on 1, 2, 4, ... threads: every job jumps to its first float and fills its part of
+* the array, which must be the same as the array filled by one generator
+*
+* First, the known answers: the Philox4x32-10 vectors of Random123 and the output of the reference PCG for seed 42 and
+* stream 54. The benchmark fails if they, or the batch and parallel fills, are not as expected.
+*
+* Options:
+*	--floats <n>		floats per array (default: 1000000)
+*	--grain <n>			floats per job (default: 16384)
+*	--passes <n>		arrays per generator (default: 50)
+*	--threads <n>		max number of threads (default: hardware concurrency)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// clocks
+#include <cstdlib>			// rand
+#include <cstring>			// std::memcmp
+#include <functional>		// std::function
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <random>			// std::mt19937
+#include <string>			// strings
+#include <thread>			// std::thread::hardware_concurrency
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/JobSystem.h"
+#include "../Bell0BytesGamingProgramming/Random.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	const std::uint64_t seed = 0x5eed;
+
+	// the known-answer vectors of Random123 (kat_vectors) for Philox4x32-10
+	struct PhiloxAnswer
+	{
+		std::uint32_t counter[4];
+		std::uint32_t key[2];
+		std::uint32_t block[4];
+	};
+
+	const PhiloxAnswer philoxAnswers[] =
+	{
+		{ { 0x00000000, 0x00000000, 0x00000000, 0x00000000 }, { 0x00000000, 0x00000000 }, { 0x6627e8d5, 0xe169c58d, 0xbc57ac4c, 0x9b00dbd8 } },
+		{ { 0xffffffff, 0xffffffff, 0xffffffff, 0xffffffff }, { 0xffffffff, 0xffffffff }, { 0x408f276d, 0x41c83b0e, 0xa20bc7c6, 0x6d5451fd } },
+		{ { 0x243f6a88, 0x85a308d3, 0x13198a2e, 0x03707344 }, { 0xa4093822, 0x299f31d0 }, { 0xd16cfe09, 0x94fdcceb, 0x5001e420, 0x24126ea1 } },
+	};
+
+	// the first numbers of pcg32-demo of the reference implementation, seeded with 42 and stream 54
+	const std::uint32_t pcgAnswers[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+
+	bool CheckPhilox()
+	{
+		for (const PhiloxAnswer& answer : philoxAnswers)
+		{
+			std::uint32_t block[4];
+			graphics::Philox4x32::GenerateBlock(answer.counter, answer.key, block);
+			if (std::memcmp(block, answer.block, sizeof(block)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool CheckPcg()
+	{
+		graphics::Pcg32 generator(42, 54);
+		for (std::uint32_t answer : pcgAnswers)
+		{
+			if (generator.Next() != answer)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// the time per pass in milliseconds
+	benchmarks::Statistics Time(long long passes, const std::function<void()>& pass)
+	{
+		std::vector<double> times;
+		for (long long i = 0; i < passes; i++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			pass();
+			times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return benchmarks::ComputeStatistics(times);
+	}
+
+	void Write(benchmarks::ResultWriter& results, const char* generator, const char* api, unsigned int threads, std::size_t floats, const benchmarks::Statistics& statistics, bool isIdentical)
+	{
+		results.Begin("random")
+			.Add("generator", generator)
+			.Add("api", api)
+			.Add("threads", threads)
+			.Add("floats", static_cast<unsigned long long>(floats))
+			.Add("ms", statistics)
+			.Add("nsPerFloat", statistics.p50 * 1000000.0 / floats)
+			.Add("millionFloatsPerSecond", floats / (statistics.p50 * 1000.0))
+			.Add("isIdentical", isIdentical)
+			.End();
+	}
+
+	// one float at a time, then the batch API, from the same seed; returns whether they agree
+	template<typename Generator>
+	bool MeasureGenerator(benchmarks::ResultWriter& results, const char* name, std::vector<float>& next, std::vector<float>& fill, long long passes)
+	{
+		Generator nextGenerator(seed);
+		const benchmarks::Statistics nextStatistics = Time(passes, [&]
+		{
+			for (float& value : next)
+			{
+				value = nextGenerator.NextFloat(-1.0f, 1.0f);
+			}
+		});
+
+		Generator fillGenerator(seed);
+		const benchmarks::Statistics fillStatistics = Time(passes, [&] { fillGenerator.Fill(fill.data(), fill.size(), -1.0f, 1.0f); });
+
+		// both generators made passes arrays: the last ones must agree
+		const bool isIdentical = std::memcmp(next.data(), fill.data(), next.size() * sizeof(float)) == 0;
+		Write(results, name, "next", 1, next.size(), nextStatistics, isIdentical);
+		Write(results, name, "fill", 1, fill.size(), fillStatistics, isIdentical);
+		return isIdentical;
+	}
+
+	// every job jumps to its part of the array; returns whether the parallel fill is the serial one
+	template<typename Generator>
+	bool MeasureParallel(benchmarks::ResultWriter& results, const char* name, util::JobSystem& jobSystem, std::vector<float>& serial, std::vector<float>& parallel, std::size_t grain, long long passes)
+	{
+		Generator generator(seed);
+		generator.Fill(serial.data(), serial.size(), -1.0f, 1.0f);
+
+		float* out = parallel.data();
+		const benchmarks::Statistics statistics = Time(passes, [&]
+		{
+			jobSystem.ParallelFor(0, parallel.size(), grain, [out](std::size_t first, std::size_t last)
+			{
+				Generator part(seed);
+				part.Discard(first);
+				part.Fill(out + first, last - first, -1.0f, 1.0f);
+			});
+		});
+
+		const bool isIdentical = std::memcmp(serial.data(), parallel.data(), serial.size() * sizeof(float)) == 0;
+		Write(results, name, "parallelFill", jobSystem.GetWorkerCount() + 1, parallel.size(), statistics, isIdentical);
+		return isIdentical;
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const std::size_t floats = static_cast<std::size_t>(options.GetInteger("floats", 1000000));
+	const std::size_t grain = static_cast<std::size_t>(options.GetInteger("grain", 16384));
+	const long long passes = options.GetInteger("passes", 50);
+	const unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", std::thread::hardware_concurrency()));
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/RandomBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	// the generators must be the published ones before their speed means anything
+	const bool isPhiloxCorrect = CheckPhilox();
+	const bool isPcgCorrect = CheckPcg();
+	results.Begin("randomKnownAnswers")
+		.Add("generator", "philox4x32")
+		.Add("vectors", static_cast<unsigned long long>(sizeof(philoxAnswers) / sizeof(philoxAnswers[0])))
+		.Add("isCorrect", isPhiloxCorrect)
+		.End();
+	results.Begin("randomKnownAnswers")
+		.Add("generator", "pcg32")
+		.Add("vectors", static_cast<unsigned long long>(sizeof(pcgAnswers) / sizeof(pcgAnswers[0])))
+		.Add("isCorrect", isPcgCorrect)
+		.End();
+	bool isCorrect = isPhiloxCorrect && isPcgCorrect;
+
+	std::vector<float> first(floats);
+	std::vector<float> second(floats);
+
+	// the baselines: the generator the game used, and the one of the standard library
+	std::srand((unsigned int)seed);
+	Write(results, "rand", "next", 1, floats, Time(passes, [&first]
+	{
+		for (float& value : first)
+		{
+			value = static_cast<float>(rand() / static_cast<float>(RAND_MAX)) * 2 - 1;
+		}
+	}), false);
+
+	std::mt19937 twister((std::mt19937::result_type)seed);
+	Write(results, "mt19937", "next", 1, floats, Time(passes, [&first, &twister]
+	{
+		for (float& value : first)
+		{
+			value = -1.0f + graphics::ToUnitFloat((std::uint32_t)twister()) * 2.0f;
+		}
+	}), false);
+
+	isCorrect = MeasureGenerator<graphics::Philox4x32>(results, "philox4x32", first, second, passes) && isCorrect;
+	isCorrect = MeasureGenerator<graphics::Pcg32>(results, "pcg32", first, second, passes) && isCorrect;
+	isCorrect = MeasureGenerator<graphics::Xoshiro128Plus>(results, "xoshiro128+", first, second, passes) && isCorrect;
+
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		util::JobSystem jobSystem(threadCount - 1);
+		isCorrect = MeasureParallel<graphics::Philox4x32>(results, "philox4x32", jobSystem, first, second, grain, passes) && isCorrect;
+		isCorrect = MeasureParallel<graphics::Pcg32>(results, "pcg32", jobSystem, first, second, grain, passes) && isCorrect;
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	if (!isCorrect)
+	{
+		std::cerr << "A generator does not produce the expected numbers!" << std::endl;
+		return 1;
+	}
+	return 0;
+}
@@ -0,0 +1,194 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* RasterizerBenchmark.cpp
+*
+* Throughput and correctness of the software render device: the stars of the game, packed into 12-byte vertices, are drawn
+* as a triangle list into a framebuffer in memory, on 1, 2, 4, ... threads, without a GPU or a window
+*
+* The reference picture is drawn on the calling thread, as a single tile. For every thread count, the frames are cleared,
+* drawn and presented with tiles of --tile pixels:
+* - fixed: the color is interpolated by the device, as PixelShader.hlsl does
+* - callback: the same color through a pixel shader callback, which is the cost of the std::function per pixel
+* For every row, the time per frame (ms), the triangles per millisecond, the counters of the rasterizer, and the pixels
+* that differ from the reference, which are 0: the picture is the same whatever the tiles and the threads.
+*
+* Options:
+*	--width <n>			width of the framebuffer (default: 640)
+*	--height <n>		height of the framebuffer (default: 360)
+*	--stars <n>			stars, thus vertices, three per triangle (default: 3000)
+*	--frames <n>		frames per row (default: 20)
+*	--tile <n>			pixels per side of a tile (default: 64)
+*	--batch <n>			triangles per setup job (default: 256)
+*	--threads <n>		max number of threads (default: hardware concurrency)
+*	--image <path>		writes the reference picture as a binary PPM, to diff the pictures of two builds (default: none)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::max
+#include <chrono>			// clocks
+#include <cstdint>			// fixed width integers
+#include <cstring>			// std::memcpy
+#include <fstream>			// file streams
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <thread>			// std::thread::hardware_concurrency
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/JobSystem.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/SoftwareRenderDevice.h"
+#include "../Bell0BytesGamingProgramming/Starfield.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+#include "../Bell0BytesGamingProgramming/Vertex.h"
+
+#pragma endregion
+
+namespace
+{
+	// uploads the packed stars into a new vertex buffer of the device and binds it
+	bool UploadStars(graphics::RenderDevice& device, const std::vector<graphics::PackedVertex>& vertices)
+	{
+		const std::size_t size = vertices.size() * sizeof(graphics::PackedVertex);
+		util::Expected<graphics::BufferHandle> buffer = device.CreateBuffer(size);
+		if (!buffer.isValid())
+		{
+			return false;
+		}
+		util::Expected<void*> mapped = device.MapBuffer(buffer.get(), graphics::MapMode::discard);
+		if (!mapped.isValid())
+		{
+			return false;
+		}
+		std::memcpy(mapped.get(), vertices.data(), size);
+		device.UnmapBuffer(buffer.get());
+
+		device.SetVertexBuffer(buffer.get(), sizeof(graphics::PackedVertex), 0);
+		return true;
+	}
+
+	std::size_t CountMismatches(const std::vector<std::uint32_t>& picture, const std::vector<std::uint32_t>& reference)
+	{
+		std::size_t mismatches = 0;
+		for (std::size_t pixel = 0; pixel < picture.size(); pixel++)
+		{
+			mismatches += picture[pixel] != reference[pixel] ? 1 : 0;
+		}
+		return mismatches;
+	}
+
+	bool WriteImage(const std::string& path, const graphics::SoftwareRenderDevice& device)
+	{
+		std::ofstream file(path, std::ios::binary);
+		file << "P6\n" << device.GetWidth() << " " << device.GetHeight() << "\n255\n";
+		for (std::uint32_t color : device.GetFramebuffer())
+		{
+			const char rgb[3] = { (char)(color & 0xff), (char)((color >> 8) & 0xff), (char)((color >> 16) & 0xff) };
+			file.write(rgb, sizeof(rgb));
+		}
+		return file.good();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const unsigned int width = static_cast<unsigned int>(options.GetInteger("width", 640));
+	const unsigned int height = static_cast<unsigned int>(options.GetInteger("height", 360));
+	const std::size_t starCount = static_cast<std::size_t>(options.GetInteger("stars", 3000));
+	const long long frames = options.GetInteger("frames", 20);
+	const unsigned int tileSize = static_cast<unsigned int>(options.GetInteger("tile", 64));
+	const std::size_t batch = static_cast<std::size_t>(options.GetInteger("batch", 256));
+	const unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", std::thread::hardware_concurrency()));
+	const std::string image = options.GetString("image", "");
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/RasterizerBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	// the stars of the game, as the first frame packs them
+	graphics::StarField stars;
+	stars.Resize(starCount);
+	graphics::SpawnStarfield(stars, graphics::GetStarfieldKey(0x5eed, 0), nullptr);
+	std::vector<graphics::PackedVertex> vertices(starCount);
+	graphics::PackStarsScalar(stars, vertices.data(), 0, starCount, 1.0f);
+
+	const float black[] = { 0.0f, 0.0f, 0.0f, 0.0f };
+
+	// the reference: one thread, one tile
+	graphics::SoftwareRenderDevice reference(width, height, nullptr, (std::max)(width, height), batch);
+	if (!UploadStars(reference, vertices))
+	{
+		std::cerr << "Unable to upload the stars!" << std::endl;
+		return 1;
+	}
+	reference.SetShaders(graphics::ShadePackedVertex, nullptr);
+	reference.Clear(black);
+	reference.Draw(starCount, 0);
+	if (!image.empty() && !WriteImage(image, reference))
+	{
+		std::cerr << "Unable to write " << image << "!" << std::endl;
+		return 1;
+	}
+
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		util::JobSystem jobSystem(threadCount - 1);
+		for (bool hasPixelShader : { false, true })
+		{
+			graphics::SoftwareRenderDevice device(width, height, &jobSystem, tileSize, batch);
+			if (!UploadStars(device, vertices))
+			{
+				std::cerr << "Unable to upload the stars!" << std::endl;
+				return 1;
+			}
+			graphics::PixelShaderFunction pixelShader = nullptr;
+			if (hasPixelShader)
+			{
+				pixelShader = [](const graphics::ShaderVertex& input, float* rgba) { std::memcpy(rgba, input.color, sizeof(input.color)); };
+			}
+			device.SetShaders(graphics::ShadePackedVertex, pixelShader);
+
+			std::vector<double> times;
+			for (long long frame = 0; frame < frames; frame++)
+			{
+				const auto start = std::chrono::steady_clock::now();
+				device.Clear(black);
+				device.Draw(starCount, 0);
+				device.Present();
+				times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			}
+
+			const graphics::RasterizerStatistics& statistics = device.GetStatistics();
+			const benchmarks::Statistics time = benchmarks::ComputeStatistics(times);
+			results.Begin("rasterizer")
+				.Add("shader", hasPixelShader ? "callback" : "fixed")
+				.Add("threads", threadCount)
+				.Add("width", width)
+				.Add("height", height)
+				.Add("tile", tileSize)
+				.Add("ms", time)
+				.Add("trianglesPerMs", statistics.triangles / time.p50)
+				.Add("triangles", static_cast<unsigned long long>(statistics.triangles))
+				.Add("visibleTriangles", static_cast<unsigned long long>(statistics.visibleTriangles))
+				.Add("binnedTriangles", static_cast<unsigned long long>(statistics.binnedTriangles))
+				.Add("shadedPixels", static_cast<unsigned long long>(statistics.shadedPixels))
+				.Add("mismatchedPixels", static_cast<unsigned long long>(CountMismatches(device.GetFramebuffer(), reference.GetFramebuffer())))
+				.Add("isIdentical", device.GetFramebuffer() == reference.GetFramebuffer())
+				.End();
+		}
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
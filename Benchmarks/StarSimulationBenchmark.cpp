@@ -0,0 +1,139 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* StarSimulationBenchmark.cpp
+*
+* Cost of simulating the starfield: the scalar kernel, the SIMD kernel, then the SIMD kernel on 1, 2, 4, ... threads
+*
+* Every simulator starts from the same spawned starfield and runs the same steps. For every simulator:
+* - the time per step (ms) and the number of stars updated per millisecond
+* - the number of stars that died and spawned again, per step
+* - whether the starfield after the last step is the same bit for bit as the one of the scalar kernel; always true,
+*   whatever the number of threads
+*
+* Options:
+*	--stars <n>			stars per starfield (default: 1000000)
+*	--steps <n>			steps per simulator (default: 120)
+*	--dt <seconds>		the length of a step (default: 1/60)
+*	--grain <n>			stars per job (default: 4096)
+*	--threads <n>		max number of threads (default: hardware concurrency)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::count
+#include <chrono>			// clocks
+#include <cstring>			// std::memcmp
+#include <functional>		// std::function
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <thread>			// std::thread::hardware_concurrency
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/JobSystem.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/Starfield.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	bool IsIdentical(const graphics::StarField& a, const graphics::StarField& b)
+	{
+		for (std::size_t stream = 0; stream < graphics::StarField::streamCount; stream++)
+		{
+			if (std::memcmp(a.GetStream((graphics::StarStream)stream), b.GetStream((graphics::StarStream)stream), a.GetSize() * sizeof(float)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// the stars that spawned during the last step are the only ones of age zero
+	std::size_t CountSpawns(const graphics::StarField& stars)
+	{
+		const float* age = stars.GetStream(graphics::StarStream::age);
+		return (std::size_t)std::count(age, age + stars.GetSize(), 0.0f);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const std::size_t starCount = static_cast<std::size_t>(options.GetInteger("stars", 1000000));
+	const long long steps = options.GetInteger("steps", 120);
+	const float dt = static_cast<float>(options.GetDouble("dt", 1.0 / 60.0));
+	const std::size_t grain = static_cast<std::size_t>(options.GetInteger("grain", 4096));
+	const unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", std::thread::hardware_concurrency()));
+	const std::string directory = options.GetString("directory", "/tmp");
+	const std::uint32_t seed = 0x5eed;
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/StarSimulationBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	// the starfield every simulator starts from
+	graphics::StarField initial(starCount);
+	graphics::SpawnStarfield(initial, graphics::GetStarfieldKey(seed, 0), nullptr);
+
+	graphics::StarField stars;
+	graphics::StarField reference;
+	bool hasReference = false;
+
+	// runs the steps from the initial starfield and writes the results; the first simulator is the reference
+	auto measure = [&](const char* simulator, const char* kernel, unsigned int threadCount, const std::function<void(float, std::uint64_t)>& simulate)
+	{
+		stars = initial;
+		std::vector<double> times;
+		std::size_t spawns = 0;
+		for (long long step = 1; step <= steps; step++)
+		{
+			const std::uint64_t key = graphics::GetStarfieldKey(seed, (std::uint64_t)step);
+			const auto start = std::chrono::steady_clock::now();
+			simulate(dt, key);
+			times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+			spawns += CountSpawns(stars);
+		}
+
+		if (!hasReference)
+		{
+			reference = stars;
+			hasReference = true;
+		}
+
+		const benchmarks::Statistics statistics = benchmarks::ComputeStatistics(times);
+		results.Begin("starSimulation")
+			.Add("simulator", simulator)
+			.Add("kernel", kernel)
+			.Add("threads", threadCount)
+			.Add("stars", static_cast<unsigned long long>(starCount))
+			.Add("steps", steps)
+			.Add("ms", statistics)
+			.Add("starsPerMs", starCount / statistics.p50)
+			.Add("spawnsPerStep", (double)spawns / steps)
+			.Add("isIdentical", IsIdentical(stars, reference))
+			.End();
+	};
+
+	measure("scalar", "scalar", 1, [&stars, starCount](float step, std::uint64_t key) { graphics::SimulateStarsScalar(stars, 0, starCount, step, key); });
+	measure("simd", graphics::GetSimulationKernelName(), 1, [&stars, starCount](float step, std::uint64_t key) { graphics::SimulateStars(stars, 0, starCount, step, key); });
+
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		util::JobSystem jobSystem(threadCount - 1);
+		measure("parallel", graphics::GetSimulationKernelName(), threadCount, [&stars, &jobSystem, grain](float step, std::uint64_t key) { graphics::SimulateStarfield(stars, step, key, &jobSystem, grain); });
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
@@ -0,0 +1,219 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* StarfieldBenchmark.cpp
+*
+* Cost of spawning the starfield: the rand() loop of the game against the counter-based kernels, on 1, 2, 4, ... threads;
+* then the cost of packing the stars into 12-byte vertices, and of copying them into the vertex buffer
+*
+* For every generator:
+* - the time per starfield (ms), the nanoseconds per star and the speedup over the rand() loop
+* - whether the starfield is the same bit for bit as the one of the scalar kernel; always true but for the rand() loop,
+*   whatever the number of threads
+*
+* For every packer, the time per starfield, whether the vertices are those of the scalar kernel, and the largest error of
+* a position. For the full and the packed vertices, the time to copy a starfield into the mapped buffer.
+*
+* Options:
+*	--stars <n>			stars per starfield (default: 50000)
+*	--grain <n>			stars per job (default: 4096)
+*	--passes <n>		starfields per generator (default: 200)
+*	--threads <n>		max number of threads (default: hardware concurrency)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <algorithm>		// std::fill, std::max
+#include <chrono>			// clocks
+#include <cmath>			// std::fabs
+#include <cstdlib>			// rand
+#include <cstring>			// std::memcmp
+#include <functional>		// std::function
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <thread>			// std::thread::hardware_concurrency
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/JobSystem.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/Starfield.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+
+#pragma endregion
+
+namespace
+{
+	// the rand() helper the game used before
+	float RandomUnit()
+	{
+		return static_cast<float>(rand() / static_cast<float>(RAND_MAX));
+	}
+
+	void GenerateWithRand(graphics::Vertex* stars, std::size_t count)
+	{
+		for (std::size_t i = 0; i < count; i++)
+		{
+			stars[i] = { RandomUnit() * 2 - 1, RandomUnit() * 2 - 1, RandomUnit() * 2 - 1, RandomUnit(), RandomUnit(), RandomUnit() };
+		}
+	}
+
+	bool IsIdentical(const graphics::StarField& a, const graphics::StarField& b)
+	{
+		for (std::size_t stream = 0; stream < graphics::StarField::streamCount; stream++)
+		{
+			if (std::memcmp(a.GetStream((graphics::StarStream)stream), b.GetStream((graphics::StarStream)stream), a.GetSize() * sizeof(float)) != 0)
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	// the largest difference between a position and its half float
+	double GetMaxPositionError(const graphics::StarField& stars, const std::vector<graphics::PackedVertex>& vertices)
+	{
+		const float* x = stars.GetStream(graphics::StarStream::x);
+		const float* y = stars.GetStream(graphics::StarStream::y);
+		const float* z = stars.GetStream(graphics::StarStream::z);
+		double error = 0.0;
+		for (std::size_t i = 0; i < vertices.size(); i++)
+		{
+			error = std::max(error, (double)std::fabs(graphics::HalfToFloat(vertices[i].x) - x[i]));
+			error = std::max(error, (double)std::fabs(graphics::HalfToFloat(vertices[i].y) - y[i]));
+			error = std::max(error, (double)std::fabs(graphics::HalfToFloat(vertices[i].z) - z[i]));
+		}
+		return error;
+	}
+
+	// the time per pass in milliseconds
+	benchmarks::Statistics Time(long long passes, const std::function<void()>& pass)
+	{
+		std::vector<double> times;
+		for (long long i = 0; i < passes; i++)
+		{
+			const auto start = std::chrono::steady_clock::now();
+			pass();
+			times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+		}
+		return benchmarks::ComputeStatistics(times);
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const std::size_t starCount = static_cast<std::size_t>(options.GetInteger("stars", 50000));
+	const std::size_t grain = static_cast<std::size_t>(options.GetInteger("grain", 4096));
+	const long long passes = options.GetInteger("passes", 200);
+	const unsigned int maxThreads = static_cast<unsigned int>(options.GetInteger("threads", std::thread::hardware_concurrency()));
+	const std::string directory = options.GetString("directory", "/tmp");
+	const std::uint32_t seed = 0x5eed;
+
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/StarfieldBenchmark.log")));
+	benchmarks::ResultWriter results(std::cout);
+
+	// the reference of every spawn, from the scalar kernel
+	graphics::StarField stars(starCount);
+	graphics::StarField reference(starCount);
+	std::vector<graphics::Vertex> vertices(starCount);
+	double randMs = 0.0;
+
+	// spawns passes starfields, from step 0 on, and writes the results
+	auto measure = [&](const char* generator, unsigned int threadCount, const std::function<void(std::uint64_t)>& generate)
+	{
+		std::vector<double> times;
+		bool isIdentical = true;
+		for (long long pass = 0; pass < passes; pass++)
+		{
+			const std::uint64_t key = graphics::GetStarfieldKey(seed, (std::uint64_t)pass);
+			const auto start = std::chrono::steady_clock::now();
+			generate(key);
+			times.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+			graphics::SpawnStarsScalar(reference, 0, starCount, key);
+			isIdentical = isIdentical && IsIdentical(stars, reference);
+		}
+
+		const benchmarks::Statistics statistics = benchmarks::ComputeStatistics(times);
+		if (randMs == 0.0)
+		{
+			randMs = statistics.p50;
+		}
+		results.Begin("starfield")
+			.Add("generator", generator)
+			.Add("kernel", graphics::GetSpawningKernelName())
+			.Add("threads", threadCount)
+			.Add("stars", static_cast<unsigned long long>(starCount))
+			.Add("ms", statistics)
+			.Add("nsPerStar", statistics.p50 * 1000000.0 / starCount)
+			.Add("speedup", randMs / statistics.p50)
+			.Add("isIdentical", isIdentical)
+			.End();
+	};
+
+	measure("rand", 1, [&vertices, starCount](std::uint64_t) { GenerateWithRand(vertices.data(), starCount); });
+	measure("scalar", 1, [&stars, starCount](std::uint64_t key) { graphics::SpawnStarsScalar(stars, 0, starCount, key); });
+	measure("simd", 1, [&stars, starCount](std::uint64_t key) { graphics::SpawnStars(stars, 0, starCount, key); });
+
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		util::JobSystem jobSystem(threadCount - 1);
+		measure("parallel", threadCount, [&stars, &jobSystem, grain](std::uint64_t key) { graphics::SpawnStarfield(stars, key, &jobSystem, grain); });
+	}
+
+	// packing the last starfield, checked against the scalar kernel; the stars have not moved, thus any farseer will do
+	std::vector<graphics::PackedVertex> packed(starCount);
+	std::vector<graphics::PackedVertex> packedReference(starCount);
+	graphics::PackStarsScalar(stars, packedReference.data(), 0, starCount, 1.0f);
+	const double positionError = GetMaxPositionError(stars, packedReference);
+
+	auto measurePacking = [&](const char* packer, unsigned int threadCount, const std::function<void()>& pack)
+	{
+		std::fill(packed.begin(), packed.end(), graphics::PackedVertex{});
+		const benchmarks::Statistics statistics = Time(passes, pack);
+		results.Begin("starPacking")
+			.Add("packer", packer)
+			.Add("kernel", graphics::GetPackingKernelName())
+			.Add("threads", threadCount)
+			.Add("stars", static_cast<unsigned long long>(starCount))
+			.Add("ms", statistics)
+			.Add("nsPerStar", statistics.p50 * 1000000.0 / starCount)
+			.Add("maxPositionError", positionError)
+			.Add("isIdentical", std::memcmp(packed.data(), packedReference.data(), starCount * sizeof(graphics::PackedVertex)) == 0)
+			.End();
+	};
+
+	measurePacking("scalar", 1, [&] { graphics::PackStarsScalar(stars, packed.data(), 0, starCount, 1.0f); });
+	measurePacking("simd", 1, [&] { graphics::PackStars(stars, packed.data(), 0, starCount, 1.0f); });
+	for (unsigned int threadCount : benchmarks::GetThreadCounts(maxThreads))
+	{
+		util::JobSystem jobSystem(threadCount - 1);
+		measurePacking("parallel", threadCount, [&] { graphics::PackStarfield(stars, packed.data(), 1.0f, &jobSystem, grain); });
+	}
+
+	// the copy into the mapped vertex buffer, full against packed vertices
+	std::vector<unsigned char> mapped(starCount * sizeof(graphics::Vertex));
+	for (std::size_t vertexSize : { sizeof(graphics::Vertex), sizeof(graphics::PackedVertex) })
+	{
+		const void* source = vertexSize == sizeof(graphics::Vertex) ? (const void*)vertices.data() : (const void*)packed.data();
+		const benchmarks::Statistics statistics = Time(passes, [&] { std::memcpy(mapped.data(), source, starCount * vertexSize); });
+		results.Begin("starUpload")
+			.Add("vertex", vertexSize == sizeof(graphics::Vertex) ? "full" : "packed")
+			.Add("bytesPerStar", static_cast<unsigned long long>(vertexSize))
+			.Add("bytes", static_cast<unsigned long long>(starCount * vertexSize))
+			.Add("ms", statistics)
+			.End();
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}
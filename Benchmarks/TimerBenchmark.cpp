@@ -0,0 +1,125 @@
+#pragma region "Description"
+
+/*******************************************************************************************************************************
+* TimerBenchmark.cpp
+*
+* Cost of core::Timer::Tick for every clock source available on this machine
+*
+* For every clock source, and for the one the automatic selection picks:
+* - the cost of a Tick() call (p50 / p99 / p999 / max over batches of ticks, in nanoseconds per tick)
+* - the cost of reading the raw counts of the source, without the timer
+* - the resolution: the smallest non-zero difference between two consecutive reads, in nanoseconds
+*
+* Options:
+*	--ticks <n>			number of ticks per clock source (default: 1000000)
+*	--batch <n>			ticks per sample (default: 1000)
+*	--directory <path>	where the log file is written (default: /tmp)
+*
+********************************************************************************************************************************/
+
+#pragma endregion
+
+#pragma region "Includes"
+
+// C++ includes
+#include <chrono>			// clocks
+#include <iostream>			// std::cout
+#include <memory>			// smart pointers
+#include <string>			// strings
+#include <vector>			// vector containers
+
+// Project includes
+#include "Benchmark.h"
+#include "../Bell0BytesGamingProgramming/ServiceLocator.h"
+#include "../Bell0BytesGamingProgramming/StringConverter.h"
+#include "../Bell0BytesGamingProgramming/Timer.h"
+
+#pragma endregion
+
+namespace
+{
+	void Run(core::ClockSourceType type, long long ticks, long long batch, benchmarks::ResultWriter& results)
+	{
+		core::Timer timer(type);
+		const core::ClockSource& clockSource = timer.GetClockSource();
+		timer.Reset();
+
+		// cost of a tick, measured in batches so that reading the benchmark clock does not dominate
+		std::vector<double> tickCosts;
+		tickCosts.reserve(static_cast<std::size_t>(ticks / batch + 1));
+		double sum = 0.0;
+		for (long long done = 0; done < ticks; done += batch)
+		{
+			auto start = std::chrono::steady_clock::now();
+			for (long long i = 0; i < batch; i++)
+			{
+				timer.Tick();
+				sum += timer.GetDeltaTime();
+			}
+			auto end = std::chrono::steady_clock::now();
+			tickCosts.push_back(std::chrono::duration<double, std::nano>(end - start).count() / batch);
+		}
+
+		// cost of reading the source itself, and its resolution
+		std::vector<double> readCosts;
+		readCosts.reserve(tickCosts.size());
+		std::int64_t resolution = 0;
+		for (long long done = 0; done < ticks; done += batch)
+		{
+			auto start = std::chrono::steady_clock::now();
+			std::int64_t previous = clockSource.GetCounts();
+			for (long long i = 0; i < batch; i++)
+			{
+				std::int64_t now = clockSource.GetCounts();
+				if (now != previous && (resolution == 0 || now - previous < resolution))
+				{
+					resolution = now - previous;
+				}
+				previous = now;
+			}
+			auto end = std::chrono::steady_clock::now();
+			readCosts.push_back(std::chrono::duration<double, std::nano>(end - start).count() / (batch + 1));
+		}
+
+		results.Begin("timer")
+			.Add("requested", core::ClockSource::GetName(type))
+			.Add("clockSource", clockSource.GetName())
+			.Add("frequency", 1.0 / clockSource.GetSecondsPerCount())
+			.Add("resolutionNs", resolution * clockSource.GetSecondsPerCount() * 1e9)
+			.Add("ticks", ticks)
+			.Add("totalSeconds", sum)
+			.Add("tickNs", benchmarks::ComputeStatistics(tickCosts))
+			.Add("readNs", benchmarks::ComputeStatistics(readCosts))
+			.End();
+	}
+}
+
+int main(int argc, char* argv[])
+{
+	benchmarks::Options options(argc, argv);
+
+	const long long ticks = options.GetInteger("ticks", 1000000);
+	const long long batch = options.GetInteger("batch", 1000);
+	const std::string directory = options.GetString("directory", "/tmp");
+
+	// the timer logs to the file logger of the service locator
+	util::ServiceLocator::ProvideFileLoggingService(std::make_shared<util::Logger<util::MappedFileLogPolicy>>(util::StringConverter::s2ws(directory + "/TimerBenchmark.log")));
+
+	benchmarks::ResultWriter results(std::cout);
+	std::vector<core::ClockSourceType> types = core::ClockSource::GetAvailableTypes();
+	types.push_back(core::ClockSourceType::automatic);
+	for (core::ClockSourceType type : types)
+	{
+		try
+		{
+			Run(type, ticks, batch > 0 ? batch : 1, results);
+		}
+		catch (std::runtime_error& e)
+		{
+			std::cerr << core::ClockSource::GetName(type) << ": " << e.what() << std::endl;
+		}
+	}
+
+	util::ServiceLocator::ProvideFileLoggingService(nullptr);
+	return 0;
+}